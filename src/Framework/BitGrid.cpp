@@ -0,0 +1,318 @@
+#include "Framework/BitGrid.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rf
+{
+
+namespace
+{
+
+const uint64_t allBits = ~uint64_t(0);
+
+inline int popCount(uint64_t value)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(value);
+#else
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+///Return the index of the lowest set bit of @a value, which must not be zero.
+inline int trailingZeros(uint64_t value)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#else
+	int count = 0;
+	while(!(value & 1))
+	{
+		value >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+///Return a mask of bits [@a begin, @a end) of a word, where 0 <= begin < end <= 64.
+inline uint64_t bitRange(int begin, int end)
+{
+	return (allBits << begin) & (allBits >> (64 - end));
+}
+
+struct AndOp
+{
+	uint64_t operator ()(uint64_t a, uint64_t b) const {return a & b;}
+#if defined(__SSE2__)
+	__m128i operator ()(__m128i a, __m128i b) const {return _mm_and_si128(a, b);}
+#endif
+};
+
+struct OrOp
+{
+	uint64_t operator ()(uint64_t a, uint64_t b) const {return a | b;}
+#if defined(__SSE2__)
+	__m128i operator ()(__m128i a, __m128i b) const {return _mm_or_si128(a, b);}
+#endif
+};
+
+struct XorOp
+{
+	uint64_t operator ()(uint64_t a, uint64_t b) const {return a ^ b;}
+#if defined(__SSE2__)
+	__m128i operator ()(__m128i a, __m128i b) const {return _mm_xor_si128(a, b);}
+#endif
+};
+
+struct AndNotOp
+{
+	uint64_t operator ()(uint64_t a, uint64_t b) const {return a & ~b;}
+#if defined(__SSE2__)
+	__m128i operator ()(__m128i a, __m128i b) const {return _mm_andnot_si128(b, a);}
+#endif
+};
+
+}
+
+BitGrid::BitGrid(int width, int height, bool value):
+	m_width(width), m_height(height), m_wordsPerRow((width + 63) / 64),
+	m_lastWordMask((width & 63) == 0 ? allBits : (uint64_t(1) << (width & 63)) - 1),
+	m_words(m_wordsPerRow * height, 0)
+{
+	fill(value);
+}
+
+void BitGrid::fill(bool value)
+{
+	std::fill(m_words.begin(), m_words.end(), value ? allBits : 0);
+	clearPadding();
+}
+
+void BitGrid::reset(int width, int height, bool value)
+{
+	m_width = width;
+	m_height = height;
+	m_wordsPerRow = (width + 63) / 64;
+	m_lastWordMask = (width & 63) == 0 ? allBits : (uint64_t(1) << (width & 63)) - 1;
+	m_words.assign(static_cast<size_t>(m_wordsPerRow) * height, value ? allBits : 0);
+	clearPadding();
+}
+
+void BitGrid::fillBox(const Rectanglei& area, bool value)
+{
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+	if(left >= right || bottom >= top)
+	{
+		return;
+	}
+
+	int firstWord = left >> 6;
+	int lastWord = (right - 1) >> 6;
+	for(int y = bottom; y < top; ++y)
+	{
+		uint64_t* words = row(y);
+		for(int i = firstWord; i <= lastWord; ++i)
+		{
+			uint64_t mask = bitRange(i == firstWord ? left & 63 : 0, i == lastWord ? right - i * 64 : 64);
+			words[i] = value ? words[i] | mask : words[i] & ~mask;
+		}
+	}
+}
+
+BitGrid& BitGrid::operator &=(const BitGrid& grid)
+{
+	combine(grid, AndOp());
+	return *this;
+}
+
+BitGrid& BitGrid::operator |=(const BitGrid& grid)
+{
+	combine(grid, OrOp());
+	return *this;
+}
+
+BitGrid& BitGrid::operator ^=(const BitGrid& grid)
+{
+	combine(grid, XorOp());
+	return *this;
+}
+
+BitGrid& BitGrid::subtract(const BitGrid& grid)
+{
+	combine(grid, AndNotOp());
+	return *this;
+}
+
+void BitGrid::invert()
+{
+	for(uint64_t& word : m_words)
+	{
+		word = ~word;
+	}
+	clearPadding();
+}
+
+void BitGrid::dilate(bool outside)
+{
+	morph(true, outside);
+}
+
+void BitGrid::erode(bool outside)
+{
+	morph(false, outside);
+}
+
+int BitGrid::count() const
+{
+	int total = 0;
+	for(uint64_t word : m_words)
+	{
+		total += popCount(word);
+	}
+	return total;
+}
+
+int BitGrid::count(const Rectanglei& area) const
+{
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+	if(left >= right || bottom >= top)
+	{
+		return 0;
+	}
+
+	int firstWord = left >> 6;
+	int lastWord = (right - 1) >> 6;
+	int total = 0;
+	for(int y = bottom; y < top; ++y)
+	{
+		const uint64_t* words = row(y);
+		for(int i = firstWord; i <= lastWord; ++i)
+		{
+			total += popCount(words[i] & bitRange(i == firstWord ? left & 63 : 0, i == lastWord ? right - i * 64 : 64));
+		}
+	}
+	return total;
+}
+
+bool BitGrid::none() const
+{
+	return std::all_of(m_words.begin(), m_words.end(),
+		[](uint64_t word)
+		{
+			return word == 0;
+		});
+}
+
+int BitGrid::findNext(int y, int x, bool value) const
+{
+	if(x >= m_width)
+	{
+		return m_width;
+	}
+
+	const uint64_t* words = row(y);
+	int i = x >> 6;
+	uint64_t candidates = (value ? words[i] : ~words[i]) & (allBits << (x & 63));
+	while(candidates == 0)
+	{
+		if(++i >= m_wordsPerRow)
+		{
+			return m_width;
+		}
+		candidates = value ? words[i] : ~words[i];
+	}
+	//Searching for clear cells finds the padding after the last cell, so clamp to the width.
+	return std::min(i * 64 + trailingZeros(candidates), m_width);
+}
+
+template<typename OpType>
+void BitGrid::combine(const BitGrid& grid, const OpType& op)
+{
+	assert(grid.m_width == m_width && grid.m_height == m_height);
+
+	uint64_t* words = m_words.data();
+	const uint64_t* other = grid.m_words.data();
+	size_t count = m_words.size();
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for(; i + 2 <= count; i += 2)
+	{
+		__m128i* destination = reinterpret_cast<__m128i*>(words + i);
+		__m128i result = op(_mm_loadu_si128(destination), _mm_loadu_si128(reinterpret_cast<const __m128i*>(other + i)));
+		_mm_storeu_si128(destination, result);
+	}
+#endif
+
+	for(; i < count; ++i)
+	{
+		words[i] = op(words[i], other[i]);
+	}
+}
+
+void BitGrid::morph(bool isDilation, bool outside)
+{
+	const uint64_t outsideWord = outside ? allBits : 0;
+	int lastWord = m_wordsPerRow - 1;
+
+	//First combine each cell with its left and right neighbors, then each row with the rows above and below.
+	std::vector<uint64_t> horizontal(m_words.size());
+	for(int y = 0; y < m_height; ++y)
+	{
+		const uint64_t* words = row(y);
+		uint64_t* output = &horizontal[y * m_wordsPerRow];
+		for(int i = 0; i <= lastWord; ++i)
+		{
+			//The padding bits stand in for the cells beyond the right edge.
+			uint64_t center = i == lastWord ? words[i] | (outsideWord & ~m_lastWordMask) : words[i];
+			uint64_t previous = i > 0 ? words[i - 1] : outsideWord;
+			uint64_t next = i < lastWord ? words[i + 1] : outsideWord;
+			uint64_t left = (center << 1) | (previous >> 63);
+			uint64_t right = (center >> 1) | (next << 63);
+			output[i] = isDilation ? center | left | right : center & left & right;
+		}
+	}
+
+	for(int y = 0; y < m_height; ++y)
+	{
+		const uint64_t* middle = &horizontal[y * m_wordsPerRow];
+		const uint64_t* below = y > 0 ? &horizontal[(y - 1) * m_wordsPerRow] : nullptr;
+		const uint64_t* above = y + 1 < m_height ? &horizontal[(y + 1) * m_wordsPerRow] : nullptr;
+		uint64_t* words = row(y);
+		for(int i = 0; i <= lastWord; ++i)
+		{
+			uint64_t belowWord = below ? below[i] : outsideWord;
+			uint64_t aboveWord = above ? above[i] : outsideWord;
+			words[i] = isDilation ? middle[i] | belowWord | aboveWord : middle[i] & belowWord & aboveWord;
+		}
+	}
+	clearPadding();
+}
+
+void BitGrid::clearPadding()
+{
+	if(m_lastWordMask == allBits)
+	{
+		return;
+	}
+	for(int y = 0; y < m_height; ++y)
+	{
+		m_words[(y + 1) * m_wordsPerRow - 1] &= m_lastWordMask;
+	}
+}
+
+}
@@ -0,0 +1,153 @@
+#ifndef BITGRID_H_
+#define BITGRID_H_
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Rectangle.h"
+
+namespace rf
+{
+
+/**
+ * @brief A grid of booleans packed 64 to a word, with the same coordinates as a TileGrid.
+ * @details Each row starts on a new word, with the unused bits at the end of the last word always
+ * clear. Set operations, morphology and counting work on whole words, and on two words at a time
+ * with SSE2 where it is available, so masks for visibility, exploration or walkability can be
+ * combined and measured without touching each cell.
+ */
+class BitGrid
+{
+public:
+	BitGrid(int width, int height, bool value = false);
+	~BitGrid() = default;
+
+	BitGrid(const BitGrid&) = default;
+	BitGrid(BitGrid&&) = default;
+	BitGrid& operator =(const BitGrid&) = default;
+	BitGrid& operator =(BitGrid&&) = default;
+
+	bool operator ==(const BitGrid& grid) const
+		{return m_width == grid.m_width && m_height == grid.m_height && m_words == grid.m_words;}
+	bool operator !=(const BitGrid& grid) const {return !(*this == grid);}
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+	int wordsPerRow() const {return m_wordsPerRow;}
+
+	bool get(int x, int y) const;
+	void set(int x, int y, bool value);
+	///Set (@a x, @a y) to @a value, returning true if that changed it.
+	bool exchange(int x, int y, bool value);
+
+	void fill(bool value);
+	///Change the size to @a width by @a height with every cell @a value, reusing the memory if it is large enough.
+	void reset(int width, int height, bool value = false);
+	///Set every cell of @a area, clipped to the grid, to @a value.
+	void fillBox(const Rectanglei& area, bool value);
+
+	BitGrid& operator &=(const BitGrid& grid);
+	BitGrid& operator |=(const BitGrid& grid);
+	BitGrid& operator ^=(const BitGrid& grid);
+	///Clear the cells that are set in @a grid.
+	BitGrid& subtract(const BitGrid& grid);
+	///Flip every cell.
+	void invert();
+
+	/**
+	 * @brief Set every cell that has a set cell among its eight neighbors.
+	 * @param outside The value of the cells beyond the edges of the grid.
+	 */
+	void dilate(bool outside = false);
+	///Clear every cell that has a clear cell among its eight neighbors.
+	void erode(bool outside = false);
+
+	///Return the number of set cells.
+	int count() const;
+	///Return the number of set cells within @a area, clipped to the grid.
+	int count(const Rectanglei& area) const;
+
+	///Return true if no cell is set.
+	bool none() const;
+
+	/**
+	 * @brief Call @a fn(y, begin, end) for each run of set cells [@a begin, @a end) in row y.
+	 * @details Rows are visited from y = 0 up, and runs from left to right.
+	 */
+	template<typename FnType>
+	void forEachSpan(const FnType& fn) const;
+
+	///Return the index of the first cell of row @a y at or after @a x whose value is @a value, or width().
+	int findNext(int y, int x, bool value) const;
+
+	///Return the words of row @a y, with cell x in bit x % 64 of word x / 64.
+	uint64_t* row(int y) {return &m_words[y * m_wordsPerRow];}
+	const uint64_t* row(int y) const {return &m_words[y * m_wordsPerRow];}
+
+	///Return a mask of the bits of the last word of each row that are within the grid.
+	uint64_t lastWordMask() const {return m_lastWordMask;}
+
+protected:
+	template<typename OpType>
+	void combine(const BitGrid& grid, const OpType& op);
+	///Combine each cell with its neighbors with OR for dilation or AND for erosion.
+	void morph(bool isDilation, bool outside);
+	///Clear the unused bits at the end of each row.
+	void clearPadding();
+
+	int m_width;
+	int m_height;
+	int m_wordsPerRow;
+	uint64_t m_lastWordMask;
+	std::vector<uint64_t> m_words;
+};
+
+inline bool BitGrid::get(int x, int y) const
+{
+	assert(x >= 0 && y >= 0 && x < m_width && y < m_height);
+
+	return (m_words[y * m_wordsPerRow + (x >> 6)] >> (x & 63)) & 1;
+}
+
+inline void BitGrid::set(int x, int y, bool value)
+{
+	assert(x >= 0 && y >= 0 && x < m_width && y < m_height);
+
+	uint64_t& word = m_words[y * m_wordsPerRow + (x >> 6)];
+	uint64_t mask = uint64_t(1) << (x & 63);
+	word = value ? word | mask : word & ~mask;
+}
+
+inline bool BitGrid::exchange(int x, int y, bool value)
+{
+	assert(x >= 0 && y >= 0 && x < m_width && y < m_height);
+
+	uint64_t& word = m_words[y * m_wordsPerRow + (x >> 6)];
+	uint64_t mask = uint64_t(1) << (x & 63);
+	if(((word & mask) != 0) == value)
+	{
+		return false;
+	}
+	word ^= mask;
+	return true;
+}
+
+template<typename FnType>
+void BitGrid::forEachSpan(const FnType& fn) const
+{
+	for(int y = 0; y < m_height; ++y)
+	{
+		int x = findNext(y, 0, true);
+		while(x < m_width)
+		{
+			int end = findNext(y, x, false);
+			fn(y, x, end);
+			x = findNext(y, end, true);
+		}
+	}
+}
+
+}
+
+#endif
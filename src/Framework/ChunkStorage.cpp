@@ -0,0 +1,54 @@
+#include "Framework/ChunkStorage.h"
+
+#include <fstream>
+
+#include "Framework/Exceptions/FileIoException.h"
+
+namespace rf
+{
+
+DirectoryChunkStorage::DirectoryChunkStorage(const std::string& directory):
+	m_directory(directory)
+{
+}
+
+bool DirectoryChunkStorage::loadChunk(const Vector2i& chunk, std::vector<Tile>& tiles)
+{
+	std::string fileName = chunkFileName(chunk);
+	std::ifstream file(fileName, std::ios::binary | std::ios::in);
+	if(!file.is_open())
+	{
+		return false;
+	}
+
+	std::streamsize size = static_cast<std::streamsize>(tiles.size() * sizeof(Tile));
+	file.read(reinterpret_cast<char*>(tiles.data()), size);
+	if(file.gcount() != size)
+	{
+		throw FileIoException(fileName, "Chunk file is truncated");
+	}
+	return true;
+}
+
+void DirectoryChunkStorage::saveChunk(const Vector2i& chunk, const std::vector<Tile>& tiles)
+{
+	std::string fileName = chunkFileName(chunk);
+	std::ofstream file(fileName, std::ios::binary | std::ios::out | std::ios::trunc);
+	if(!file.is_open())
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+
+	file.write(reinterpret_cast<const char*>(tiles.data()), tiles.size() * sizeof(Tile));
+	if(!file)
+	{
+		throw FileIoException(fileName, "Unable to write chunk");
+	}
+}
+
+std::string DirectoryChunkStorage::chunkFileName(const Vector2i& chunk) const
+{
+	return m_directory + "/" + std::to_string(chunk.x) + "_" + std::to_string(chunk.y) + ".chunk";
+}
+
+}
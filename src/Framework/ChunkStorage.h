@@ -0,0 +1,60 @@
+#ifndef CHUNKSTORAGE_H_
+#define CHUNKSTORAGE_H_
+
+#include <string>
+#include <vector>
+
+#include "Framework/Tile.h"
+#include "Framework/Vector2.h"
+
+namespace rf
+{
+
+/**
+ * @brief Persists the chunks of a ChunkedTileGrid that are not resident in memory.
+ * @details The methods are called from the background thread of the grid, one at a time,
+ * so implementations need no locking of their own. Errors should be reported by throwing;
+ * the exception is passed on to the thread that owns the grid.
+ */
+class ChunkStorage
+{
+public:
+	virtual ~ChunkStorage() = default;
+
+	/**
+	 * @brief Read the tiles of the chunk at @a chunk, in chunk coordinates, into @a tiles.
+	 * @details @a tiles is already sized to hold the whole chunk.
+	 * @return false if the chunk has never been saved.
+	 */
+	virtual bool loadChunk(const Vector2i& chunk, std::vector<Tile>& tiles) = 0;
+
+	///Write the tiles of the chunk at @a chunk, in chunk coordinates.
+	virtual void saveChunk(const Vector2i& chunk, const std::vector<Tile>& tiles) = 0;
+};
+
+/**
+ * @brief Stores each chunk as a file of raw tiles in a directory.
+ * @details The directory must already exist. Files are named "x_y.chunk" after the chunk coordinates.
+ */
+class DirectoryChunkStorage: public ChunkStorage
+{
+public:
+	explicit DirectoryChunkStorage(const std::string& directory);
+	virtual ~DirectoryChunkStorage() = default;
+
+	///@throw FileIoException if a chunk file exists but could not be read completely.
+	virtual bool loadChunk(const Vector2i& chunk, std::vector<Tile>& tiles) override;
+	///@throw FileIoException if the chunk file could not be written.
+	virtual void saveChunk(const Vector2i& chunk, const std::vector<Tile>& tiles) override;
+
+	const std::string& directory() const {return m_directory;}
+
+protected:
+	std::string chunkFileName(const Vector2i& chunk) const;
+
+	std::string m_directory;
+};
+
+}
+
+#endif
@@ -0,0 +1,568 @@
+#include "Framework/ChunkedTileGrid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+
+#include "Framework/Exceptions/Exception.h"
+
+namespace rf
+{
+
+ChunkedTileGrid::ChunkedTileGrid(int width, int height, int chunkSize, size_t maxResidentChunks,
+		std::unique_ptr<ChunkStorage> storage, const Tile& defaultTile):
+	m_width(width), m_height(height), m_chunkSize(chunkSize),
+	m_chunksX((width + chunkSize - 1) / chunkSize), m_chunksY((height + chunkSize - 1) / chunkSize),
+	m_defaultChunk(std::make_shared<Chunk>()),
+	m_chunkStates(m_chunksX * m_chunksY, storage ? ChunkState::Unloaded : ChunkState::Default),
+	m_isChunkChanged(m_chunksX * m_chunksY, false),
+	m_residentChunks(storage ? maxResidentChunks : std::numeric_limits<size_t>::max(),
+		[this](const int& chunk, const std::shared_ptr<Chunk>& data)
+		{
+			evict(chunk, data);
+		}),
+	m_storage(std::move(storage))
+{
+	assert(width > 0 && height > 0 && chunkSize > 0);
+	assert(maxResidentChunks > 0);
+
+	m_defaultChunk->tiles.assign(chunkSize * chunkSize, defaultTile);
+
+	if(m_storage)
+	{
+		m_ioThread = std::thread(&ChunkedTileGrid::ioThreadMain, this);
+	}
+}
+
+ChunkedTileGrid::~ChunkedTileGrid()
+{
+	try
+	{
+		flush();
+	}
+	catch(...)
+	{
+		//There is nowhere left to report a failed save to.
+	}
+
+	if(m_ioThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ioMutex);
+			m_stopping = true;
+		}
+		m_requestCondition.notify_all();
+		m_ioThread.join();
+	}
+}
+
+const Tile& ChunkedTileGrid::getTile(int x, int y) const
+{
+	assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+	int chunk = chunkIndex(x, y);
+	const Chunk* data = m_defaultChunk.get();
+	if(m_chunkStates[chunk] == ChunkState::Resident)
+	{
+		data = m_residentChunks.peekItem(chunk)->get();
+	}
+	return data->tiles[(x % m_chunkSize) + (y % m_chunkSize) * m_chunkSize];
+}
+
+void ChunkedTileGrid::setTile(int x, int y, const Tile& tile)
+{
+	assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+	Chunk& data = chunkForWriting(chunkIndex(x, y));
+	data.tiles[(x % m_chunkSize) + (y % m_chunkSize) * m_chunkSize] = tile;
+}
+
+void ChunkedTileGrid::setBox(const Rectanglei& box, const Tile& tile)
+{
+	int left = std::max(box.left(), 0);
+	int bottom = std::max(box.bottom(), 0);
+	int right = std::min(box.right(), m_width);
+	int top = std::min(box.top(), m_height);
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+
+	for(int chunkY = bottom / m_chunkSize; chunkY * m_chunkSize < top; ++chunkY)
+	{
+		for(int chunkX = left / m_chunkSize; chunkX * m_chunkSize < right; ++chunkX)
+		{
+			Chunk& data = chunkForWriting(chunkX + chunkY * m_chunksX);
+			int chunkLeft = chunkX * m_chunkSize;
+			int chunkBottom = chunkY * m_chunkSize;
+			int spanLeft = std::max(left, chunkLeft) - chunkLeft;
+			int spanRight = std::min(right, chunkLeft + m_chunkSize) - chunkLeft;
+
+			for(int y = std::max(bottom, chunkBottom); y < std::min(top, chunkBottom + m_chunkSize); ++y)
+			{
+				Tile* row = &data.tiles[(y - chunkBottom) * m_chunkSize];
+				tilespan::fill(row + spanLeft, row + spanRight, tile);
+			}
+		}
+	}
+}
+
+void ChunkedTileGrid::copyTo(const Vector2i& position, TileGridView& destination)
+{
+	int left = std::max(position.x, 0);
+	int bottom = std::max(position.y, 0);
+	int right = std::min(position.x + destination.width(), m_width);
+	int top = std::min(position.y + destination.height(), m_height);
+
+	if(left > position.x || bottom > position.y || right < position.x + destination.width()
+			|| top < position.y + destination.height())
+	{
+		destination.fill(defaultTile());
+	}
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+
+	for(int chunkY = bottom / m_chunkSize; chunkY * m_chunkSize < top; ++chunkY)
+	{
+		for(int chunkX = left / m_chunkSize; chunkX * m_chunkSize < right; ++chunkX)
+		{
+			const Chunk& data = chunkForReading(chunkX + chunkY * m_chunksX, true);
+			int chunkLeft = chunkX * m_chunkSize;
+			int chunkBottom = chunkY * m_chunkSize;
+			int spanLeft = std::max(left, chunkLeft);
+			int spanWidth = std::min(right, chunkLeft + m_chunkSize) - spanLeft;
+
+			for(int y = std::max(bottom, chunkBottom); y < std::min(top, chunkBottom + m_chunkSize); ++y)
+			{
+				const Tile* from = &data.tiles[(spanLeft - chunkLeft) + (y - chunkBottom) * m_chunkSize];
+				Tile* to = destination.rowBegin(y - position.y) + (spanLeft - position.x);
+				tilespan::copy(from, spanWidth, to);
+			}
+		}
+	}
+}
+
+void ChunkedTileGrid::copyFrom(const TileGridView& source, const Vector2i& position)
+{
+	int left = std::max(position.x, 0);
+	int bottom = std::max(position.y, 0);
+	int right = std::min(position.x + source.width(), m_width);
+	int top = std::min(position.y + source.height(), m_height);
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+
+	for(int chunkY = bottom / m_chunkSize; chunkY * m_chunkSize < top; ++chunkY)
+	{
+		for(int chunkX = left / m_chunkSize; chunkX * m_chunkSize < right; ++chunkX)
+		{
+			Chunk& data = chunkForWriting(chunkX + chunkY * m_chunksX);
+			int chunkLeft = chunkX * m_chunkSize;
+			int chunkBottom = chunkY * m_chunkSize;
+			int spanLeft = std::max(left, chunkLeft);
+			int spanWidth = std::min(right, chunkLeft + m_chunkSize) - spanLeft;
+
+			for(int y = std::max(bottom, chunkBottom); y < std::min(top, chunkBottom + m_chunkSize); ++y)
+			{
+				const Tile* from = source.rowBegin(y - position.y) + (spanLeft - position.x);
+				Tile* to = &data.tiles[(spanLeft - chunkLeft) + (y - chunkBottom) * m_chunkSize];
+				tilespan::copy(from, spanWidth, to);
+			}
+		}
+	}
+}
+
+void ChunkedTileGrid::prefetch(const Rectanglei& area)
+{
+	if(!m_storage)
+	{
+		return;
+	}
+
+	int left = std::max(area.left(), 0) / m_chunkSize;
+	int bottom = std::max(area.bottom(), 0) / m_chunkSize;
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+
+	for(int chunkY = bottom; chunkY * m_chunkSize < top; ++chunkY)
+	{
+		for(int chunkX = left; chunkX * m_chunkSize < right; ++chunkX)
+		{
+			int chunk = chunkX + chunkY * m_chunksX;
+			if(m_chunkStates[chunk] == ChunkState::Unloaded)
+			{
+				requestLoad(chunk);
+			}
+		}
+	}
+}
+
+std::vector<Rectanglei> ChunkedTileGrid::update()
+{
+	if(m_storage)
+	{
+		integrateLoads();
+	}
+
+	std::vector<Rectanglei> changedAreas;
+	changedAreas.reserve(m_changedChunks.size());
+	for(int chunk : m_changedChunks)
+	{
+		changedAreas.push_back(chunkBounds(chunk));
+		m_isChunkChanged[chunk] = false;
+	}
+	m_changedChunks.clear();
+
+	rethrowIoError();
+	return changedAreas;
+}
+
+void ChunkedTileGrid::flush()
+{
+	if(!m_storage)
+	{
+		return;
+	}
+
+	//Resident chunks may keep being written while the background thread saves them,
+	//so it is given a copy of each.
+	m_residentChunks.forEachItem(
+		[this](const int& chunk, std::shared_ptr<Chunk>& data)
+		{
+			if(data->modified)
+			{
+				data->modified = false;
+				pushRequest(IoRequest{true, chunk, std::make_shared<Chunk>(*data), false});
+			}
+		});
+
+	{
+		std::unique_lock<std::mutex> lock(m_ioMutex);
+		m_completedCondition.wait(lock,
+			[this]()
+			{
+				return m_requests.empty() && m_requestsInProgress == 0;
+			});
+	}
+	rethrowIoError();
+}
+
+Rectanglei ChunkedTileGrid::chunkBounds(int chunk) const
+{
+	Vector2i position = chunkPosition(chunk) * m_chunkSize;
+	return Rectanglei(position.x, position.y, std::min(m_chunkSize, m_width - position.x),
+			std::min(m_chunkSize, m_height - position.y));
+}
+
+const ChunkedTileGrid::Chunk& ChunkedTileGrid::chunkForReading(int chunk, bool requestLoad)
+{
+	switch(m_chunkStates[chunk])
+	{
+	case ChunkState::Resident:
+		return **m_residentChunks.getItem(chunk);
+	case ChunkState::Unloaded:
+		if(requestLoad)
+		{
+			this->requestLoad(chunk);
+		}
+		break;
+	default:
+		break;
+	}
+	return *m_defaultChunk;
+}
+
+ChunkedTileGrid::Chunk& ChunkedTileGrid::chunkForWriting(int chunk)
+{
+	//A chunk that may be in storage must never be replaced by a copy of the default chunk, or
+	//the copy would be saved over it. Loads that complete alongside this one can evict it again
+	//before it is used, so keep loading until it is resident or known to be absent from storage.
+	while(m_chunkStates[chunk] != ChunkState::Resident && m_chunkStates[chunk] != ChunkState::Default)
+	{
+		if(m_chunkStates[chunk] != ChunkState::Loading)
+		{
+			requestLoad(chunk);
+		}
+		waitForLoad(chunk);
+		if(m_chunkStates[chunk] == ChunkState::Failed)
+		{
+			//waitForLoad() normally rethrows the error of the storage before this is reached.
+			Vector2i position = chunkPosition(chunk);
+			throw Exception("Chunk (" + std::to_string(position.x) + ", " + std::to_string(position.y)
+					+ ") could not be loaded for writing");
+		}
+	}
+
+	std::shared_ptr<Chunk> data;
+	if(m_chunkStates[chunk] == ChunkState::Resident)
+	{
+		data = *m_residentChunks.getItem(chunk);
+	}
+	else
+	{
+		data = std::make_shared<Chunk>(*m_defaultChunk);
+		makeResident(chunk, data);
+	}
+
+	data->modified = true;
+	markChanged(chunk);
+	return *data;
+}
+
+void ChunkedTileGrid::makeResident(int chunk, std::shared_ptr<Chunk> data)
+{
+	m_chunkStates[chunk] = ChunkState::Resident;
+	m_residentChunks.addItem(chunk, std::move(data));
+}
+
+void ChunkedTileGrid::evict(int chunk, const std::shared_ptr<Chunk>& data)
+{
+	m_chunkStates[chunk] = ChunkState::Unloaded;
+	if(data->modified)
+	{
+		//The chunk is no longer reachable from this thread, so it can be saved without a copy.
+		data->modified = false;
+		pushRequest(IoRequest{true, chunk, data, false});
+	}
+}
+
+void ChunkedTileGrid::requestLoad(int chunk)
+{
+	assert(m_chunkStates[chunk] == ChunkState::Unloaded || m_chunkStates[chunk] == ChunkState::Failed);
+
+	m_chunkStates[chunk] = ChunkState::Loading;
+	pushRequest(IoRequest{false, chunk, nullptr, false});
+}
+
+void ChunkedTileGrid::pushRequest(IoRequest request)
+{
+	//Requests are run in order, so a load always sees an earlier save of the same chunk.
+	{
+		std::lock_guard<std::mutex> lock(m_ioMutex);
+		m_requests.push_back(std::move(request));
+	}
+	m_requestCondition.notify_one();
+}
+
+void ChunkedTileGrid::waitForLoad(int chunk)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_ioMutex);
+		m_completedCondition.wait(lock,
+			[this, chunk]()
+			{
+				return std::any_of(m_completedLoads.begin(), m_completedLoads.end(),
+					[chunk](const IoRequest& request)
+					{
+						return request.chunk == chunk;
+					});
+			});
+	}
+	integrateLoads(chunk);
+	rethrowIoError();
+}
+
+void ChunkedTileGrid::integrateLoads(int lastChunk)
+{
+	std::vector<IoRequest> loads;
+	{
+		std::lock_guard<std::mutex> lock(m_ioMutex);
+		loads.swap(m_completedLoads);
+	}
+
+	//The chunk added last is the most recently used, so adding more cannot evict it.
+	std::stable_partition(loads.begin(), loads.end(),
+		[lastChunk](const IoRequest& load)
+		{
+			return load.chunk != lastChunk;
+		});
+
+	for(IoRequest& load : loads)
+	{
+		if(load.failed)
+		{
+			m_chunkStates[load.chunk] = ChunkState::Failed;
+		}
+		else if(load.data)
+		{
+			makeResident(load.chunk, std::move(load.data));
+			markChanged(load.chunk);
+		}
+		else
+		{
+			m_chunkStates[load.chunk] = ChunkState::Default;
+		}
+	}
+}
+
+void ChunkedTileGrid::markChanged(int chunk)
+{
+	if(!m_isChunkChanged[chunk])
+	{
+		m_isChunkChanged[chunk] = true;
+		m_changedChunks.push_back(chunk);
+	}
+}
+
+void ChunkedTileGrid::rethrowIoError()
+{
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(m_ioMutex);
+		std::swap(error, m_ioError);
+	}
+	if(error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+void ChunkedTileGrid::ioThreadMain()
+{
+	for(;;)
+	{
+		IoRequest request;
+		{
+			std::unique_lock<std::mutex> lock(m_ioMutex);
+			m_requestCondition.wait(lock,
+				[this]()
+				{
+					return !m_requests.empty() || m_stopping;
+				});
+			//Outstanding saves are still run when stopping, so nothing written is lost.
+			if(m_requests.empty())
+			{
+				break;
+			}
+			request = std::move(m_requests.front());
+			m_requests.pop_front();
+			++m_requestsInProgress;
+		}
+
+		try
+		{
+			if(request.isSave)
+			{
+				m_storage->saveChunk(chunkPosition(request.chunk), request.data->tiles);
+				request.data = nullptr;
+			}
+			else
+			{
+				std::shared_ptr<Chunk> data = std::make_shared<Chunk>();
+				data->tiles.resize(m_chunkSize * m_chunkSize, defaultTile());
+				if(m_storage->loadChunk(chunkPosition(request.chunk), data->tiles))
+				{
+					request.data = std::move(data);
+				}
+			}
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(m_ioMutex);
+			if(!m_ioError)
+			{
+				m_ioError = std::current_exception();
+			}
+			request.data = nullptr;
+			request.failed = true;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_ioMutex);
+			--m_requestsInProgress;
+			if(!request.isSave)
+			{
+				m_completedLoads.push_back(std::move(request));
+			}
+		}
+		m_completedCondition.notify_all();
+	}
+}
+
+ChunkedTileGridWindow::ChunkedTileGridWindow(ChunkedTileGrid* world, int width, int height):
+	m_world(world), m_grid(width, height), m_position(0, 0), m_prefetchMargin(world->chunkSize())
+{
+	refresh();
+	prefetch();
+}
+
+void ChunkedTileGridWindow::setPosition(const Vector2i& position)
+{
+	Vector2i delta = position - m_position;
+	if(delta == Vector2i::zero())
+	{
+		return;
+	}
+
+	m_position = position;
+	int width = m_grid.width();
+	int height = m_grid.height();
+
+	if(std::abs(delta.x) >= width || std::abs(delta.y) >= height)
+	{
+		refresh();
+	}
+	else
+	{
+		//Shift the tiles that stay visible, then copy in only what was exposed.
+		TileGridView view(&m_grid);
+		view.blit(view, -delta);
+
+		if(delta.x != 0)
+		{
+			int stripLeft = delta.x > 0 ? position.x + width - delta.x : position.x;
+			refresh(Rectanglei(stripLeft, position.y, std::abs(delta.x), height));
+		}
+		if(delta.y != 0)
+		{
+			int stripBottom = delta.y > 0 ? position.y + height - delta.y : position.y;
+			refresh(Rectanglei(position.x, stripBottom, width, std::abs(delta.y)));
+		}
+	}
+
+	prefetch();
+}
+
+bool ChunkedTileGridWindow::update()
+{
+	bool changed = false;
+	for(const Rectanglei& area : m_world->update())
+	{
+		changed |= refresh(area);
+	}
+	return changed;
+}
+
+void ChunkedTileGridWindow::refresh()
+{
+	TileGridView view(&m_grid);
+	m_world->copyTo(m_position, view);
+}
+
+bool ChunkedTileGridWindow::refresh(const Rectanglei& worldArea)
+{
+	int left = std::max(worldArea.left(), m_position.x);
+	int bottom = std::max(worldArea.bottom(), m_position.y);
+	int right = std::min(worldArea.right(), m_position.x + m_grid.width());
+	int top = std::min(worldArea.top(), m_position.y + m_grid.height());
+	if(right <= left || top <= bottom)
+	{
+		return false;
+	}
+
+	TileGridView part(left - m_position.x, bottom - m_position.y, right - left, top - bottom, &m_grid);
+	m_world->copyTo(Vector2i(left, bottom), part);
+	return true;
+}
+
+void ChunkedTileGridWindow::prefetch()
+{
+	m_world->prefetch(Rectanglei(m_position.x - m_prefetchMargin, m_position.y - m_prefetchMargin,
+			m_grid.width() + m_prefetchMargin * 2, m_grid.height() + m_prefetchMargin * 2));
+}
+
+}
@@ -0,0 +1,241 @@
+#ifndef CHUNKEDTILEGRID_H_
+#define CHUNKEDTILEGRID_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Framework/ChunkStorage.h"
+#include "Framework/LruCache.h"
+#include "Framework/TileGrid.h"
+#include "Framework/TileGridView.h"
+
+namespace rf
+{
+
+/**
+ * @brief A sparse tile grid for worlds much larger than the screen.
+ * @details The grid is divided into square chunks that are only allocated once a tile in them
+ * is written. Chunks that have never been written all read from one shared chunk filled with
+ * the default tile, so memory use follows the explored area rather than the size of the world.
+ *
+ * At most a fixed number of chunks are kept resident, and the least recently used are evicted
+ * beyond that. If a ChunkStorage is given, evicted chunks that were modified are saved, and
+ * chunks are loaded back when needed, both on a background thread. Reads never wait for a load:
+ * copyTo() requests the chunks it touches and shows the default tile until they arrive, and
+ * update() reports which areas have arrived since. Writes to a chunk that is still in storage
+ * wait for it to load. A chunk whose load failed reads as the default tile and is never saved;
+ * writes to it try the load again and throw if it still fails. Without a storage, chunks are
+ * never evicted.
+ *
+ * Apart from the background thread, a ChunkedTileGrid must only be used from one thread.
+ */
+class ChunkedTileGrid
+{
+public:
+	/**
+	 * @param width The width of the world, in tiles.
+	 * @param height The height of the world, in tiles.
+	 * @param chunkSize The width and height of each chunk, in tiles.
+	 * @param maxResidentChunks The number of chunks kept in memory when a storage is given.
+	 * @param storage Where chunks are saved to and loaded from, or null to keep everything in memory.
+	 * @param defaultTile The contents of every tile that has never been written.
+	 */
+	ChunkedTileGrid(int width, int height, int chunkSize = 32, size_t maxResidentChunks = 1024,
+			std::unique_ptr<ChunkStorage> storage = nullptr, const Tile& defaultTile = Tile());
+	///Saves every modified resident chunk and stops the background thread.
+	~ChunkedTileGrid();
+
+	ChunkedTileGrid(const ChunkedTileGrid&) = delete;
+	ChunkedTileGrid(ChunkedTileGrid&&) = delete;
+	ChunkedTileGrid& operator =(const ChunkedTileGrid&) = delete;
+	ChunkedTileGrid& operator =(ChunkedTileGrid&&) = delete;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+	int chunkSize() const {return m_chunkSize;}
+	const Tile& defaultTile() const {return m_defaultChunk->tiles[0];}
+
+	///@brief Return the tile at (@a x, @a y).
+	///@details This does not load anything; tiles of chunks that are not resident read as the default tile.
+	const Tile& getTile(int x, int y) const;
+
+	///@brief Set the tile at (@a x, @a y), waiting for its chunk to load if it is in storage.
+	///@throw The exception thrown by the ChunkStorage, if the chunk could not be loaded.
+	void setTile(int x, int y, const Tile& tile);
+
+	///Set every tile in @a box, clipped to the world, to @a tile.
+	void setBox(const Rectanglei& box, const Tile& tile);
+
+	/**
+	 * @brief Copy the world area the size of @a destination with its bottom-left corner at @a position.
+	 * @details Tiles outside the world are set to the default tile. Chunks that are not resident
+	 * are requested and read as the default tile in the meantime.
+	 */
+	void copyTo(const Vector2i& position, TileGridView& destination);
+
+	///Write the contents of @a source into the world with its bottom-left corner at @a position.
+	void copyFrom(const TileGridView& source, const Vector2i& position);
+
+	///Start loading every chunk that overlaps @a area and is not resident.
+	void prefetch(const Rectanglei& area);
+
+	/**
+	 * @brief Make the chunks loaded by the background thread resident.
+	 * @details This should be called once per frame.
+	 * @return The bounds of the chunks that were written to, or arrived from storage, since the
+	 * last call. Copies of those areas, such as a ChunkedTileGridWindow, should be refreshed.
+	 * @throw The exception thrown by the ChunkStorage, if a load or save failed.
+	 */
+	std::vector<Rectanglei> update();
+
+	///Save every modified resident chunk and wait for all outstanding saves to finish.
+	void flush();
+
+	///Return the number of chunks that are currently allocated in memory.
+	size_t residentChunkCount() const {return m_residentChunks.size();}
+
+	///Return true if the chunk containing (@a x, @a y) is allocated in memory.
+	bool isResident(int x, int y) const {return m_chunkStates[chunkIndex(x, y)] == ChunkState::Resident;}
+
+protected:
+	struct Chunk
+	{
+		std::vector<Tile> tiles;
+		bool modified = false;
+	};
+
+	enum class ChunkState : uint8_t
+	{
+		///Never written, reads from the default chunk.
+		Default,
+		///Not in memory, but may have been saved to storage.
+		Unloaded,
+		///A load has been requested from the background thread.
+		Loading,
+		///In the resident chunk cache.
+		Resident,
+		///The last load threw. Reads as the default chunk, but must not be written or saved.
+		Failed
+	};
+
+	struct IoRequest
+	{
+		bool isSave;
+		int chunk;
+		std::shared_ptr<Chunk> data;
+		///Set on a load that threw, as opposed to one that found nothing in storage.
+		bool failed;
+	};
+
+	int chunkIndex(int x, int y) const {return (x / m_chunkSize) + (y / m_chunkSize) * m_chunksX;}
+	Vector2i chunkPosition(int chunk) const {return Vector2i(chunk % m_chunksX, chunk / m_chunksX);}
+	Rectanglei chunkBounds(int chunk) const;
+
+	///Return the chunk to read @a chunk from, requesting a load if @a requestLoad is true and it is in storage.
+	const Chunk& chunkForReading(int chunk, bool requestLoad);
+	/**
+	 * @brief Return the resident chunk @a chunk, allocating or loading it first if needed.
+	 * @throw The exception thrown by the ChunkStorage, if the chunk could not be loaded.
+	 */
+	Chunk& chunkForWriting(int chunk);
+
+	void makeResident(int chunk, std::shared_ptr<Chunk> data);
+	void evict(int chunk, const std::shared_ptr<Chunk>& data);
+	void requestLoad(int chunk);
+	void pushRequest(IoRequest request);
+	void waitForLoad(int chunk);
+	///Make completed loads resident, @a lastChunk after the others so they cannot evict it.
+	void integrateLoads(int lastChunk = -1);
+	void markChanged(int chunk);
+	void rethrowIoError();
+
+	void ioThreadMain();
+
+	int m_width;
+	int m_height;
+	int m_chunkSize;
+	int m_chunksX;
+	int m_chunksY;
+
+	std::shared_ptr<Chunk> m_defaultChunk;
+	std::vector<ChunkState> m_chunkStates;
+	///Chunks changed since the last update(), and a flag per chunk to keep the list unique.
+	std::vector<int> m_changedChunks;
+	std::vector<bool> m_isChunkChanged;
+	LruCache<int, std::shared_ptr<Chunk>> m_residentChunks;
+
+	std::unique_ptr<ChunkStorage> m_storage;
+	std::thread m_ioThread;
+	std::mutex m_ioMutex;
+	///Signaled when a request is queued or the thread should stop.
+	std::condition_variable m_requestCondition;
+	///Signaled when a request has been completed.
+	std::condition_variable m_completedCondition;
+	std::deque<IoRequest> m_requests;
+	int m_requestsInProgress = 0;
+	///Loaded chunks, with null data for chunks that were not found in storage or failed to load.
+	std::vector<IoRequest> m_completedLoads;
+	std::exception_ptr m_ioError;
+	bool m_stopping = false;
+};
+
+/**
+ * @brief A screen-sized TileGrid that shows an area of a ChunkedTileGrid.
+ * @details Moving the window shifts the tiles that are still visible and only copies the newly
+ * exposed rows and columns from the world. Chunks within a margin around the window are
+ * prefetched so they are usually resident before they scroll into view.
+ */
+class ChunkedTileGridWindow
+{
+public:
+	ChunkedTileGridWindow(ChunkedTileGrid* world, int width, int height);
+	~ChunkedTileGridWindow() = default;
+
+	ChunkedTileGridWindow(const ChunkedTileGridWindow&) = delete;
+	ChunkedTileGridWindow(ChunkedTileGridWindow&&) = default;
+	ChunkedTileGridWindow& operator =(const ChunkedTileGridWindow&) = delete;
+	ChunkedTileGridWindow& operator =(ChunkedTileGridWindow&&) = default;
+
+	///Move the bottom-left corner of the window to @a position in the world.
+	void setPosition(const Vector2i& position);
+	const Vector2i& position() const {return m_position;}
+
+	///Set the number of tiles around the window whose chunks are prefetched. The default is one chunk.
+	void setPrefetchMargin(int tiles) {m_prefetchMargin = tiles;}
+	int getPrefetchMargin() const {return m_prefetchMargin;}
+
+	/**
+	 * @brief Call ChunkedTileGrid::update() and copy in the changed areas that are visible.
+	 * @details If several windows show the same world, call ChunkedTileGrid::update() once
+	 * instead and pass each area it returns to refresh() of every window.
+	 * @return true if the contents of the window changed.
+	 */
+	bool update();
+
+	///Copy the whole window from the world again.
+	void refresh();
+	///@brief Copy the part of @a worldArea that is inside the window from the world again.
+	///@return false if @a worldArea is not visible in the window.
+	bool refresh(const Rectanglei& worldArea);
+
+	const TileGrid& grid() const {return m_grid;}
+	TileGridView view() {return TileGridView(&m_grid);}
+
+protected:
+	void prefetch();
+
+	ChunkedTileGrid* m_world;
+	TileGrid m_grid;
+	Vector2i m_position;
+	int m_prefetchMargin;
+};
+
+}
+
+#endif
@@ -32,7 +32,7 @@ bool Colorf::operator !=(const Colorf& color) const
 
 Colorf Colorf::alphaBlend(const Colorf& color1, const Colorf& color2)
 {
-	return Colorf::fromByteChannels(color1.red * color1.alpha + color2.red * color2.alpha * (1. - color1.alpha),
+	return Colorf(color1.red * color1.alpha + color2.red * color2.alpha * (1. - color1.alpha),
 				   color1.green * color1.alpha + color2.green * color2.alpha * (1. - color1.alpha),
 				   color1.blue * color1.alpha + color2.blue * color2.alpha * (1. - color1.alpha),
 				   color1.alpha + color2.alpha * (1. - color1.alpha));
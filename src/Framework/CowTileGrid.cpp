@@ -0,0 +1,98 @@
+#include "Framework/CowTileGrid.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Framework/TileSpan.h"
+
+namespace rf
+{
+
+CowTileGrid::CowTileGrid(int width, int height, const Tile& tile):
+	m_width(width), m_height(height)
+{
+	//Every row starts out as the same block, so an untouched grid costs a single row.
+	m_rows.assign(height, RowReference(new Row(width, tile)));
+}
+
+CowTileGrid::CowTileGrid(const TileGrid& grid):
+	m_width(grid.width()), m_height(grid.height())
+{
+	m_rows.reserve(m_height);
+	for(int y = 0; y < m_height; ++y)
+	{
+		const Tile* row = grid.data() + y * m_width;
+		m_rows.emplace_back(new Row(row, row + m_width));
+	}
+}
+
+Tile* CowTileGrid::rowBegin(int y)
+{
+	assert(y >= 0 && y < m_height);
+
+	RowReference& row = m_rows[y];
+	if(row.isShared())
+	{
+		const std::vector<Tile>& tiles = row->tiles;
+		row = RowReference(new Row(tiles.data(), tiles.data() + tiles.size()));
+	}
+	return row->tiles.data();
+}
+
+void CowTileGrid::fill(const Tile& tile)
+{
+	m_rows.assign(m_height, RowReference(new Row(m_width, tile)));
+}
+
+void CowTileGrid::setBox(const Rectanglei& area, const Tile& tile)
+{
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+	if(left >= right)
+	{
+		return;
+	}
+
+	for(int y = bottom; y < top; ++y)
+	{
+		Tile* row = rowBegin(y);
+		tilespan::fill(row + left, row + right, tile);
+	}
+}
+
+void CowTileGrid::copyFrom(const TileGrid& grid)
+{
+	assert(grid.width() == m_width && grid.height() == m_height);
+
+	for(int y = 0; y < m_height; ++y)
+	{
+		const Tile* source = grid.data() + y * m_width;
+		if(!std::equal(source, source + m_width, m_rows[y]->tiles.begin()))
+		{
+			tilespan::copy(source, m_width, rowBegin(y));
+		}
+	}
+}
+
+void CowTileGrid::copyTo(TileGrid& grid) const
+{
+	assert(grid.width() == m_width && grid.height() == m_height);
+
+	for(int y = 0; y < m_height; ++y)
+	{
+		tilespan::copy(m_rows[y]->tiles.data(), m_width, grid.data() + y * m_width);
+	}
+}
+
+int CowTileGrid::uniqueRowCount() const
+{
+	return static_cast<int>(std::count_if(m_rows.begin(), m_rows.end(),
+		[](const RowReference& row)
+		{
+			return !row.isShared();
+		}));
+}
+
+}
@@ -0,0 +1,125 @@
+#ifndef COWTILEGRID_H_
+#define COWTILEGRID_H_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief A grid of tiles whose copies share rows until they are written, for undo and replays.
+ * @details Each row is a separately reference counted block. Copying a CowTileGrid only copies the
+ * row pointers, so a snapshot costs O(height), and writing to a row that is shared with a snapshot
+ * copies just that row first. A history of snapshots of a grid that changes a little each turn
+ * therefore stores little more than the rows that changed.
+ *
+ * Snapshots may be handed to other threads to read, as long as each CowTileGrid object is only
+ * used by one thread at a time; rows shared between threads are never written. A row is only
+ * written in place after every other grid has let go of it, which the reference count orders
+ * with acquire and release, so a reader's last access happens before the write.
+ */
+class CowTileGrid
+{
+public:
+	CowTileGrid(int width, int height, const Tile& tile = Tile());
+	explicit CowTileGrid(const TileGrid& grid);
+	~CowTileGrid() = default;
+
+	CowTileGrid(const CowTileGrid&) = default;
+	CowTileGrid(CowTileGrid&&) = default;
+	CowTileGrid& operator =(const CowTileGrid&) = default;
+	CowTileGrid& operator =(CowTileGrid&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	///Return a copy that shares every row with this grid.
+	CowTileGrid snapshot() const {return *this;}
+
+	const Tile& getTile(int x, int y) const {return m_rows[y]->tiles[x];}
+	void setTile(int x, int y, const Tile& tile) {rowBegin(y)[x] = tile;}
+
+	///Return the tiles of row @a y for writing, copying the row first if it is shared.
+	Tile* rowBegin(int y);
+	const Tile* rowBegin(int y) const {return m_rows[y]->tiles.data();}
+
+	void fill(const Tile& tile);
+	///Set every tile of @a area, clipped to the grid, to @a tile.
+	void setBox(const Rectanglei& area, const Tile& tile);
+
+	/**
+	 * @brief Make the contents equal to those of @a grid, which must have the same dimensions.
+	 * @details Rows that are already equal are left alone, so they stay shared with snapshots.
+	 */
+	void copyFrom(const TileGrid& grid);
+	///Copy the contents to @a grid, which must have the same dimensions.
+	void copyTo(TileGrid& grid) const;
+
+	///Return true if row @a y is the same block of memory in both grids, and so certainly unchanged.
+	bool sharesRow(const CowTileGrid& other, int y) const {return m_rows[y].get() == other.m_rows[y].get();}
+
+	///Return the number of rows that are not shared with any other grid.
+	int uniqueRowCount() const;
+
+protected:
+	struct Row
+	{
+		Row(int width, const Tile& tile): tiles(width, tile) {}
+		Row(const Tile* begin, const Tile* end): tiles(begin, end) {}
+
+		std::vector<Tile> tiles;
+		std::atomic<int> references{1};
+	};
+
+	/**
+	 * @brief Owns one reference to a Row.
+	 * @details Used instead of std::shared_ptr, whose use_count() is a relaxed read that doesn't
+	 * order another thread's release of the row before an in-place write.
+	 */
+	class RowReference
+	{
+	public:
+		explicit RowReference(Row* row) noexcept: m_row(row) {}
+		~RowReference() {release();}
+
+		RowReference(const RowReference& other) noexcept: m_row(other.m_row)
+		{
+			m_row->references.fetch_add(1, std::memory_order_relaxed);
+		}
+		RowReference(RowReference&& other) noexcept: m_row(other.m_row) {other.m_row = nullptr;}
+		RowReference& operator =(RowReference other) noexcept
+		{
+			std::swap(m_row, other.m_row);
+			return *this;
+		}
+
+		Row* get() const {return m_row;}
+		Row* operator ->() const {return m_row;}
+
+		///Return true if another grid holds the row, so it must not be written.
+		bool isShared() const {return m_row->references.load(std::memory_order_acquire) > 1;}
+
+	private:
+		void release()
+		{
+			if(m_row != nullptr && m_row->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete m_row;
+			}
+		}
+
+		Row* m_row;
+	};
+
+	int m_width;
+	int m_height;
+	std::vector<RowReference> m_rows;
+};
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include "Framework/CpuTextTileSet.h"
+
+#include "Framework/BitmapGlyph.h"
+
+namespace rf
+{
+
+CpuTextTileSet::CpuTextTileSet(std::shared_ptr<const FontFace> fontFace):
+	m_fontFace(std::move(fontFace))
+{
+	//The same cell size as TextTileSet, so glyphs land on the same pixels.
+	auto gCharacter = std::static_pointer_cast<const BitmapGlyph>(m_fontFace->getGlyph('g'));
+	int belowBaseline = gCharacter->top() - gCharacter->rows();
+	if(belowBaseline > 0)
+	{
+		belowBaseline = 0;
+	}
+	m_tileHeight = -belowBaseline + m_fontFace->lineHeight();
+	m_vertShift = -belowBaseline;
+}
+
+const uint8_t* CpuTextTileSet::getCoverage(unsigned int index)
+{
+	auto it = m_glyphs.find(index);
+	if(it != m_glyphs.end())
+	{
+		return it->second.data();
+	}
+
+	int bitmapSize = tileWidth() * tileHeight();
+	std::vector<uint8_t> coverage(bitmapSize, 0);
+
+	//Placed as TextTileSet::copyGlyphBitmap places it, including its clipping.
+	auto glyph = std::static_pointer_cast<const BitmapGlyph>(m_fontFace->getGlyph(index));
+	const unsigned char* sourceBitmap = glyph->buffer();
+	for(int y = 0; y < glyph->rows(); ++y)
+	{
+		int yPos = y + tileHeight() - glyph->top() - m_vertShift;
+		for(int x = 0; x < glyph->width(); ++x)
+		{
+			int pixel = x + glyph->left() + yPos * tileWidth();
+			if(pixel < bitmapSize && pixel >= 0)
+			{
+				coverage[pixel] = sourceBitmap[x + y * glyph->pitch()];
+			}
+		}
+	}
+
+	return m_glyphs.emplace(index, std::move(coverage)).first->second.data();
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef CPUTEXTTILESET_H_
+#define CPUTEXTTILESET_H_
+
+#include "Framework/CpuTileSet.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Framework/FontFace.h"
+
+namespace rf
+{
+
+/**
+ * @brief A CpuTileSet of font glyphs, laid out in their tiles exactly as TextTileSet lays them out.
+ * @details Tile indices are Unicode code points. Glyphs are rendered on first use and kept.
+ */
+class CpuTextTileSet : public CpuTileSet
+{
+public:
+	explicit CpuTextTileSet(std::shared_ptr<const FontFace> fontFace);
+	~CpuTextTileSet() = default;
+
+	CpuTextTileSet(const CpuTextTileSet&) = delete;
+	CpuTextTileSet(CpuTextTileSet&&) = default;
+	CpuTextTileSet& operator =(const CpuTextTileSet&) = delete;
+	CpuTextTileSet& operator =(CpuTextTileSet&&) = default;
+
+	virtual int tileWidth() const override {return m_fontFace->maxAdvanceWidth();}
+	virtual int tileHeight() const override {return m_tileHeight;}
+
+	virtual const uint8_t* getCoverage(unsigned int index) override;
+
+protected:
+	std::shared_ptr<const FontFace> m_fontFace;
+	std::unordered_map<unsigned int, std::vector<uint8_t>> m_glyphs;
+
+	int m_tileHeight;
+	int m_vertShift;
+};
+
+}
+
+#endif
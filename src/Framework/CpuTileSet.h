@@ -0,0 +1,36 @@
+#ifndef CPUTILESET_H_
+#define CPUTILESET_H_
+
+#include <cstdint>
+
+namespace rf
+{
+
+/**
+ * @brief The CPU counterpart of TileSet: tile bitmaps in main memory, for TileGridRasterizer.
+ * @details Tiles are coverage masks, which is all the default shaders use of a tile texture: each
+ * tile is tileWidth() * tileHeight() bytes, rows from the top down, where 0 shows only the
+ * background color and 255 only the foreground color.
+ */
+class CpuTileSet
+{
+public:
+	CpuTileSet() = default;
+	virtual ~CpuTileSet() = default;
+
+	CpuTileSet(const CpuTileSet&) = default;
+	CpuTileSet(CpuTileSet&&) = default;
+	CpuTileSet& operator =(const CpuTileSet&) = default;
+	CpuTileSet& operator =(CpuTileSet&&) = default;
+
+	virtual int tileWidth() const = 0;
+	virtual int tileHeight() const = 0;
+
+	///@brief Return the coverage mask of tile @a index.
+	///@details The mask stays valid as long as the tile set. May load the tile, so not thread safe.
+	virtual const uint8_t* getCoverage(unsigned int index) = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include "Framework/Fov/FieldOfView.h"
+
+#include <cassert>
+
+#include "Framework/Jobs/JobSystem.h"
+
+namespace rf
+{
+
+namespace
+{
+
+///Transforms from octant coordinates to map offsets, one column per octant: xx, xy, yx, yy.
+const int octantTransforms[4][8] =
+{
+	{1, 0, 0, -1, -1, 0, 0, 1},
+	{0, 1, -1, 0, 0, -1, 1, 0},
+	{0, 1, 1, 0, 0, -1, -1, 0},
+	{1, 0, 0, 1, -1, 0, 0, -1}
+};
+
+int floorDivide(int numerator, int denominator)
+{
+	int quotient = numerator / denominator;
+	if((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0)))
+	{
+		--quotient;
+	}
+	return quotient;
+}
+
+///Round @a numerator / @a denominator to the nearest integer, with halves rounding up.
+int roundTiesUp(int numerator, int denominator)
+{
+	return floorDivide(2 * numerator + denominator, 2 * denominator);
+}
+
+///Round @a numerator / @a denominator to the nearest integer, with halves rounding down.
+int roundTiesDown(int numerator, int denominator)
+{
+	return -floorDivide(-(2 * numerator - denominator), 2 * denominator);
+}
+
+bool isInside(const OpacityMap& map, int x, int y)
+{
+	return x >= 0 && y >= 0 && x < map.width() && y < map.height();
+}
+
+}
+
+void FieldOfView::compute(const OpacityMap& map, const Vector2i& origin, int radius, Algorithm algorithm)
+{
+	assert(radius >= 0);
+
+	reset(origin, radius);
+	setVisible(origin.x, origin.y);
+	if(radius == 0)
+	{
+		return;
+	}
+
+	if(algorithm == Algorithm::RecursiveShadowcasting)
+	{
+		for(int octant = 0; octant < 8; ++octant)
+		{
+			castLight(map, 1, 1.0, 0.0, octantTransforms[0][octant], octantTransforms[1][octant],
+					octantTransforms[2][octant], octantTransforms[3][octant]);
+		}
+	}
+	else
+	{
+		for(int quadrant = 0; quadrant < 4; ++quadrant)
+		{
+			scanQuadrant(map, quadrant);
+		}
+	}
+}
+
+void FieldOfView::reset(const Vector2i& origin, int radius)
+{
+	m_origin = origin;
+	m_radius = radius;
+	int side = 2 * radius + 1;
+	m_visible.reset(side, side);
+}
+
+void FieldOfView::castLight(const OpacityMap& map, int row, double startSlope, double endSlope,
+		int xx, int xy, int yx, int yy)
+{
+	if(startSlope < endSlope)
+	{
+		return;
+	}
+
+	//Cells whose centers are within radius + 1/2 of the origin are in range.
+	int rangeSquared = m_radius * m_radius + m_radius;
+	double newStartSlope = 0.0;
+
+	for(int distance = row; distance <= m_radius; ++distance)
+	{
+		int dy = -distance;
+		bool blocked = false;
+
+		for(int dx = -distance; dx <= 0; ++dx)
+		{
+			double leftSlope = (dx - 0.5) / (dy + 0.5);
+			double rightSlope = (dx + 0.5) / (dy - 0.5);
+			if(startSlope < rightSlope)
+			{
+				continue;
+			}
+			else if(endSlope > leftSlope)
+			{
+				break;
+			}
+
+			int x = m_origin.x + dx * xx + dy * xy;
+			int y = m_origin.y + dx * yx + dy * yy;
+			if(dx * dx + dy * dy <= rangeSquared && isInside(map, x, y))
+			{
+				setVisible(x, y);
+			}
+
+			bool opaque = map.isOpaque(x, y);
+			if(blocked)
+			{
+				if(opaque)
+				{
+					newStartSlope = rightSlope;
+					continue;
+				}
+				blocked = false;
+				startSlope = newStartSlope;
+			}
+			else if(opaque && distance < m_radius)
+			{
+				//Scan the part of the next row that is still lit to the left of this blocker.
+				blocked = true;
+				castLight(map, distance + 1, startSlope, leftSlope, xx, xy, yx, yy);
+				newStartSlope = rightSlope;
+			}
+		}
+
+		if(blocked)
+		{
+			break;
+		}
+	}
+}
+
+void FieldOfView::scanQuadrant(const OpacityMap& map, int quadrant)
+{
+	int rangeSquared = m_radius * m_radius + m_radius;
+
+	m_rows.clear();
+	m_rows.push_back(ScanRow{1, -1, 1, 1, 1});
+
+	while(!m_rows.empty())
+	{
+		ScanRow row = m_rows.back();
+		m_rows.pop_back();
+		if(row.depth > m_radius)
+		{
+			continue;
+		}
+
+		int minColumn = roundTiesUp(row.depth * row.startNumerator, row.startDenominator);
+		int maxColumn = roundTiesDown(row.depth * row.endNumerator, row.endDenominator);
+
+		//-1 before the first cell of the row, then whether the previous cell was opaque.
+		int previousOpaque = -1;
+		for(int column = minColumn; column <= maxColumn; ++column)
+		{
+			int x;
+			int y;
+			switch(quadrant)
+			{
+			case 0:
+				x = m_origin.x + column;
+				y = m_origin.y + row.depth;
+				break;
+			case 1:
+				x = m_origin.x + row.depth;
+				y = m_origin.y + column;
+				break;
+			case 2:
+				x = m_origin.x + column;
+				y = m_origin.y - row.depth;
+				break;
+			default:
+				x = m_origin.x - row.depth;
+				y = m_origin.y + column;
+				break;
+			}
+
+			bool opaque = map.isOpaque(x, y);
+			//A floor cell is only revealed if its center is within the visible arc, which is
+			//what makes the result symmetric.
+			bool isSymmetric = column * row.startDenominator >= row.depth * row.startNumerator
+					&& column * row.endDenominator <= row.depth * row.endNumerator;
+			if((opaque || isSymmetric) && column * column + row.depth * row.depth <= rangeSquared
+					&& isInside(map, x, y))
+			{
+				setVisible(x, y);
+			}
+
+			if(previousOpaque == 1 && !opaque)
+			{
+				row.startNumerator = 2 * column - 1;
+				row.startDenominator = 2 * row.depth;
+			}
+			if(previousOpaque == 0 && opaque)
+			{
+				m_rows.push_back(ScanRow{row.depth + 1, row.startNumerator, row.startDenominator,
+						2 * column - 1, 2 * row.depth});
+			}
+			previousOpaque = opaque ? 1 : 0;
+		}
+
+		if(previousOpaque == 0)
+		{
+			m_rows.push_back(ScanRow{row.depth + 1, row.startNumerator, row.startDenominator,
+					row.endNumerator, row.endDenominator});
+		}
+	}
+}
+
+FieldOfViewCache::FieldOfViewCache(FieldOfView::Algorithm algorithm):
+	m_algorithm(algorithm)
+{
+}
+
+FieldOfViewCache::ViewerId FieldOfViewCache::addViewer(const Vector2i& origin, int radius)
+{
+	assert(radius >= 0);
+
+	Viewer viewer{origin, radius, true, true, 0, FieldOfView()};
+	if(!m_freeIds.empty())
+	{
+		ViewerId id = m_freeIds.back();
+		m_freeIds.pop_back();
+		m_viewers[id] = std::move(viewer);
+		return id;
+	}
+
+	m_viewers.push_back(std::move(viewer));
+	return static_cast<ViewerId>(m_viewers.size()) - 1;
+}
+
+void FieldOfViewCache::removeViewer(ViewerId viewer)
+{
+	assert(m_viewers[viewer].active);
+
+	m_viewers[viewer].active = false;
+	m_freeIds.push_back(viewer);
+}
+
+void FieldOfViewCache::setViewer(ViewerId viewer, const Vector2i& origin, int radius)
+{
+	Viewer& entry = m_viewers[viewer];
+	assert(entry.active);
+
+	if(!(entry.origin == origin) || entry.radius != radius)
+	{
+		entry.origin = origin;
+		entry.radius = radius;
+		entry.stale = true;
+	}
+}
+
+const FieldOfView& FieldOfViewCache::getFieldOfView(ViewerId viewer) const
+{
+	assert(m_viewers[viewer].active);
+
+	return m_viewers[viewer].fieldOfView;
+}
+
+int FieldOfViewCache::update(const OpacityMap& map, JobSystem* jobSystem)
+{
+	m_staleViewers.clear();
+	for(ViewerId id = 0; id < static_cast<ViewerId>(m_viewers.size()); ++id)
+	{
+		const Viewer& viewer = m_viewers[id];
+		if(!viewer.active)
+		{
+			continue;
+		}
+
+		Rectanglei area(viewer.origin.x - viewer.radius, viewer.origin.y - viewer.radius,
+				2 * viewer.radius + 1, 2 * viewer.radius + 1);
+		if(viewer.stale || map.changedSince(viewer.revision, area))
+		{
+			m_staleViewers.push_back(id);
+		}
+	}
+
+	//Each viewer only writes its own FieldOfView, so they can be computed independently.
+	auto computeViewers = [this, &map](int first, int last)
+	{
+		for(int i = first; i < last; ++i)
+		{
+			Viewer& viewer = m_viewers[m_staleViewers[i]];
+			viewer.fieldOfView.compute(map, viewer.origin, viewer.radius, m_algorithm);
+			viewer.stale = false;
+			viewer.revision = map.revision();
+		}
+	};
+
+	int staleCount = static_cast<int>(m_staleViewers.size());
+	if(jobSystem != nullptr && staleCount > 1)
+	{
+		jobSystem->parallelFor(0, staleCount, 1, computeViewers);
+	}
+	else
+	{
+		computeViewers(0, staleCount);
+	}
+	return staleCount;
+}
+
+void FieldOfViewCache::invalidate()
+{
+	for(Viewer& viewer : m_viewers)
+	{
+		viewer.stale = true;
+	}
+}
+
+}
@@ -0,0 +1,175 @@
+#ifndef FIELDOFVIEW_H_
+#define FIELDOFVIEW_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/BitGrid.h"
+#include "Framework/Fov/OpacityMap.h"
+#include "Framework/Rectangle.h"
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief The set of cells visible from one point of an OpacityMap.
+ * @details Visibility is stored as a BitGrid covering the square of cells within the radius of the
+ * origin, so a FieldOfView can be recomputed many times without reallocating as long as the
+ * radius doesn't grow.
+ */
+class FieldOfView
+{
+public:
+	enum class Algorithm
+	{
+		/**
+		 * Recursive shadowcasting, scanning each octant row by row and recursing past blockers.
+		 * Fast, but not symmetric: a cell visible from another is not always able to see it back.
+		 */
+		RecursiveShadowcasting,
+		/**
+		 * Symmetric shadowcasting, which uses exact slopes and only reveals floor cells that are
+		 * in sight of the origin's center, so visibility between two floor cells is symmetric
+		 * and corridors and pillars look the same from both sides.
+		 */
+		SymmetricShadowcasting
+	};
+
+	FieldOfView() = default;
+	~FieldOfView() = default;
+
+	FieldOfView(const FieldOfView&) = default;
+	FieldOfView(FieldOfView&&) = default;
+	FieldOfView& operator =(const FieldOfView&) = default;
+	FieldOfView& operator =(FieldOfView&&) = default;
+
+	/**
+	 * @brief Compute the cells of @a map visible from @a origin within @a radius cells.
+	 * @details Distances are Euclidean. The origin itself is always visible, and opaque cells
+	 * bordering the visible area are visible.
+	 */
+	void compute(const OpacityMap& map, const Vector2i& origin, int radius,
+			Algorithm algorithm = Algorithm::SymmetricShadowcasting);
+
+	///Return true if (@a x, @a y), in map coordinates, was visible.
+	bool isVisible(int x, int y) const;
+	bool isVisible(const Vector2i& position) const {return isVisible(position.x, position.y);}
+
+	const Vector2i& origin() const {return m_origin;}
+	int radius() const {return m_radius;}
+	///Return the square of map cells that visibility was computed for.
+	Rectanglei bounds() const {return Rectanglei(m_origin.x - m_radius, m_origin.y - m_radius,
+			m_visible.width(), m_visible.height());}
+
+	///Return the number of visible cells.
+	int visibleCount() const {return m_visible.count();}
+
+	///Return the visible cells of bounds(), with (0, 0) at its bottom left.
+	const BitGrid& visibleCells() const {return m_visible;}
+
+protected:
+	///A row of a quadrant scanned by symmetric shadowcasting, with its slopes as fractions.
+	struct ScanRow
+	{
+		int depth;
+		int startNumerator;
+		int startDenominator;
+		int endNumerator;
+		int endDenominator;
+	};
+
+	void reset(const Vector2i& origin, int radius);
+	void setVisible(int x, int y);
+
+	void castLight(const OpacityMap& map, int row, double startSlope, double endSlope,
+			int xx, int xy, int yx, int yy);
+	void scanQuadrant(const OpacityMap& map, int quadrant);
+
+	Vector2i m_origin = Vector2i(0, 0);
+	int m_radius = 0;
+	BitGrid m_visible = BitGrid(1, 1);
+
+	///Reused between calls so symmetric shadowcasting doesn't allocate.
+	std::vector<ScanRow> m_rows;
+};
+
+/**
+ * @brief Keeps the fields of view of many viewers up to date.
+ * @details update() only recomputes viewers that moved, changed radius, or have had opaque
+ * cells within their radius change since they were last computed, and can spread that work
+ * over a JobSystem, one task per viewer. This suits computing the sight of every monster once
+ * per turn.
+ */
+class FieldOfViewCache
+{
+public:
+	typedef int ViewerId;
+
+	explicit FieldOfViewCache(FieldOfView::Algorithm algorithm = FieldOfView::Algorithm::SymmetricShadowcasting);
+	~FieldOfViewCache() = default;
+
+	FieldOfViewCache(const FieldOfViewCache&) = default;
+	FieldOfViewCache(FieldOfViewCache&&) = default;
+	FieldOfViewCache& operator =(const FieldOfViewCache&) = default;
+	FieldOfViewCache& operator =(FieldOfViewCache&&) = default;
+
+	///Add a viewer at @a origin. Its field of view is computed by the next update().
+	ViewerId addViewer(const Vector2i& origin, int radius);
+	void removeViewer(ViewerId viewer);
+	///Move a viewer or change its radius.
+	void setViewer(ViewerId viewer, const Vector2i& origin, int radius);
+
+	///Return the field of view of @a viewer as of the last update().
+	const FieldOfView& getFieldOfView(ViewerId viewer) const;
+
+	/**
+	 * @brief Recompute the viewers whose fields of view may be out of date.
+	 * @param jobSystem If not null, viewers are computed in parallel on it.
+	 * @return The number of viewers that were recomputed.
+	 */
+	int update(const OpacityMap& map, JobSystem* jobSystem = nullptr);
+
+	///Return the viewers that were recomputed by the last update().
+	const std::vector<ViewerId>& updatedViewers() const {return m_staleViewers;}
+
+	///Force every viewer to be recomputed by the next update(), for example after switching maps.
+	void invalidate();
+
+protected:
+	struct Viewer
+	{
+		Vector2i origin;
+		int radius;
+		bool active;
+		bool stale;
+		///The map revision the field of view was computed at.
+		uint64_t revision;
+		FieldOfView fieldOfView;
+	};
+
+	FieldOfView::Algorithm m_algorithm;
+	std::vector<Viewer> m_viewers;
+	std::vector<ViewerId> m_freeIds;
+	std::vector<ViewerId> m_staleViewers;
+};
+
+inline bool FieldOfView::isVisible(int x, int y) const
+{
+	int localX = x - m_origin.x + m_radius;
+	int localY = y - m_origin.y + m_radius;
+	if(localX < 0 || localY < 0 || localX >= m_visible.width() || localY >= m_visible.height())
+	{
+		return false;
+	}
+	return m_visible.get(localX, localY);
+}
+
+inline void FieldOfView::setVisible(int x, int y)
+{
+	m_visible.set(x - m_origin.x + m_radius, y - m_origin.y + m_radius, true);
+}
+
+}
+
+#endif
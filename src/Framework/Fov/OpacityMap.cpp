@@ -0,0 +1,65 @@
+#include "Framework/Fov/OpacityMap.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rf
+{
+
+OpacityMap::OpacityMap(int width, int height):
+	m_width(width), m_height(height), m_opaque(width, height)
+{
+}
+
+void OpacityMap::setOpaque(int x, int y, bool opaque)
+{
+	assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+	if(m_opaque.exchange(x, y, opaque))
+	{
+		m_changeLog.logChange(Rectanglei(x, y, 1, 1));
+	}
+}
+
+void OpacityMap::rebuild(const TileGrid& grid, const OpacityFunction& isOpaque)
+{
+	updateFrom(grid, Rectanglei(0, 0, m_width, m_height), isOpaque);
+}
+
+void OpacityMap::updateFrom(const TileGrid& grid, const Rectanglei& area, const OpacityFunction& isOpaque)
+{
+	assert(grid.width() == m_width && grid.height() == m_height);
+
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+
+	//Only the bounds of the cells that actually flipped are logged.
+	int changedLeft = right;
+	int changedBottom = top;
+	int changedRight = left;
+	int changedTop = bottom;
+
+	for(int y = bottom; y < top; ++y)
+	{
+		const Tile* row = grid.data() + y * m_width;
+		for(int x = left; x < right; ++x)
+		{
+			if(m_opaque.exchange(x, y, isOpaque(row[x])))
+			{
+				changedLeft = std::min(changedLeft, x);
+				changedRight = std::max(changedRight, x + 1);
+				changedBottom = std::min(changedBottom, y);
+				changedTop = std::max(changedTop, y + 1);
+			}
+		}
+	}
+
+	if(changedRight > changedLeft)
+	{
+		m_changeLog.logChange(Rectanglei(changedLeft, changedBottom, changedRight - changedLeft, changedTop - changedBottom));
+	}
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef OPACITYMAP_H_
+#define OPACITYMAP_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Framework/BitGrid.h"
+#include "Framework/RegionChangeLog.h"
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief One bit per cell recording which cells of a map block sight.
+ * @details An OpacityMap is derived from a TileGrid with an OpacityFunction and kept in sync by
+ * passing the areas of the grid that change to updateFrom(). Packing the map into bits keeps
+ * the data read by field of view calculations small enough to stay in cache.
+ *
+ * Every change increments revision(), and the areas changed by recent revisions are logged so
+ * cached results, such as those of a FieldOfViewCache, can tell whether they are still valid.
+ */
+class OpacityMap
+{
+public:
+	///Return true if a tile blocks sight.
+	typedef std::function<bool (const Tile&)> OpacityFunction;
+
+	OpacityMap(int width, int height);
+	~OpacityMap() = default;
+
+	OpacityMap(const OpacityMap&) = default;
+	OpacityMap(OpacityMap&&) = default;
+	OpacityMap& operator =(const OpacityMap&) = default;
+	OpacityMap& operator =(OpacityMap&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	///Return true if (@a x, @a y) blocks sight. Cells outside the map are opaque.
+	bool isOpaque(int x, int y) const;
+	void setOpaque(int x, int y, bool opaque);
+
+	///Recompute the whole map from @a grid, which must have the same dimensions.
+	void rebuild(const TileGrid& grid, const OpacityFunction& isOpaque);
+	///Recompute @a area of the map from the same area of @a grid.
+	void updateFrom(const TileGrid& grid, const Rectanglei& area, const OpacityFunction& isOpaque);
+
+	///Return a counter that is incremented whenever the map changes.
+	uint64_t revision() const {return m_changeLog.revision();}
+
+	/**
+	 * @brief Return true if any cell in @a area may have changed since @a revision.
+	 * @details Only a limited number of changes are logged, so this also returns true when
+	 * @a revision is too old to check.
+	 */
+	bool changedSince(uint64_t revision, const Rectanglei& area) const
+		{return m_changeLog.changedSince(revision, area);}
+
+	///Return the opaque cells as a BitGrid.
+	const BitGrid& cells() const {return m_opaque;}
+
+protected:
+	int m_width;
+	int m_height;
+	BitGrid m_opaque;
+
+	RegionChangeLog m_changeLog;
+};
+
+inline bool OpacityMap::isOpaque(int x, int y) const
+{
+	if(x < 0 || y < 0 || x >= m_width || y >= m_height)
+	{
+		return true;
+	}
+	return m_opaque.get(x, y);
+}
+
+}
+
+#endif
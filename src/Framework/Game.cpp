@@ -1,6 +1,11 @@
 #include "Game.h"
 
 #include <cassert>
+#include <thread>
+#include <algorithm>
+
+#include "Framework/Exceptions/Exception.h"
+#include "Framework/Jobs/JobSystem.h"
 
 namespace rf
 {
@@ -11,30 +16,62 @@ Game::Game()
 
 }
 
+Game::~Game()
+{
+}
+
 void Game::run()
 {
 	initialize();
 
 	m_isRunning = true;
+	m_nextFrameDeadline = Clock::now();
+	m_lastUpdateTime = Clock::now();
+	m_updateAccumulator = Clock::duration::zero();
 
-	while(m_isRunning)
+	m_simulationError = nullptr;
+
+	std::thread simulationThread;
+	if(m_threadedUpdate)
 	{
-		m_frameStartTime = Clock::now();
+		if(m_fixedUpdateRate <= 0)
+		{
+			m_isRunning = false;
+			throw Exception("Threaded update requires a fixed update rate");
+		}
+		//The thread gets its own copy of the timing, the setters are not synchronized with it.
+		simulationThread = std::thread(&Game::runSimulationThread, this, fixedUpdateStep(), m_maxUpdatesPerFrame);
+	}
 
-		update();
-		draw();
+	try
+	{
+		while(m_isRunning)
+		{
+			m_frameStartTime = Clock::now();
 
-		auto frameDuration =
-				std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Clock::now() - m_frameStartTime);
+			double interpolation = m_threadedUpdate ? 1.0 : runUpdates();
+			draw(interpolation);
 
-		if(m_targetFrameRate > 0)
+			waitForNextFrame();
+		}
+	}
+	catch(...)
+	{
+		m_isRunning = false;
+		if(simulationThread.joinable())
 		{
-			double delayTime = (1000.0 / m_targetFrameRate) - frameDuration.count();
-			if(delayTime > 0.0)
-			{
-				SDL_Delay(delayTime);
-			}
+			simulationThread.join();
 		}
+		throw;
+	}
+
+	if(simulationThread.joinable())
+	{
+		simulationThread.join();
+	}
+	if(m_simulationError)
+	{
+		std::rethrow_exception(m_simulationError);
 	}
 }
 
@@ -43,6 +80,61 @@ void Game::setTargetFrameRate(double target)
 	assert(target >= 0.0);
 
 	m_targetFrameRate = target;
+	m_nextFrameDeadline = Clock::now();
+}
+
+void Game::setFramePacing(FramePacing pacing)
+{
+	m_framePacing = pacing;
+	m_nextFrameDeadline = Clock::now();
+}
+
+void Game::setSpinThreshold(Clock::duration threshold)
+{
+	assert(threshold >= Clock::duration::zero());
+
+	m_spinThreshold = threshold;
+}
+
+void Game::setFixedUpdateRate(double ticksPerSecond)
+{
+	assert(ticksPerSecond >= 0.0);
+
+	m_fixedUpdateRate = ticksPerSecond;
+	m_updateAccumulator = Clock::duration::zero();
+	m_lastUpdateTime = Clock::now();
+}
+
+void Game::setMaxUpdatesPerFrame(int count)
+{
+	assert(count > 0);
+
+	m_maxUpdatesPerFrame = count;
+}
+
+void Game::setThreadedUpdate(bool enabled)
+{
+	assert(!m_isRunning);
+
+	m_threadedUpdate = enabled;
+}
+
+JobSystem& Game::jobSystem()
+{
+	if(!m_jobSystem)
+	{
+		int workerCount = m_workerThreadCount >= 0 ? m_workerThreadCount : JobSystem::defaultWorkerCount();
+		m_jobSystem.reset(new JobSystem(workerCount));
+	}
+	return *m_jobSystem;
+}
+
+void Game::setWorkerThreadCount(int count)
+{
+	assert(count >= 0);
+	assert(!m_jobSystem);
+
+	m_workerThreadCount = count;
 }
 
 void Game::stop()
@@ -50,6 +142,133 @@ void Game::stop()
 	m_isRunning = false;
 }
 
+double Game::runUpdates()
+{
+	if(m_fixedUpdateRate <= 0)
+	{
+		update();
+		return 1.0;
+	}
+
+	//Keep the step and accumulator in whole clock ticks so the number of
+	//updates run for a given amount of elapsed time is deterministic.
+	Clock::duration step = fixedUpdateStep();
+
+	m_updateAccumulator += m_frameStartTime - m_lastUpdateTime;
+	m_lastUpdateTime = m_frameStartTime;
+
+	int updateCount = 0;
+	while(m_updateAccumulator >= step && updateCount < m_maxUpdatesPerFrame && m_isRunning)
+	{
+		update();
+		m_updateAccumulator -= step;
+		++updateCount;
+	}
+
+	//Drop whatever could not be caught up on rather than spiraling further behind.
+	if(m_updateAccumulator >= step)
+	{
+		m_updateAccumulator = m_updateAccumulator % step;
+	}
+
+	return static_cast<double>(m_updateAccumulator.count()) / step.count();
+}
+
+Game::Clock::duration Game::fixedUpdateStep() const
+{
+	auto step = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(1.0 / m_fixedUpdateRate));
+	return std::max(step, Clock::duration(1));
+}
+
+void Game::runSimulationThread(Clock::duration step, int maxUpdatesBehind)
+{
+	try
+	{
+		Clock::time_point nextUpdateTime = Clock::now();
+		while(m_isRunning)
+		{
+			update();
+
+			nextUpdateTime += step;
+
+			Clock::time_point now = Clock::now();
+			if(now > nextUpdateTime + step * maxUpdatesBehind)
+			{
+				//Too far behind to catch up, drop the backlog.
+				nextUpdateTime = now;
+			}
+			else if(now < nextUpdateTime)
+			{
+				waitUntil(nextUpdateTime);
+			}
+		}
+	}
+	catch(...)
+	{
+		m_simulationError = std::current_exception();
+		m_isRunning = false;
+	}
+}
+
+void Game::waitForNextFrame()
+{
+	if(m_targetFrameRate <= 0)
+	{
+		return;
+	}
+
+	//The swap only blocks while the swap interval of the current context is on, see
+	//SdlGlContext::isVerticalSyncEnabled. Without it, pace the frame as FramePacing::Precise.
+	if(m_framePacing == FramePacing::VerticalSync && SDL_GL_GetSwapInterval() != 0)
+	{
+		return;
+	}
+
+	if(m_framePacing == FramePacing::Delay)
+	{
+		auto frameDuration =
+				std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Clock::now() - m_frameStartTime);
+
+		double delayTime = (1000.0 / m_targetFrameRate) - frameDuration.count();
+		if(delayTime > 0.0)
+		{
+			SDL_Delay(delayTime);
+		}
+		return;
+	}
+
+	auto framePeriod = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(1.0 / m_targetFrameRate));
+
+	m_nextFrameDeadline += framePeriod;
+
+	Clock::time_point now = Clock::now();
+	//If we have fallen more than a frame behind, don't try to catch up by
+	//running a burst of unpaced frames, just start pacing again from here.
+	if(now > m_nextFrameDeadline + framePeriod)
+	{
+		m_nextFrameDeadline = now;
+		return;
+	}
+
+	waitUntil(m_nextFrameDeadline);
+}
+
+void Game::waitUntil(Clock::time_point deadline) const
+{
+	Clock::time_point sleepEnd = deadline - m_spinThreshold;
+	if(Clock::now() < sleepEnd)
+	{
+		std::this_thread::sleep_until(sleepEnd);
+	}
+
+	while(Clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+}
+
 }
 
 
@@ -2,19 +2,35 @@
 #define GAME_H_
 
 #include <chrono>
+#include <atomic>
+#include <exception>
+#include <memory>
 
 #include <SDL2/SDL.h>
 
 namespace rf
 {
+class JobSystem;
 
 class Game
 {
 public:
-	typedef std::chrono::high_resolution_clock Clock;
+	typedef std::chrono::steady_clock Clock;
+
+	///@brief The method used to wait out the remainder of a frame.
+	enum class FramePacing
+	{
+		///Sleep for the remaining whole milliseconds of the frame with SDL_Delay.
+		Delay,
+		///Sleep coarsely, then yield until an absolute deadline that is carried from frame to frame.
+		Precise,
+		///Never sleep. The buffer swap is expected to block until the vertical blank.
+		///Falls back to Precise while the swap interval of the current context is off.
+		VerticalSync
+	};
 
 	Game();
-	virtual ~Game() = default;
+	virtual ~Game();
 
 	Game(const Game&) = delete;
 	Game(Game&&) = delete;
@@ -30,20 +46,106 @@ public:
 
 	double getTargetFrameRate() const {return m_targetFrameRate;}
 
+	///@brief Set the method used to limit the frame rate.
+	///@details The default is FramePacing::Delay. FramePacing::VerticalSync relies on the swap
+	///interval of the context, see SdlGlContext::isVerticalSyncEnabled, and paces frames as
+	///FramePacing::Precise for as long as it is off.
+	void setFramePacing(FramePacing pacing);
+
+	FramePacing getFramePacing() const {return m_framePacing;}
+
+	///@brief Set how long before a frame deadline FramePacing::Precise stops sleeping and
+	///starts yielding.
+	///@details This should be somewhat larger than the scheduler quantum of the platform.
+	///The default value is 2 milliseconds.
+	void setSpinThreshold(Clock::duration threshold);
+
+	Clock::duration getSpinThreshold() const {return m_spinThreshold;}
+
+	///@brief Run update() at a fixed rate that is independent of the frame rate.
+	///@details Elapsed time is accumulated and update() is called zero or more times
+	///per frame to consume it in steps of 1 / @a ticksPerSecond seconds. A value of zero
+	///calls update() exactly once per frame. The default value is 0.
+	void setFixedUpdateRate(double ticksPerSecond);
+
+	double getFixedUpdateRate() const {return m_fixedUpdateRate;}
+
+	///@brief Set the maximum number of fixed steps run in a single frame.
+	///@details When a frame stalls for longer than this many steps, the excess time is
+	///dropped and the simulation slows down instead of falling further behind.
+	///The default value is 5.
+	void setMaxUpdatesPerFrame(int count);
+
+	int getMaxUpdatesPerFrame() const {return m_maxUpdatesPerFrame;}
+
+	/**
+	 * @brief Run update() on a separate simulation thread.
+	 * @details draw() keeps running on the thread that called run(), paced by the target
+	 * frame rate, while update() runs on the simulation thread at the fixed update rate. The
+	 * two must not share mutable state; update() should write into a TileGridSnapshotBuffer and
+	 * publish it, and draw() should render the most recently published snapshot. draw(double)
+	 * is always passed an interpolation of 1 in this mode. This must be set before run() is
+	 * called, and run() throws an Exception if no fixed update rate is set by then. The fixed
+	 * update rate and the maximum updates per frame are read once when run() starts.
+	 */
+	void setThreadedUpdate(bool enabled);
+
+	bool isThreadedUpdate() const {return m_threadedUpdate;}
+
+	/**
+	 * @brief Return the JobSystem shared by the game and the framework.
+	 * @details The worker threads are started on first use, with the count given to
+	 * setWorkerThreadCount() or JobSystem::defaultWorkerCount() if none was given.
+	 */
+	JobSystem& jobSystem();
+
+	///@brief Set the number of worker threads of the JobSystem.
+	///@details This must be called before jobSystem() is first used.
+	void setWorkerThreadCount(int count);
+
 	void stop();
 
 protected:
 
-	virtual void draw() = 0;
+	///@brief Draw a frame between two fixed updates.
+	///@details @a interpolation is the fraction of a fixed step, in [0, 1), that has elapsed
+	///since the last update(). It is always 1 when no fixed update rate is set.
+	virtual void draw(double interpolation) = 0;
 	virtual void update() = 0;
 	virtual void initialize() = 0;
 
-	bool m_isRunning = false;
+	///Run the updates due this frame, returning the interpolation value to draw with.
+	double runUpdates();
+
+	///Wait until the end of the current frame as dictated by the frame pacing mode.
+	void waitForNextFrame();
+
+	std::atomic<bool> m_isRunning{false};
 	Clock::time_point m_frameStartTime;
 
 private:
 
+	void waitUntil(Clock::time_point deadline) const;
+	Clock::duration fixedUpdateStep() const;
+	void runSimulationThread(Clock::duration step, int maxUpdatesBehind);
+
 	double m_targetFrameRate = 0.0;
+	FramePacing m_framePacing = FramePacing::Delay;
+	Clock::duration m_spinThreshold = std::chrono::milliseconds(2);
+
+	///The absolute time the current frame should end, carried forward by whole frame periods.
+	Clock::time_point m_nextFrameDeadline;
+
+	double m_fixedUpdateRate = 0.0;
+	int m_maxUpdatesPerFrame = 5;
+	Clock::duration m_updateAccumulator = Clock::duration::zero();
+	Clock::time_point m_lastUpdateTime;
+
+	bool m_threadedUpdate = false;
+	std::exception_ptr m_simulationError;
+
+	int m_workerThreadCount = -1;
+	std::unique_ptr<JobSystem> m_jobSystem;
 };
 
 }
@@ -0,0 +1,151 @@
+#include "Framework/Generation/BspGenerator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include "Framework/Generation/Random.h"
+#include "Framework/Jobs/JobSystem.h"
+
+namespace rf
+{
+
+namespace
+{
+
+///Subtrees above this depth are split as separate tasks.
+const int parallelDepth = 4;
+
+Vector2i roomCenter(const Rectanglei& room)
+{
+	return Vector2i(room.left() + room.width() / 2, room.bottom() + room.height() / 2);
+}
+
+}
+
+BspGenerator::BspGenerator(int width, int height):
+	m_width(width), m_height(height)
+{
+}
+
+void BspGenerator::setMinimumLeafSize(int size)
+{
+	//A leaf must fit the smallest room with a wall on either side.
+	assert(size >= m_minimumRoomSize + 2);
+
+	m_minimumLeafSize = size;
+}
+
+void BspGenerator::setMinimumRoomSize(int size)
+{
+	assert(size > 0 && size + 2 <= m_minimumLeafSize);
+
+	m_minimumRoomSize = size;
+}
+
+void BspGenerator::generate(uint64_t seed, JobSystem* jobSystem)
+{
+	m_seed = seed;
+	m_rooms.clear();
+	m_corridors.clear();
+	if(m_width < m_minimumLeafSize || m_height < m_minimumLeafSize)
+	{
+		return;
+	}
+
+	Node root;
+	root.area = Rectanglei(0, 0, m_width, m_height);
+	split(root, 1, 0, jobSystem);
+	collect(root, 1);
+}
+
+void BspGenerator::apply(TileGridView& view, const Tile& wall, const Tile& floor) const
+{
+	view.fill(wall);
+	for(const Rectanglei& room : m_rooms)
+	{
+		view.setBox(room, floor);
+	}
+	for(const Corridor& corridor : m_corridors)
+	{
+		view.setBox(std::min(corridor.start.x, corridor.corner.x), std::min(corridor.start.y, corridor.corner.y),
+				std::abs(corridor.corner.x - corridor.start.x) + 1, std::abs(corridor.corner.y - corridor.start.y) + 1, floor);
+		view.setBox(std::min(corridor.corner.x, corridor.end.x), std::min(corridor.corner.y, corridor.end.y),
+				std::abs(corridor.end.x - corridor.corner.x) + 1, std::abs(corridor.end.y - corridor.corner.y) + 1, floor);
+	}
+}
+
+void BspGenerator::split(Node& node, uint64_t path, int depth, JobSystem* jobSystem) const
+{
+	Random random(Random::hash(m_seed, path));
+	const Rectanglei& area = node.area;
+	bool canSplitX = area.width() >= 2 * m_minimumLeafSize;
+	bool canSplitY = area.height() >= 2 * m_minimumLeafSize;
+
+	if(!canSplitX && !canSplitY)
+	{
+		//Leave at least one cell of wall between the room and the edge of its area.
+		int roomWidth = random.nextInt(m_minimumRoomSize, area.width() - 2);
+		int roomHeight = random.nextInt(m_minimumRoomSize, area.height() - 2);
+		int roomX = random.nextInt(area.left() + 1, area.right() - 1 - roomWidth);
+		int roomY = random.nextInt(area.bottom() + 1, area.top() - 1 - roomHeight);
+		node.room = Rectanglei(roomX, roomY, roomWidth, roomHeight);
+		return;
+	}
+
+	bool splitX = canSplitX && (!canSplitY || area.width() > area.height()
+			|| (area.width() == area.height() && random.nextBool(0.5f)));
+	node.children[0].reset(new Node());
+	node.children[1].reset(new Node());
+	if(splitX)
+	{
+		int position = random.nextInt(m_minimumLeafSize, area.width() - m_minimumLeafSize);
+		node.children[0]->area = Rectanglei(area.left(), area.bottom(), position, area.height());
+		node.children[1]->area = Rectanglei(area.left() + position, area.bottom(), area.width() - position, area.height());
+	}
+	else
+	{
+		int position = random.nextInt(m_minimumLeafSize, area.height() - m_minimumLeafSize);
+		node.children[0]->area = Rectanglei(area.left(), area.bottom(), area.width(), position);
+		node.children[1]->area = Rectanglei(area.left(), area.bottom() + position, area.width(), area.height() - position);
+	}
+
+	if(jobSystem != nullptr && depth < parallelDepth)
+	{
+		JobSystem::TaskHandle task = jobSystem->run(
+			[this, &node, path, depth, jobSystem]()
+			{
+				split(*node.children[1], path * 2 + 1, depth + 1, jobSystem);
+			});
+		split(*node.children[0], path * 2, depth + 1, jobSystem);
+		jobSystem->wait(task);
+	}
+	else
+	{
+		split(*node.children[0], path * 2, depth + 1, jobSystem);
+		split(*node.children[1], path * 2 + 1, depth + 1, jobSystem);
+	}
+}
+
+int BspGenerator::collect(const Node& node, uint64_t path)
+{
+	if(!node.children[0])
+	{
+		m_rooms.push_back(node.room);
+		return static_cast<int>(m_rooms.size()) - 1;
+	}
+
+	int first = collect(*node.children[0], path * 2);
+	int second = collect(*node.children[1], path * 2 + 1);
+
+	//Join the halves through one room of each, turning either horizontally or vertically first.
+	Random random(Random::hash(m_seed, ~path));
+	Vector2i start = roomCenter(m_rooms[first]);
+	Vector2i end = roomCenter(m_rooms[second]);
+	Vector2i corner = random.nextBool(0.5f) ? Vector2i(end.x, start.y) : Vector2i(start.x, end.y);
+	m_corridors.push_back(Corridor{start, corner, end});
+
+	return random.nextBool(0.5f) ? first : second;
+}
+
+}
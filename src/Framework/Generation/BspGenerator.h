@@ -0,0 +1,84 @@
+#ifndef BSPGENERATOR_H_
+#define BSPGENERATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Framework/Rectangle.h"
+#include "Framework/TileGridView.h"
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief Generates rooms and corridors by binary space partitioning.
+ * @details The map is split in two at a random position, across its longer side, and each half is
+ * split again until the pieces are too small to split. A room is placed at random in each piece,
+ * and the two halves of every split are joined by an L-shaped corridor between a room on each side.
+ *
+ * The random numbers of each split are derived from the seed and the split's position in the tree,
+ * so the upper levels of the tree can be split in parallel and still produce the same map.
+ */
+class BspGenerator
+{
+public:
+	///An L-shaped corridor from @a start to @a end, turning at @a corner.
+	struct Corridor
+	{
+		Vector2i start;
+		Vector2i corner;
+		Vector2i end;
+	};
+
+	BspGenerator(int width, int height);
+	~BspGenerator() = default;
+
+	BspGenerator(const BspGenerator&) = default;
+	BspGenerator(BspGenerator&&) = default;
+	BspGenerator& operator =(const BspGenerator&) = default;
+	BspGenerator& operator =(BspGenerator&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	///Set the smallest size, in both dimensions, a piece of the map may be split into. The default is 10.
+	void setMinimumLeafSize(int size);
+	///Set the smallest size of a room, in both dimensions. The default is 4.
+	void setMinimumRoomSize(int size);
+
+	void generate(uint64_t seed, JobSystem* jobSystem = nullptr);
+
+	const std::vector<Rectanglei>& rooms() const {return m_rooms;}
+	const std::vector<Corridor>& corridors() const {return m_corridors;}
+
+	///Fill @a view with @a wall, then carve the rooms and corridors out of it with @a floor.
+	void apply(TileGridView& view, const Tile& wall, const Tile& floor) const;
+
+protected:
+	struct Node
+	{
+		Rectanglei area;
+		Rectanglei room;
+		std::unique_ptr<Node> children[2];
+	};
+
+	///Split @a node and its descendants. @a path identifies the node for seeding.
+	void split(Node& node, uint64_t path, int depth, JobSystem* jobSystem) const;
+	///Collect the rooms and corridors of the subtree, returning the index of a room in it.
+	int collect(const Node& node, uint64_t path);
+
+	int m_width;
+	int m_height;
+	int m_minimumLeafSize = 10;
+	int m_minimumRoomSize = 4;
+	uint64_t m_seed = 0;
+
+	std::vector<Rectanglei> m_rooms;
+	std::vector<Corridor> m_corridors;
+};
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "Framework/Generation/CaveGenerator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "Framework/Generation/Random.h"
+#include "Framework/Jobs/JobSystem.h"
+
+namespace rf
+{
+
+namespace
+{
+
+const uint64_t allWalls = ~uint64_t(0);
+const int rowsPerJob = 16;
+
+///Add the one bit numbers in @a value to the four bit counters in @a count, one per bit position.
+inline void addBits(uint64_t count[4], uint64_t value)
+{
+	for(int bit = 0; bit < 4; ++bit)
+	{
+		uint64_t carry = count[bit] & value;
+		count[bit] ^= value;
+		value = carry;
+	}
+}
+
+///Return a mask of the bit positions where the count in @a count is at least @a limit, which is in [0, 9].
+inline uint64_t atLeast(const uint64_t count[4], int limit)
+{
+	//Compare from the most significant bit down: greater where the first differing bit is set.
+	uint64_t greater = 0;
+	uint64_t equal = allWalls;
+	for(int bit = 3; bit >= 0; --bit)
+	{
+		uint64_t limitBit = (limit >> bit) & 1 ? allWalls : 0;
+		greater |= equal & count[bit] & ~limitBit;
+		equal &= ~(count[bit] ^ limitBit);
+	}
+	return greater | equal;
+}
+
+}
+
+CaveGenerator::CaveGenerator(int width, int height):
+	m_width(width), m_height(height), m_cells(width, height, true), m_nextCells(width, height, true)
+{
+}
+
+void CaveGenerator::setWallProbability(float probability)
+{
+	assert(probability >= 0.0f && probability <= 1.0f);
+
+	m_wallProbability = probability;
+}
+
+void CaveGenerator::setLimits(int birthLimit, int survivalLimit)
+{
+	assert(birthLimit >= 0 && birthLimit <= 9 && survivalLimit >= 0 && survivalLimit <= 9);
+
+	m_birthLimit = birthLimit;
+	m_survivalLimit = survivalLimit;
+}
+
+void CaveGenerator::generate(uint64_t seed, int steps, JobSystem* jobSystem)
+{
+	//Each cell's wall is decided by hashing its position, so rows can be filled in any order.
+	auto fillRows = [this, seed](int firstRow, int lastRow)
+	{
+		uint64_t threshold = static_cast<uint64_t>(m_wallProbability * 4294967296.0);
+		int wordsPerRow = m_cells.wordsPerRow();
+		for(int y = firstRow; y < lastRow; ++y)
+		{
+			uint64_t* row = m_cells.row(y);
+			for(int word = 0; word < wordsPerRow; ++word)
+			{
+				uint64_t bits = 0;
+				for(int bit = 0; bit < 64; ++bit)
+				{
+					if((Random::hash(seed, word * 64 + bit, y) >> 32) < threshold)
+					{
+						bits |= uint64_t(1) << bit;
+					}
+				}
+				row[word] = bits;
+			}
+			row[wordsPerRow - 1] &= m_cells.lastWordMask();
+		}
+	};
+
+	if(jobSystem != nullptr)
+	{
+		jobSystem->parallelFor(0, m_height, rowsPerJob, fillRows);
+	}
+	else
+	{
+		fillRows(0, m_height);
+	}
+
+	smooth(steps, jobSystem);
+}
+
+void CaveGenerator::smooth(int steps, JobSystem* jobSystem)
+{
+	for(int step = 0; step < steps; ++step)
+	{
+		if(jobSystem != nullptr)
+		{
+			jobSystem->parallelFor(0, m_height, rowsPerJob,
+				[this](int firstRow, int lastRow)
+				{
+					stepRows(firstRow, lastRow);
+				});
+		}
+		else
+		{
+			stepRows(0, m_height);
+		}
+		std::swap(m_cells, m_nextCells);
+	}
+}
+
+void CaveGenerator::apply(TileGridView& view, const Tile& wall, const Tile& floor) const
+{
+	int width = std::min(view.width(), m_width);
+	int height = std::min(view.height(), m_height);
+	for(int y = 0; y < height; ++y)
+	{
+		Tile* row = view.rowBegin(y);
+		for(int x = 0; x < width; ++x)
+		{
+			row[x] = isWall(x, y) ? wall : floor;
+		}
+	}
+}
+
+void CaveGenerator::stepRows(int firstRow, int lastRow)
+{
+	int lastWord = m_cells.wordsPerRow() - 1;
+	//The unused bits past the end of each row stand in for the wall beyond the right edge.
+	const uint64_t padding = ~m_cells.lastWordMask();
+
+	for(int y = firstRow; y < lastRow; ++y)
+	{
+		const uint64_t* rows[3] =
+		{
+			y > 0 ? m_cells.row(y - 1) : nullptr,
+			m_cells.row(y),
+			y + 1 < m_height ? m_cells.row(y + 1) : nullptr
+		};
+		uint64_t* output = m_nextCells.row(y);
+
+		for(int word = 0; word <= lastWord; ++word)
+		{
+			uint64_t count[4] = {0, 0, 0, 0};
+			for(int r = 0; r < 3; ++r)
+			{
+				//Rows above and below the map are solid wall.
+				uint64_t center = rows[r] ? rows[r][word] | (word == lastWord ? padding : 0) : allWalls;
+				uint64_t previous = rows[r] && word > 0 ? rows[r][word - 1] : allWalls;
+				uint64_t next = rows[r] && word < lastWord ? rows[r][word + 1] : allWalls;
+
+				//Bit x of these is the cell to the left and right of x.
+				addBits(count, (center << 1) | (previous >> 63));
+				addBits(count, (center >> 1) | (next << 63));
+				if(r != 1)
+				{
+					addBits(count, center);
+				}
+			}
+
+			uint64_t walls = rows[1][word];
+			output[word] = atLeast(count, m_birthLimit) | (walls & atLeast(count, m_survivalLimit));
+		}
+		output[lastWord] &= m_cells.lastWordMask();
+	}
+}
+
+}
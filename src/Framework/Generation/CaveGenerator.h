@@ -0,0 +1,72 @@
+#ifndef CAVEGENERATOR_H_
+#define CAVEGENERATOR_H_
+
+#include <cstdint>
+
+#include "Framework/BitGrid.h"
+#include "Framework/TileGridView.h"
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief Generates caves by smoothing random noise with a cellular automaton.
+ * @details The map starts as walls placed at random, then each step turns a cell into a wall if at
+ * least birthLimit of its eight neighbors are walls, or keeps it a wall if at least survivalLimit
+ * are. Cells outside the map count as walls, so caves are closed.
+ *
+ * The map is stored as a BitGrid and the automaton is run on 64 cells at a time: the eight
+ * neighbor planes of a word are summed with bitwise adders and the rule applied with a few masks,
+ * reading one buffer and writing the other. Rows are independent within a step, so steps can be
+ * spread over a JobSystem, and the result depends only on the seed, not on how the work was split.
+ */
+class CaveGenerator
+{
+public:
+	CaveGenerator(int width, int height);
+	~CaveGenerator() = default;
+
+	CaveGenerator(const CaveGenerator&) = default;
+	CaveGenerator(CaveGenerator&&) = default;
+	CaveGenerator& operator =(const CaveGenerator&) = default;
+	CaveGenerator& operator =(CaveGenerator&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	///Set the chance of each cell starting as a wall. The default is 0.45.
+	void setWallProbability(float probability);
+	///Set the neighbor counts of the automaton rule. The defaults are 5 and 4.
+	void setLimits(int birthLimit, int survivalLimit);
+
+	///Fill the map with random walls and run @a steps steps of the automaton.
+	void generate(uint64_t seed, int steps = 4, JobSystem* jobSystem = nullptr);
+	///Run @a steps more steps of the automaton on the current map.
+	void smooth(int steps, JobSystem* jobSystem = nullptr);
+
+	bool isWall(int x, int y) const {return m_cells.get(x, y);}
+	void setWall(int x, int y, bool wall) {m_cells.set(x, y, wall);}
+
+	///Return the walls of the map.
+	const BitGrid& walls() const {return m_cells;}
+
+	///Set each tile of @a view to @a wall or @a floor.
+	void apply(TileGridView& view, const Tile& wall, const Tile& floor) const;
+
+protected:
+	void stepRows(int firstRow, int lastRow);
+
+	int m_width;
+	int m_height;
+	float m_wallProbability = 0.45f;
+	int m_birthLimit = 5;
+	int m_survivalLimit = 4;
+
+	BitGrid m_cells;
+	BitGrid m_nextCells;
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "Framework/Generation/NoiseField.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "Framework/Generation/Random.h"
+#include "Framework/Jobs/JobSystem.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rf
+{
+
+namespace
+{
+
+const int rowsPerJob = 16;
+
+inline float latticeValue(uint64_t seed, int x, int y)
+{
+	return static_cast<float>(Random::hash(seed, x, y) >> 40) * (1.0f / 16777216.0f);
+}
+
+inline float smoothStep(float t)
+{
+	return t * t * (3.0f - 2.0f * t);
+}
+
+}
+
+NoiseField::NoiseField(int width, int height):
+	m_width(width), m_height(height), m_values(width * height, 0.0f)
+{
+}
+
+void NoiseField::generate(uint64_t seed, float frequency, int octaves, float persistence, JobSystem* jobSystem)
+{
+	assert(frequency > 0.0f && octaves > 0);
+
+	if(jobSystem != nullptr)
+	{
+		jobSystem->parallelFor(0, m_height, rowsPerJob,
+			[&](int firstRow, int lastRow)
+			{
+				generateRows(seed, frequency, octaves, persistence, firstRow, lastRow);
+			});
+	}
+	else
+	{
+		generateRows(seed, frequency, octaves, persistence, 0, m_height);
+	}
+}
+
+void NoiseField::generateRows(uint64_t seed, float frequency, int octaves, float persistence, int firstRow, int lastRow)
+{
+	float totalAmplitude = 0.0f;
+	float octaveAmplitude = 1.0f;
+	for(int octave = 0; octave < octaves; ++octave)
+	{
+		totalAmplitude += octaveAmplitude;
+		octaveAmplitude *= persistence;
+	}
+	float normalization = 1.0f / totalAmplitude;
+
+	//The lattice interpolated down to the current row, one value per lattice column.
+	std::vector<float> columns;
+
+	for(int y = firstRow; y < lastRow; ++y)
+	{
+		float* row = &m_values[y * m_width];
+		std::fill(row, row + m_width, 0.0f);
+
+		float octaveFrequency = frequency;
+		float amplitude = 1.0f;
+		for(int octave = 0; octave < octaves; ++octave)
+		{
+			uint64_t octaveSeed = Random::hash(seed, static_cast<uint64_t>(octave));
+			float latticeY = y * octaveFrequency;
+			int cellY = static_cast<int>(latticeY);
+			float weightY = smoothStep(latticeY - cellY);
+
+			int columnCount = static_cast<int>((m_width - 1) * octaveFrequency) + 2;
+			columns.resize(columnCount);
+			for(int i = 0; i < columnCount; ++i)
+			{
+				float below = latticeValue(octaveSeed, i, cellY);
+				float above = latticeValue(octaveSeed, i, cellY + 1);
+				columns[i] = below + (above - below) * weightY;
+			}
+
+			int x = 0;
+#if defined(__SSE2__)
+			const __m128 frequencies = _mm_set1_ps(octaveFrequency);
+			const __m128 amplitudes = _mm_set1_ps(amplitude);
+			const __m128 three = _mm_set1_ps(3.0f);
+			const __m128 two = _mm_set1_ps(2.0f);
+			for(; x + 4 <= m_width; x += 4)
+			{
+				__m128 latticeX = _mm_mul_ps(_mm_setr_ps(x, x + 1, x + 2, x + 3), frequencies);
+				__m128i cellX = _mm_cvttps_epi32(latticeX);
+				__m128 t = _mm_sub_ps(latticeX, _mm_cvtepi32_ps(cellX));
+				__m128 weightX = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+
+				alignas(16) int cells[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(cells), cellX);
+				__m128 left = _mm_setr_ps(columns[cells[0]], columns[cells[1]], columns[cells[2]], columns[cells[3]]);
+				__m128 right = _mm_setr_ps(columns[cells[0] + 1], columns[cells[1] + 1], columns[cells[2] + 1],
+						columns[cells[3] + 1]);
+
+				__m128 noise = _mm_add_ps(left, _mm_mul_ps(_mm_sub_ps(right, left), weightX));
+				_mm_storeu_ps(row + x, _mm_add_ps(_mm_loadu_ps(row + x), _mm_mul_ps(noise, amplitudes)));
+			}
+#endif
+			for(; x < m_width; ++x)
+			{
+				float latticeX = x * octaveFrequency;
+				int cellX = static_cast<int>(latticeX);
+				float weightX = smoothStep(latticeX - cellX);
+				row[x] += (columns[cellX] + (columns[cellX + 1] - columns[cellX]) * weightX) * amplitude;
+			}
+
+			octaveFrequency *= 2.0f;
+			amplitude *= persistence;
+		}
+
+		for(int x = 0; x < m_width; ++x)
+		{
+			row[x] *= normalization;
+		}
+	}
+}
+
+}
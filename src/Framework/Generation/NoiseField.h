@@ -0,0 +1,57 @@
+#ifndef NOISEFIELD_H_
+#define NOISEFIELD_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief A grid of smooth noise values in [0, 1], for terrain height, moisture and the like.
+ * @details Noise is fractal value noise: random values on a lattice, smoothly interpolated, summed
+ * over several octaves of increasing frequency and decreasing amplitude. Lattice values come from
+ * hashing the seed and lattice position, so rows can be generated in any order, in parallel, with
+ * the same result. The interpolation of each row runs four cells at a time with SSE2 where it is
+ * available.
+ */
+class NoiseField
+{
+public:
+	NoiseField(int width, int height);
+	~NoiseField() = default;
+
+	NoiseField(const NoiseField&) = default;
+	NoiseField(NoiseField&&) = default;
+	NoiseField& operator =(const NoiseField&) = default;
+	NoiseField& operator =(NoiseField&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	/**
+	 * @brief Fill the field with fractal value noise.
+	 * @param frequency The number of lattice cells per grid cell of the first octave, such as 1 / 16.
+	 * @param octaves The number of octaves; each has twice the frequency of the last.
+	 * @param persistence The amplitude of each octave relative to the last.
+	 */
+	void generate(uint64_t seed, float frequency, int octaves = 4, float persistence = 0.5f,
+			JobSystem* jobSystem = nullptr);
+
+	float value(int x, int y) const {return m_values[x + y * m_width];}
+
+	///Return the values, row by row starting at y = 0.
+	const float* data() const {return m_values.data();}
+
+protected:
+	void generateRows(uint64_t seed, float frequency, int octaves, float persistence, int firstRow, int lastRow);
+
+	int m_width;
+	int m_height;
+	std::vector<float> m_values;
+};
+
+}
+
+#endif
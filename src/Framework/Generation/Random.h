@@ -0,0 +1,72 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cassert>
+#include <cstdint>
+
+namespace rf
+{
+
+/**
+ * @brief A small, fast random number generator that gives the same sequence on every platform.
+ * @details The standard distributions are free to differ between library implementations, so map
+ * generators that must reproduce a level from its seed use this instead. hash() gives a random
+ * value for a position without any state, so work split across threads produces the same result
+ * however it is divided.
+ */
+class Random
+{
+public:
+	explicit Random(uint64_t seed): m_state(seed) {}
+
+	///Return the next 64 random bits.
+	uint64_t next();
+	///Return a random integer in [@a min, @a max].
+	int nextInt(int min, int max);
+	///Return a random float in [0, 1).
+	float nextFloat() {return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f);}
+	///Return true with probability @a probability.
+	bool nextBool(float probability) {return nextFloat() < probability;}
+
+	///Return random bits determined only by @a seed and @a value.
+	static uint64_t hash(uint64_t seed, uint64_t value);
+	///Return random bits determined only by @a seed and the position (@a x, @a y).
+	static uint64_t hash(uint64_t seed, int x, int y)
+		{return hash(seed, (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x));}
+
+protected:
+	///The finalizer of SplitMix64.
+	static uint64_t mix(uint64_t value);
+
+	uint64_t m_state;
+};
+
+inline uint64_t Random::mix(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+inline uint64_t Random::next()
+{
+	m_state += 0x9E3779B97F4A7C15ULL;
+	return mix(m_state);
+}
+
+inline int Random::nextInt(int min, int max)
+{
+	assert(min <= max);
+
+	uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+	return static_cast<int>(min + static_cast<int64_t>(((next() >> 32) * range) >> 32));
+}
+
+inline uint64_t Random::hash(uint64_t seed, uint64_t value)
+{
+	return mix(mix(seed + 0x9E3779B97F4A7C15ULL) ^ value);
+}
+
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "TextureArray2d.h"
 #include "VertexArrayObject.h"
 #include "ShaderProgram.h"
+#include "Framebuffer.h"
 
 #include "Framework/Exceptions/GlException.h"
 
@@ -52,6 +53,42 @@ void Context::bindShaderProgram(const ShaderProgram& object)
 	CHECK_GL_ERROR(glUseProgram);
 }
 
+void Context::bindFramebuffer(const Framebuffer& framebuffer)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.handle());
+	CHECK_GL_ERROR(glBindFramebuffer);
+	m_boundFramebuffer = &framebuffer;
+}
+
+void Context::bindDefaultFramebuffer()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	CHECK_GL_ERROR(glBindFramebuffer);
+	m_boundFramebuffer = nullptr;
+}
+
+void Context::forgetFramebuffer(const Framebuffer& framebuffer)
+{
+	//Deleting a bound framebuffer binds the window in its place.
+	if(m_boundFramebuffer == &framebuffer)
+	{
+		m_boundFramebuffer = nullptr;
+	}
+}
+
+void Context::setViewport(const Rectanglei& viewport)
+{
+	glViewport(viewport.left(), viewport.bottom(), viewport.width(), viewport.height());
+	CHECK_GL_ERROR(glViewport);
+}
+
+Rectanglei Context::viewport() const
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	return Rectanglei(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
 void Context::setClearColor(const Colorf& color)
 {
 	glClearColor(color.red, color.green, color.blue, color.alpha);
@@ -5,6 +5,7 @@
 
 #include "Texture2d.h"
 #include "Framework/Flags.h"
+#include "Framework/Rectangle.h"
 
 #include "Framework/Exceptions/GlException.h"
 
@@ -22,6 +23,7 @@ class IndexBufferObject;
 class TextureArray2d;
 class VertexArrayObject;
 class ShaderProgram;
+class Framebuffer;
 
 class Context
 {
@@ -50,6 +52,20 @@ public:
 
 	void bindShaderProgram(const ShaderProgram& object);
 
+	///Render into @a framebuffer and read from it.
+	void bindFramebuffer(const Framebuffer& framebuffer);
+	///Render into the window and read from it.
+	void bindDefaultFramebuffer();
+	///Return the framebuffer bound with bindFramebuffer(), or nullptr for the window.
+	const Framebuffer* boundFramebuffer() const {return m_boundFramebuffer;}
+	///Called by a Framebuffer being deleted, which unbinds it.
+	void forgetFramebuffer(const Framebuffer& framebuffer);
+
+	///Set the area of the framebuffer that clip space maps to, in pixels from the bottom left.
+	void setViewport(const Rectanglei& viewport);
+	///Return the current viewport, queried from GL so changes made with glViewport() directly are seen.
+	Rectanglei viewport() const;
+
 	void clear(const Flags<ClearFlags>& flags);
 	void setClearColor(const Colorf& color);
 
@@ -63,7 +79,7 @@ public:
 protected:
 
 	const Texture2d* m_boundTexture2d = nullptr;
-
+	const Framebuffer* m_boundFramebuffer = nullptr;
 };
 
 inline void Context::bindTexture(const Texture2d& texture)
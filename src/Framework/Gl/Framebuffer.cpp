@@ -0,0 +1,104 @@
+#include "Framework/Gl/Framebuffer.h"
+
+#include "Framework/Colorf.h"
+#include "Framework/Exceptions/GlException.h"
+#include "Context.h"
+
+namespace rf
+{
+namespace gl
+{
+
+Framebuffer::Framebuffer(Context* context)
+{
+	m_context = context;
+
+	glGenFramebuffers(1, &m_handle);
+	CHECK_GL_ERROR(glGenFramebuffers);
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept: GlObject(std::move(other)),
+	m_colorTexture(other.m_colorTexture)
+{
+	other.m_colorTexture = nullptr;
+}
+
+Framebuffer& Framebuffer::operator =(Framebuffer&& other) noexcept
+{
+	if(&other != this)
+	{
+		GlObject::operator =(std::move(other));
+		m_colorTexture = other.m_colorTexture;
+		other.m_colorTexture = nullptr;
+	}
+	return *this;
+}
+
+Framebuffer::~Framebuffer()
+{
+	destroy();
+}
+
+void Framebuffer::attachColorTexture(const Texture2d& texture, int level)
+{
+	bind();
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.handle(), level);
+	CHECK_GL_ERROR(glFramebufferTexture2D);
+	m_colorTexture = &texture;
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if(status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		throw GlException("Framebuffer is incomplete", status);
+	}
+}
+
+void Framebuffer::blitTo(const Framebuffer* target, const Rectanglei& sourceArea,
+		const Rectanglei& destinationArea, bool mirrorVertically, BlitFilter filter) const
+{
+	if(target != nullptr)
+	{
+		target->bind();
+	}
+	else
+	{
+		m_context->bindDefaultFramebuffer();
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_handle);
+	CHECK_GL_ERROR(glBindFramebuffer);
+
+	int destinationBottom = mirrorVertically ? destinationArea.top() : destinationArea.bottom();
+	int destinationTop = mirrorVertically ? destinationArea.bottom() : destinationArea.top();
+	glBlitFramebuffer(sourceArea.left(), sourceArea.bottom(), sourceArea.right(), sourceArea.top(),
+			destinationArea.left(), destinationBottom, destinationArea.right(), destinationTop,
+			GL_COLOR_BUFFER_BIT, static_cast<GLenum>(filter));
+	CHECK_GL_ERROR(glBlitFramebuffer);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, target != nullptr ? target->handle() : 0);
+	CHECK_GL_ERROR(glBindFramebuffer);
+}
+
+void Framebuffer::clear(const Colorf& color)
+{
+	bind();
+	const GLfloat value[4] = {color.red, color.green, color.blue, color.alpha};
+	glClearBufferfv(GL_COLOR, 0, value);
+	CHECK_GL_ERROR(glClearBufferfv);
+}
+
+void Framebuffer::bind() const
+{
+	m_context->bindFramebuffer(*this);
+}
+
+void Framebuffer::destroy()
+{
+	if(m_handle != 0)
+	{
+		m_context->forgetFramebuffer(*this);
+		glDeleteFramebuffers(1, &m_handle);
+	}
+}
+
+}
+}
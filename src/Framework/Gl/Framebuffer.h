@@ -0,0 +1,66 @@
+#ifndef FRAMEBUFFER_H_
+#define FRAMEBUFFER_H_
+
+#include "Framework/Gl/GlObject.h"
+
+#include "Framework/Rectangle.h"
+
+namespace rf
+{
+class Colorf;
+
+namespace gl
+{
+class Texture2d;
+
+/**
+ * @brief A framebuffer object, for rendering into a texture instead of the window.
+ * @details Rendering goes to the framebuffer while it is bound with Context::bindFramebuffer();
+ * Context::bindDefaultFramebuffer() returns to the window. The viewport is not changed by
+ * binding, so it has to be set to the size of the attached texture with Context::setViewport().
+ */
+class Framebuffer: public GlObject
+{
+public:
+	enum class BlitFilter {Nearest = GL_NEAREST, Linear = GL_LINEAR};
+
+	explicit Framebuffer(Context* context);
+	virtual ~Framebuffer();
+
+	Framebuffer(Framebuffer&& other) noexcept;
+	Framebuffer& operator =(Framebuffer&& other) noexcept;
+
+	/**
+	 * @brief Render into level @a level of @a texture. Binds the framebuffer.
+	 * @throw GlException The framebuffer is not complete with @a texture attached, such as when
+	 * the texture's format can't be rendered to.
+	 */
+	void attachColorTexture(const Texture2d& texture, int level = 0);
+
+	///Return the color texture attached with attachColorTexture(), or nullptr.
+	const Texture2d* colorTexture() const {return m_colorTexture;}
+
+	/**
+	 * @brief Copy @a sourceArea of the color buffer to @a destinationArea of @a target.
+	 * @details Copies to the window if @a target is nullptr. The image is scaled with @a filter if
+	 * the areas differ in size, and turned upside down if @a mirrorVertically is true. Changes the
+	 * bound framebuffer to @a target.
+	 */
+	void blitTo(const Framebuffer* target, const Rectanglei& sourceArea, const Rectanglei& destinationArea,
+			bool mirrorVertically = false, BlitFilter filter = BlitFilter::Nearest) const;
+
+	///Bind the framebuffer and fill its color buffer with @a color, leaving the clear color unchanged.
+	void clear(const Colorf& color);
+
+	void bind() const;
+
+protected:
+	virtual void destroy() override;
+
+	const Texture2d* m_colorTexture = nullptr;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,356 @@
+#include "Framework/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rf
+{
+
+namespace
+{
+thread_local const JobSystem* t_currentJobSystem = nullptr;
+thread_local int t_currentWorkerIndex = -1;
+
+///Return the scratch arena of a thread that isn't a worker. Every JobSystem it uses shares it,
+///which is safe because the marks of nested tasks are released in reverse order.
+ScratchArena& externalArena()
+{
+	thread_local ScratchArena arena;
+	return arena;
+}
+}
+
+JobSystem::Task::Task(std::function<void ()> function):
+	m_function(std::move(function))
+{
+}
+
+JobSystem::JobSystem(int workerCount)
+{
+	assert(workerCount >= 0);
+
+	for(int i = 0; i <= workerCount; ++i)
+	{
+		m_queues.emplace_back(new WorkerQueue());
+	}
+	for(int i = 0; i < workerCount; ++i)
+	{
+		m_arenas.emplace_back(new ScratchArena());
+	}
+
+	m_workers.reserve(workerCount);
+	for(int i = 0; i < workerCount; ++i)
+	{
+		m_workers.emplace_back(&JobSystem::workerMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stopping = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for(std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+JobSystem::TaskHandle JobSystem::createTask(std::function<void ()> function)
+{
+	return std::make_shared<Task>(std::move(function));
+}
+
+void JobSystem::addDependency(const TaskHandle& task, const TaskHandle& dependency)
+{
+	std::lock_guard<std::mutex> lock(dependency->m_dependentsMutex);
+	if(!dependency->isFinished())
+	{
+		task->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+		dependency->m_dependents.push_back(task);
+	}
+}
+
+void JobSystem::submit(const TaskHandle& task)
+{
+	if(task->m_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		enqueue(task);
+	}
+}
+
+JobSystem::TaskHandle JobSystem::run(std::function<void ()> function)
+{
+	TaskHandle task = createTask(std::move(function));
+	submit(task);
+	return task;
+}
+
+void JobSystem::wait(const TaskHandle& task)
+{
+	int workerIndex = currentWorkerIndex();
+	while(!task->isFinished())
+	{
+		if(!runOneTask(workerIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if(task->m_exception)
+	{
+		std::rethrow_exception(task->m_exception);
+	}
+}
+
+void JobSystem::wait(const std::vector<TaskHandle>& tasks)
+{
+	for(const TaskHandle& task : tasks)
+	{
+		wait(task);
+	}
+}
+
+void JobSystem::parallelFor(int begin, int end, int grainSize,
+		const std::function<void (int, int)>& function)
+{
+	assert(grainSize > 0);
+
+	if(end <= begin)
+	{
+		return;
+	}
+
+	int pieceCount = (end - begin + grainSize - 1) / grainSize;
+	std::atomic<int> nextBegin(begin);
+
+	//Rather than a task per piece, every participant pulls pieces from a shared
+	//counter until the range is used up.
+	auto body = [&]()
+	{
+		for(;;)
+		{
+			int pieceBegin = nextBegin.fetch_add(grainSize, std::memory_order_relaxed);
+			if(pieceBegin >= end)
+			{
+				break;
+			}
+			function(pieceBegin, std::min(pieceBegin + grainSize, end));
+		}
+	};
+
+	int helperCount = std::min(workerCount(), pieceCount - 1);
+	std::vector<TaskHandle> helpers;
+	helpers.reserve(helperCount);
+	for(int i = 0; i < helperCount; ++i)
+	{
+		helpers.push_back(run(body));
+	}
+
+	std::exception_ptr error;
+	try
+	{
+		body();
+	}
+	catch(...)
+	{
+		error = std::current_exception();
+		//Let the helpers run out of work before unwinding the state they reference.
+		nextBegin = end;
+	}
+
+	for(const TaskHandle& helper : helpers)
+	{
+		try
+		{
+			wait(helper);
+		}
+		catch(...)
+		{
+			if(!error)
+			{
+				error = std::current_exception();
+			}
+		}
+	}
+
+	if(error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+void JobSystem::parallelFor(const Rectanglei& region, const Vector2i& blockSize,
+		const std::function<void (const Rectanglei&)>& function)
+{
+	assert(blockSize.x > 0 && blockSize.y > 0);
+
+	int blocksX = (region.width() + blockSize.x - 1) / blockSize.x;
+	int blocksY = (region.height() + blockSize.y - 1) / blockSize.y;
+
+	parallelFor(0, blocksX * blocksY, 1,
+		[&](int first, int last)
+		{
+			for(int i = first; i < last; ++i)
+			{
+				int left = region.left() + (i % blocksX) * blockSize.x;
+				int bottom = region.bottom() + (i / blocksX) * blockSize.y;
+				function(Rectanglei(left, bottom, std::min(blockSize.x, region.right() - left),
+						std::min(blockSize.y, region.top() - bottom)));
+			}
+		});
+}
+
+ScratchArena& JobSystem::scratchArena()
+{
+	return arenaFor(currentWorkerIndex());
+}
+
+int JobSystem::currentWorkerIndex() const
+{
+	return t_currentJobSystem == this ? t_currentWorkerIndex : -1;
+}
+
+int JobSystem::defaultWorkerCount()
+{
+	int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+	return std::max(1, hardwareThreads - 1);
+}
+
+void JobSystem::workerMain(int index)
+{
+	t_currentJobSystem = this;
+	t_currentWorkerIndex = index;
+
+	while(!m_stopping)
+	{
+		if(!runOneTask(index))
+		{
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			m_wakeCondition.wait(lock,
+				[this]()
+				{
+					return m_queuedCount.load() > 0 || m_stopping;
+				});
+		}
+	}
+}
+
+void JobSystem::enqueue(TaskHandle task)
+{
+	int workerIndex = currentWorkerIndex();
+	WorkerQueue& queue = workerIndex >= 0 ? *m_queues[workerIndex] : *m_queues.back();
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	m_queuedCount.fetch_add(1);
+
+	//Taking the lock orders this notification after any worker's check of the queued count.
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeCondition.notify_one();
+}
+
+JobSystem::TaskHandle JobSystem::takeTask(int workerIndex)
+{
+	TaskHandle task;
+	int queueCount = static_cast<int>(m_queues.size());
+
+	//Newest first from our own queue keeps the working set hot in this core's cache.
+	if(workerIndex >= 0)
+	{
+		WorkerQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			return task;
+		}
+	}
+
+	//Otherwise take the oldest task from the shared queue, then from the other workers.
+	int start = queueCount - 1;
+	for(int i = 0; i < queueCount; ++i)
+	{
+		int victim = (start + i) % queueCount;
+		if(victim == workerIndex)
+		{
+			continue;
+		}
+		WorkerQueue& queue = *m_queues[victim];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return task;
+		}
+	}
+	return task;
+}
+
+bool JobSystem::runOneTask(int workerIndex)
+{
+	if(m_queuedCount.load(std::memory_order_relaxed) == 0)
+	{
+		return false;
+	}
+
+	TaskHandle task = takeTask(workerIndex);
+	if(!task)
+	{
+		return false;
+	}
+	m_queuedCount.fetch_sub(1);
+
+	execute(task, workerIndex);
+	return true;
+}
+
+ScratchArena& JobSystem::arenaFor(int workerIndex)
+{
+	return workerIndex >= 0 ? *m_arenas[workerIndex] : externalArena();
+}
+
+void JobSystem::execute(const TaskHandle& task, int workerIndex)
+{
+	ScratchArena& arena = arenaFor(workerIndex);
+	ScratchArena::Marker marker = arena.mark();
+	try
+	{
+		task->m_function();
+	}
+	catch(...)
+	{
+		task->m_exception = std::current_exception();
+	}
+	arena.release(marker);
+
+	finish(task);
+}
+
+void JobSystem::finish(const TaskHandle& task)
+{
+	//Release the task's function, and anything it captured, as soon as it has run.
+	task->m_function = nullptr;
+
+	std::vector<TaskHandle> dependents;
+	{
+		std::lock_guard<std::mutex> lock(task->m_dependentsMutex);
+		task->m_finished.store(true, std::memory_order_release);
+		dependents.swap(task->m_dependents);
+	}
+
+	for(const TaskHandle& dependent : dependents)
+	{
+		submit(dependent);
+	}
+}
+
+}
@@ -0,0 +1,163 @@
+#ifndef JOBSYSTEM_H_
+#define JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Framework/Jobs/ScratchArena.h"
+#include "Framework/Rectangle.h"
+
+namespace rf
+{
+
+/**
+ * @brief A work-stealing thread pool that runs graphs of dependent tasks.
+ * @details Each worker thread owns a queue. Tasks spawned by a worker go on its own queue and
+ * are run newest first, while idle workers steal the oldest tasks from other queues. Tasks
+ * submitted from other threads go on a shared queue that every worker takes from.
+ *
+ * A thread waiting on a task with wait() runs queued tasks while it waits rather than blocking,
+ * so waiting from inside a task is allowed, and a JobSystem with zero workers still runs
+ * everything, on the waiting thread.
+ */
+class JobSystem
+{
+public:
+	/**
+	 * @brief A unit of work in a task graph.
+	 * @details Tasks are created with createTask(), linked with addDependency(), then handed to
+	 * submit(). A task is queued once it has been submitted and every task it depends on has
+	 * finished.
+	 */
+	class Task
+	{
+		friend class JobSystem;
+	public:
+		explicit Task(std::function<void ()> function);
+		~Task() = default;
+
+		Task(const Task&) = delete;
+		Task& operator =(const Task&) = delete;
+
+		///Return true once the task has run and its dependents have been released.
+		bool isFinished() const {return m_finished.load(std::memory_order_acquire);}
+
+	protected:
+		std::function<void ()> m_function;
+		///Unfinished dependencies, plus one until the task is submitted.
+		std::atomic<int> m_pendingCount{1};
+		std::atomic<bool> m_finished{false};
+		std::exception_ptr m_exception;
+
+		std::mutex m_dependentsMutex;
+		std::vector<std::shared_ptr<Task>> m_dependents;
+	};
+
+	typedef std::shared_ptr<Task> TaskHandle;
+
+	///Construct a JobSystem with @a workerCount worker threads.
+	explicit JobSystem(int workerCount = defaultWorkerCount());
+	///Stops and joins the worker threads. Tasks that are still queued are discarded.
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem(JobSystem&&) = delete;
+	JobSystem& operator =(const JobSystem&) = delete;
+	JobSystem& operator =(JobSystem&&) = delete;
+
+	int workerCount() const {return static_cast<int>(m_workers.size());}
+
+	///Create a task that runs @a function. It does not run until it is passed to submit().
+	TaskHandle createTask(std::function<void ()> function);
+
+	/**
+	 * @brief Make @a task wait for @a dependency to finish before it runs.
+	 * @details This must be called before @a task is submitted. @a dependency may already
+	 * be running or finished.
+	 */
+	void addDependency(const TaskHandle& task, const TaskHandle& dependency);
+
+	///Queue @a task to run once all of its dependencies have finished.
+	void submit(const TaskHandle& task);
+
+	///Create and submit a task with no dependencies.
+	TaskHandle run(std::function<void ()> function);
+
+	/**
+	 * @brief Wait for @a task to finish, running other queued tasks in the meantime.
+	 * @details If the task threw an exception, it is rethrown here.
+	 */
+	void wait(const TaskHandle& task);
+
+	///Wait for all of @a tasks to finish.
+	void wait(const std::vector<TaskHandle>& tasks);
+
+	/**
+	 * @brief Call @a function on sub-ranges of [@a begin, @a end) in parallel.
+	 * @details The range is split into pieces of at most @a grainSize elements. The calling
+	 * thread takes part in the work and the call returns once every piece is done.
+	 * @param function Called as function(rangeBegin, rangeEnd).
+	 */
+	void parallelFor(int begin, int end, int grainSize, const std::function<void (int, int)>& function);
+
+	/**
+	 * @brief Call @a function on the blocks of a 2D region, such as an area of a TileGrid, in parallel.
+	 * @details @a region is split into blocks of at most @a blockSize cells, clipped to the region.
+	 * @param function Called with the rectangle of each block.
+	 */
+	void parallelFor(const Rectanglei& region, const Vector2i& blockSize,
+			const std::function<void (const Rectanglei&)>& function);
+
+	/**
+	 * @brief Return the scratch arena of the calling thread.
+	 * @details Each worker has its own arena, and memory allocated from it stays valid until
+	 * the task that allocated it returns. Every other thread gets an arena of its own, so
+	 * several threads may run tasks inside wait() or parallelFor() at the same time.
+	 */
+	ScratchArena& scratchArena();
+
+	///Return the index of the calling worker thread, or -1 if the caller is not one of its workers.
+	int currentWorkerIndex() const;
+
+	///Return the number of workers to use by default: one less than the number of hardware threads.
+	static int defaultWorkerCount();
+
+protected:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<TaskHandle> tasks;
+	};
+
+	void workerMain(int index);
+
+	void enqueue(TaskHandle task);
+	TaskHandle takeTask(int workerIndex);
+	bool runOneTask(int workerIndex);
+	///Return the arena of worker @a workerIndex, or of the calling thread if it is -1.
+	ScratchArena& arenaFor(int workerIndex);
+	void execute(const TaskHandle& task, int workerIndex);
+	void finish(const TaskHandle& task);
+
+	std::vector<std::thread> m_workers;
+	///One queue per worker, followed by the shared queue for tasks submitted from other threads.
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	///One arena per worker. Other threads use a thread_local arena of their own.
+	std::vector<std::unique_ptr<ScratchArena>> m_arenas;
+
+	std::atomic<int> m_queuedCount{0};
+	std::atomic<bool> m_stopping{false};
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wakeCondition;
+};
+
+}
+
+#endif
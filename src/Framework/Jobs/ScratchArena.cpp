@@ -0,0 +1,99 @@
+#include "Framework/Jobs/ScratchArena.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+
+namespace rf
+{
+
+ScratchArena::ScratchArena(size_t blockSize):
+	m_blockSize(blockSize)
+{
+}
+
+ScratchArena::ScratchArena(ScratchArena&& other) noexcept:
+	m_blocks(std::move(other.m_blocks)), m_blockSize(other.m_blockSize),
+	m_currentBlock(other.m_currentBlock), m_offset(other.m_offset)
+{
+	other.m_currentBlock = 0;
+	other.m_offset = 0;
+}
+
+ScratchArena& ScratchArena::operator =(ScratchArena&& other) noexcept
+{
+	if(&other != this)
+	{
+		m_blocks = std::move(other.m_blocks);
+		m_blockSize = other.m_blockSize;
+		m_currentBlock = other.m_currentBlock;
+		m_offset = other.m_offset;
+		other.m_currentBlock = 0;
+		other.m_offset = 0;
+	}
+	return *this;
+}
+
+void* ScratchArena::allocate(size_t size, size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	while(m_currentBlock < m_blocks.size())
+	{
+		Block& block = m_blocks[m_currentBlock];
+		uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+		uintptr_t aligned = (base + m_offset + alignment - 1) & ~(alignment - 1);
+		size_t end = aligned - base + size;
+		if(end <= block.size)
+		{
+			m_offset = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+		//Move on to the next block, leaving the tail of this one unused until a reset.
+		++m_currentBlock;
+		m_offset = 0;
+	}
+
+	size_t blockSize = std::max(m_blockSize, size + alignment);
+	m_blocks.push_back(Block{std::unique_ptr<char []>(new char[blockSize]), blockSize});
+	m_currentBlock = m_blocks.size() - 1;
+	m_offset = 0;
+	return allocate(size, alignment);
+}
+
+void ScratchArena::release(const Marker& marker)
+{
+	assert(marker.block < m_currentBlock ||
+			(marker.block == m_currentBlock && marker.offset <= m_offset));
+
+	m_currentBlock = marker.block;
+	m_offset = marker.offset;
+}
+
+void ScratchArena::reset()
+{
+	m_currentBlock = 0;
+	m_offset = 0;
+}
+
+size_t ScratchArena::bytesUsed() const
+{
+	size_t used = 0;
+	for(size_t i = 0; i < m_currentBlock && i < m_blocks.size(); ++i)
+	{
+		used += m_blocks[i].size;
+	}
+	return used + m_offset;
+}
+
+size_t ScratchArena::capacity() const
+{
+	size_t total = 0;
+	for(const Block& block : m_blocks)
+	{
+		total += block.size;
+	}
+	return total;
+}
+
+}
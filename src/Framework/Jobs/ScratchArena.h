@@ -0,0 +1,80 @@
+#ifndef SCRATCHARENA_H_
+#define SCRATCHARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <new>
+#include <type_traits>
+
+namespace rf
+{
+
+/**
+ * @brief A bump allocator for short-lived scratch memory.
+ * @details Allocation is a pointer increment within large blocks. Memory is never freed
+ * individually; instead a Marker is taken and everything allocated after it is released at once
+ * with release(), or the whole arena is emptied with reset(). Blocks are kept for reuse, so an
+ * arena that is reset every job or frame stops allocating once it reaches its working size.
+ *
+ * Destructors are never run for objects placed in the arena, so only trivially destructible
+ * types should be stored in it.
+ */
+class ScratchArena
+{
+public:
+	///A saved allocation position to return to with release().
+	struct Marker
+	{
+		size_t block;
+		size_t offset;
+	};
+
+	explicit ScratchArena(size_t blockSize = 64 * 1024);
+	~ScratchArena() = default;
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator =(const ScratchArena&) = delete;
+
+	ScratchArena(ScratchArena&& other) noexcept;
+	ScratchArena& operator =(ScratchArena&& other) noexcept;
+
+	///Return @a size bytes of uninitialized memory aligned to @a alignment, which must be a power of two.
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	///Return uninitialized storage for @a count objects of type @a T.
+	template<typename T>
+	T* allocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "ScratchArena never runs destructors");
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	///Return the current allocation position.
+	Marker mark() const {return Marker{m_currentBlock, m_offset};}
+	///Release everything allocated since @a marker was taken.
+	void release(const Marker& marker);
+	///Release everything allocated from the arena, keeping its blocks for reuse.
+	void reset();
+
+	///Return the number of bytes currently allocated from the arena.
+	size_t bytesUsed() const;
+	///Return the number of bytes reserved by the arena's blocks.
+	size_t capacity() const;
+
+protected:
+	struct Block
+	{
+		std::unique_ptr<char []> data;
+		size_t size;
+	};
+
+	std::vector<Block> m_blocks;
+	size_t m_blockSize;
+	size_t m_currentBlock = 0;
+	size_t m_offset = 0;
+};
+
+}
+
+#endif
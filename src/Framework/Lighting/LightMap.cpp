@@ -0,0 +1,309 @@
+#include "Framework/Lighting/LightMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "Framework/Jobs/JobSystem.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rf
+{
+
+namespace
+{
+
+///Return @a color with each channel, alpha included, multiplied by the four floats at @a light.
+inline Color scaleColor(const Color& color, const float* light)
+{
+	Color result;
+#if defined(__SSE2__)
+	int32_t word;
+	std::memcpy(&word, &color, sizeof(word));
+	const __m128i zero = _mm_setzero_si128();
+	__m128i channels = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+	__m128i scaled = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_loadu_ps(light)));
+	//Saturate back down to bytes.
+	scaled = _mm_packs_epi32(scaled, scaled);
+	scaled = _mm_packus_epi16(scaled, scaled);
+	word = _mm_cvtsi128_si32(scaled);
+	std::memcpy(static_cast<void*>(&result), &word, sizeof(word));
+#else
+	//Clamp to [0, 255] as the saturating packs above do, negative light included.
+	auto scale = [](uint8_t channel, float factor)
+	{
+		return static_cast<uint8_t>(std::max(0L, std::min(std::lround(channel * factor), 255L)));
+	};
+	result = Color(scale(color.red, light[0]), scale(color.green, light[1]), scale(color.blue, light[2]),
+			scale(color.alpha, light[3]));
+#endif
+	return result;
+}
+
+}
+
+LightMap::LightMap(int width, int height, FieldOfView::Algorithm algorithm):
+	m_width(width), m_height(height), m_fieldsOfView(algorithm),
+	m_staticLight(width * height * 4, 0.0f), m_light(width * height * 4, 0.0f)
+{
+}
+
+LightMap::LightId LightMap::addLight(const Vector2i& position, int radius, const Colorf& color, bool isStatic)
+{
+	assert(radius >= 0);
+
+	Light light{position, radius, color, isStatic, true, true, m_fieldsOfView.addViewer(position, radius),
+			std::vector<float>()};
+	if(light.viewer >= static_cast<FieldOfViewCache::ViewerId>(m_viewerLights.size()))
+	{
+		m_viewerLights.resize(light.viewer + 1);
+	}
+
+	LightId id;
+	if(!m_freeIds.empty())
+	{
+		id = m_freeIds.back();
+		m_freeIds.pop_back();
+	}
+	else
+	{
+		id = static_cast<LightId>(m_lights.size());
+		m_lights.emplace_back();
+	}
+	m_viewerLights[light.viewer] = id;
+	m_lights[id] = std::move(light);
+	return id;
+}
+
+void LightMap::removeLight(LightId light)
+{
+	Light& entry = m_lights[light];
+	assert(entry.active);
+
+	m_fieldsOfView.removeViewer(entry.viewer);
+	entry.active = false;
+	entry.contribution.clear();
+	(entry.isStatic ? m_staticLightChanged : m_lightChanged) = true;
+	m_freeIds.push_back(light);
+}
+
+void LightMap::setLightPosition(LightId light, const Vector2i& position)
+{
+	Light& entry = m_lights[light];
+	assert(entry.active);
+
+	entry.position = position;
+	m_fieldsOfView.setViewer(entry.viewer, entry.position, entry.radius);
+}
+
+void LightMap::setLightRadius(LightId light, int radius)
+{
+	Light& entry = m_lights[light];
+	assert(entry.active && radius >= 0);
+
+	entry.radius = radius;
+	m_fieldsOfView.setViewer(entry.viewer, entry.position, entry.radius);
+}
+
+void LightMap::setLightColor(LightId light, const Colorf& color)
+{
+	Light& entry = m_lights[light];
+	assert(entry.active);
+
+	entry.color = color;
+	entry.stale = true;
+}
+
+void LightMap::setAmbientLight(const Colorf& color)
+{
+	m_ambient = color;
+	m_lightChanged = true;
+}
+
+int LightMap::update(const OpacityMap& map, JobSystem* jobSystem)
+{
+	assert(map.width() == m_width && map.height() == m_height);
+
+	m_fieldsOfView.update(map, jobSystem);
+	for(FieldOfViewCache::ViewerId viewer : m_fieldsOfView.updatedViewers())
+	{
+		m_lights[m_viewerLights[viewer]].stale = true;
+	}
+
+	m_staleLights.clear();
+	for(LightId id = 0; id < static_cast<LightId>(m_lights.size()); ++id)
+	{
+		if(m_lights[id].active && m_lights[id].stale)
+		{
+			m_staleLights.push_back(id);
+		}
+	}
+
+	//Each light only writes its own contribution, so they can be computed independently.
+	auto computeLights = [this](int first, int last)
+	{
+		for(int i = first; i < last; ++i)
+		{
+			computeContribution(m_lights[m_staleLights[i]]);
+		}
+	};
+
+	int staleCount = static_cast<int>(m_staleLights.size());
+	if(jobSystem != nullptr && staleCount > 1)
+	{
+		jobSystem->parallelFor(0, staleCount, 1, computeLights);
+	}
+	else
+	{
+		computeLights(0, staleCount);
+	}
+
+	for(LightId id : m_staleLights)
+	{
+		Light& light = m_lights[id];
+		light.stale = false;
+		(light.isStatic ? m_staticLightChanged : m_lightChanged) = true;
+	}
+
+	if(m_staticLightChanged)
+	{
+		std::fill(m_staticLight.begin(), m_staticLight.end(), 0.0f);
+		for(const Light& light : m_lights)
+		{
+			if(light.active && light.isStatic)
+			{
+				addContribution(light, m_staticLight);
+			}
+		}
+		m_staticLightChanged = false;
+		m_lightChanged = true;
+	}
+
+	if(m_lightChanged)
+	{
+		const float ambient[4] = {m_ambient.red, m_ambient.green, m_ambient.blue, 1.0f};
+		for(size_t i = 0; i < m_light.size(); i += 4)
+		{
+			for(int channel = 0; channel < 4; ++channel)
+			{
+				m_light[i + channel] = ambient[channel] + m_staticLight[i + channel];
+			}
+		}
+		for(const Light& light : m_lights)
+		{
+			if(light.active && !light.isStatic)
+			{
+				addContribution(light, m_light);
+			}
+		}
+		m_lightChanged = false;
+	}
+
+	return staleCount;
+}
+
+Colorf LightMap::getLight(int x, int y) const
+{
+	assert(x >= 0 && y >= 0 && x < m_width && y < m_height);
+
+	const float* light = &m_light[(x + y * m_width) * 4];
+	return Colorf(light[0], light[1], light[2], light[3]);
+}
+
+void LightMap::apply(const TileGridView& source, TileGridView& destination, const Vector2i& origin,
+		const Flags<TileChannel>& channels) const
+{
+	bool lightForeground = channels.hasFlag(TileChannel::ForegroundColor);
+	bool lightBackground = channels.hasFlag(TileChannel::BackgroundColor);
+	const float ambient[4] = {m_ambient.red, m_ambient.green, m_ambient.blue, 1.0f};
+
+	int width = std::min(source.width(), destination.width());
+	int height = std::min(source.height(), destination.height());
+	for(int y = 0; y < height; ++y)
+	{
+		const Tile* sourceRow = source.rowBegin(y);
+		Tile* destinationRow = destination.rowBegin(y);
+		int mapY = origin.y + y;
+		bool rowInMap = mapY >= 0 && mapY < m_height;
+
+		for(int x = 0; x < width; ++x)
+		{
+			int mapX = origin.x + x;
+			const float* light = rowInMap && mapX >= 0 && mapX < m_width ? &m_light[(mapX + mapY * m_width) * 4] : ambient;
+
+			Tile tile = sourceRow[x];
+			if(lightForeground)
+			{
+				tile.setForegroundColor(scaleColor(tile.foregroundColor(), light));
+			}
+			if(lightBackground)
+			{
+				tile.setBackgroundColor(scaleColor(tile.backgroundColor(), light));
+			}
+			destinationRow[x] = tile;
+		}
+	}
+}
+
+void LightMap::computeContribution(Light& light) const
+{
+	const FieldOfView& fieldOfView = m_fieldsOfView.getFieldOfView(light.viewer);
+	int side = 2 * light.radius + 1;
+	light.contribution.assign(side * side * 4, 0.0f);
+
+	float falloff = 1.0f / (light.radius + 1);
+	for(int y = 0; y < side; ++y)
+	{
+		int dy = y - light.radius;
+		for(int x = 0; x < side; ++x)
+		{
+			int dx = x - light.radius;
+			if(!fieldOfView.isVisible(light.position.x + dx, light.position.y + dy))
+			{
+				continue;
+			}
+
+			float brightness = 1.0f - std::sqrt(static_cast<float>(dx * dx + dy * dy)) * falloff;
+			if(brightness > 0.0f)
+			{
+				float* cell = &light.contribution[(x + y * side) * 4];
+				cell[0] = light.color.red * brightness;
+				cell[1] = light.color.green * brightness;
+				cell[2] = light.color.blue * brightness;
+			}
+		}
+	}
+}
+
+void LightMap::addContribution(const Light& light, std::vector<float>& buffer) const
+{
+	int side = 2 * light.radius + 1;
+	int left = light.position.x - light.radius;
+	int bottom = light.position.y - light.radius;
+
+	int firstX = std::max(0, -left);
+	int lastX = std::min(side, m_width - left);
+	int firstY = std::max(0, -bottom);
+	int lastY = std::min(side, m_height - bottom);
+	if(firstX >= lastX || firstY >= lastY || light.contribution.empty())
+	{
+		return;
+	}
+
+	int count = (lastX - firstX) * 4;
+	for(int y = firstY; y < lastY; ++y)
+	{
+		const float* from = &light.contribution[(firstX + y * side) * 4];
+		float* to = &buffer[(left + firstX + (bottom + y) * m_width) * 4];
+		for(int i = 0; i < count; ++i)
+		{
+			to[i] += from[i];
+		}
+	}
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef LIGHTMAP_H_
+#define LIGHTMAP_H_
+
+#include <vector>
+
+#include "Framework/Colorf.h"
+#include "Framework/Flags.h"
+#include "Framework/Fov/FieldOfView.h"
+#include "Framework/TileBlit.h"
+#include "Framework/TileGridView.h"
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief Colored lighting for a map, accumulated in floating point and applied to tile colors.
+ * @details Each light covers the cells within its radius that it can see on an OpacityMap, and
+ * its brightness falls off linearly with distance. Light is additive: the light on a cell is the
+ * ambient light plus the sum of every light reaching it, and a light of 1 in a channel leaves
+ * that channel of a tile unchanged when applied.
+ *
+ * The contribution of each light is cached, along with the sum of the contributions of all static
+ * lights. update() only recomputes lights that moved, changed, or had occluders within their radius
+ * change, and only re-sums the static lights when one of them was recomputed, so a level lit by
+ * many torches and a few moving lanterns costs little more per frame than the lanterns alone.
+ *
+ * Light is stored as four floats per cell, with the fourth always 1, so one cell fills one SIMD
+ * register and apply() can scale a whole color, alpha included, with a single multiply.
+ */
+class LightMap
+{
+public:
+	typedef int LightId;
+
+	LightMap(int width, int height,
+			FieldOfView::Algorithm algorithm = FieldOfView::Algorithm::SymmetricShadowcasting);
+	~LightMap() = default;
+
+	LightMap(const LightMap&) = default;
+	LightMap(LightMap&&) = default;
+	LightMap& operator =(const LightMap&) = default;
+	LightMap& operator =(LightMap&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	/**
+	 * @brief Add a light at @a position reaching @a radius cells.
+	 * @details Static lights are expected to rarely change, and are summed into a cached layer.
+	 * The light is computed by the next update().
+	 */
+	LightId addLight(const Vector2i& position, int radius, const Colorf& color, bool isStatic = false);
+	void removeLight(LightId light);
+
+	void setLightPosition(LightId light, const Vector2i& position);
+	void setLightRadius(LightId light, int radius);
+	void setLightColor(LightId light, const Colorf& color);
+
+	///Set the light on every cell, lit or not. The default is black.
+	void setAmbientLight(const Colorf& color);
+	const Colorf& ambientLight() const {return m_ambient;}
+
+	/**
+	 * @brief Recompute the lights that are out of date with @a map and re-sum the light buffer.
+	 * @param jobSystem If not null, lights are recomputed in parallel on it.
+	 * @return The number of lights that were recomputed.
+	 */
+	int update(const OpacityMap& map, JobSystem* jobSystem = nullptr);
+
+	///Return the light on (@a x, @a y) as of the last update().
+	Colorf getLight(int x, int y) const;
+
+	/**
+	 * @brief Write the tiles of @a source to @a destination with their colors multiplied by the light.
+	 * @details Cell (x, y) of @a source is lit by the light at @a origin + (x, y), with cells
+	 * outside the map lit by the ambient light only. Only the color channels in @a channels are
+	 * changed; the tile index is always copied. @a source and @a destination may be the same
+	 * view, and only the area they have in common is written.
+	 */
+	void apply(const TileGridView& source, TileGridView& destination, const Vector2i& origin = Vector2i(0, 0),
+			const Flags<TileChannel>& channels = {TileChannel::ForegroundColor, TileChannel::BackgroundColor}) const;
+
+	///Return the light buffer, four floats per cell, row by row starting at y = 0.
+	const float* data() const {return m_light.data();}
+
+protected:
+	struct Light
+	{
+		Vector2i position;
+		int radius;
+		Colorf color;
+		bool isStatic;
+		bool active;
+		///Set when the contribution needs recomputing, including after the field of view was recomputed.
+		bool stale;
+		FieldOfViewCache::ViewerId viewer;
+		///The light added to each cell of the square the field of view covers, four floats per cell.
+		std::vector<float> contribution;
+	};
+
+	void computeContribution(Light& light) const;
+	///Add @a light's contribution to a buffer the size of the map.
+	void addContribution(const Light& light, std::vector<float>& buffer) const;
+
+	int m_width;
+	int m_height;
+	Colorf m_ambient = Colorf(0.0f, 0.0f, 0.0f, 1.0f);
+
+	std::vector<Light> m_lights;
+	std::vector<LightId> m_freeIds;
+	FieldOfViewCache m_fieldsOfView;
+	///The light of each viewer of m_fieldsOfView, indexed by viewer id.
+	std::vector<LightId> m_viewerLights;
+	std::vector<LightId> m_staleLights;
+
+	///The sum of the contributions of every static light.
+	std::vector<float> m_staticLight;
+	bool m_staticLightChanged = true;
+	bool m_lightChanged = true;
+	///The ambient light plus every light, applied by apply().
+	std::vector<float> m_light;
+};
+
+}
+
+#endif
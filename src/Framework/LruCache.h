@@ -1,6 +1,7 @@
 #ifndef LRUCACHE_H_
 #define LRUCACHE_H_
 
+#include <functional>
 #include <list>
 #include <unordered_map>
 
@@ -40,6 +41,8 @@ public:
 	}
 
 	Type* getItem(const Key& key);
+	///Return the item stored for @a key, or null, without marking it as used.
+	const Type* peekItem(const Key& key) const;
 	void addItem(const Key& key, Type item);
 
 	void resize(size_t newSize);
@@ -52,6 +55,10 @@ public:
 
 	void dropOne();
 
+	///Call @a fn(key, item) for every item, from most to least recently used, without touching their order.
+	template<typename FnType>
+	void forEachItem(const FnType& fn);
+
 protected:
 
 	struct CacheItem
@@ -81,6 +88,13 @@ inline Type* LruCache<Key, Type>::getItem(const Key& key)
 	return nullptr;
 }
 
+template<typename Key, typename Type>
+inline const Type* LruCache<Key, Type>::peekItem(const Key& key) const
+{
+	auto it = m_items.find(key);
+	return it != m_items.end() ? &it->second.value : nullptr;
+}
+
 template<typename Key, typename Type>
 inline void LruCache<Key, Type>::addItem(const Key& key, Type item)
 {
@@ -113,6 +127,16 @@ inline void LruCache<Key, Type>::clear()
 	m_order.clear();
 }
 
+template<typename Key, typename Type>
+template<typename FnType>
+inline void LruCache<Key, Type>::forEachItem(const FnType& fn)
+{
+	for(const Key& key : m_order)
+	{
+		fn(key, m_items[key].value);
+	}
+}
+
 }
 
 template<typename Key, typename Type>
@@ -0,0 +1,191 @@
+#include "Framework/MessageChannel.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Framework/Exceptions/FileIoException.h"
+
+namespace rf
+{
+
+constexpr uint32_t MessageChannel::DefaultMaxMessageSize;
+
+namespace
+{
+
+std::string descriptorName(int descriptor)
+{
+	return "file descriptor " + std::to_string(descriptor);
+}
+
+}
+
+MessageChannel::MessageChannel(int readDescriptor, int writeDescriptor):
+	m_readDescriptor(readDescriptor), m_writeDescriptor(writeDescriptor)
+{
+}
+
+MessageChannel::~MessageChannel()
+{
+	close();
+}
+
+MessageChannel::MessageChannel(MessageChannel&& other) noexcept:
+	m_readDescriptor(other.m_readDescriptor), m_writeDescriptor(other.m_writeDescriptor),
+	m_maxMessageSize(other.m_maxMessageSize)
+{
+	other.m_readDescriptor = -1;
+	other.m_writeDescriptor = -1;
+}
+
+MessageChannel& MessageChannel::operator =(MessageChannel&& other) noexcept
+{
+	if(&other != this)
+	{
+		close();
+		m_readDescriptor = other.m_readDescriptor;
+		m_writeDescriptor = other.m_writeDescriptor;
+		m_maxMessageSize = other.m_maxMessageSize;
+		other.m_readDescriptor = -1;
+		other.m_writeDescriptor = -1;
+	}
+	return *this;
+}
+
+std::pair<MessageChannel, MessageChannel> MessageChannel::createLoopback()
+{
+	int descriptors[2];
+	if(::socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) != 0)
+	{
+		throw FileIoException("socket pair", std::strerror(errno));
+	}
+	return std::make_pair(MessageChannel(descriptors[0], descriptors[0]),
+			MessageChannel(descriptors[1], descriptors[1]));
+}
+
+void MessageChannel::send(const uint8_t* data, size_t size)
+{
+	assert(size <= UINT32_MAX);
+
+	//The length and the message go out in as few writes as the descriptor allows.
+	uint32_t length = static_cast<uint32_t>(size);
+	iovec parts[2];
+	parts[0].iov_base = &length;
+	parts[0].iov_len = sizeof(length);
+	parts[1].iov_base = const_cast<uint8_t*>(data);
+	parts[1].iov_len = size;
+
+	iovec* part = parts;
+	int partCount = 2;
+	while(partCount > 0)
+	{
+		ssize_t written = ::writev(m_writeDescriptor, part, partCount);
+		if(written < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			throw FileIoException(descriptorName(m_writeDescriptor), std::strerror(errno));
+		}
+
+		size_t remaining = static_cast<size_t>(written);
+		while(partCount > 0 && remaining >= part->iov_len)
+		{
+			remaining -= part->iov_len;
+			++part;
+			--partCount;
+		}
+		if(partCount > 0)
+		{
+			part->iov_base = static_cast<char*>(part->iov_base) + remaining;
+			part->iov_len -= remaining;
+		}
+	}
+}
+
+bool MessageChannel::receive(std::vector<uint8_t>& message)
+{
+	uint32_t length;
+	if(!readFully(&length, sizeof(length)))
+	{
+		return false;
+	}
+
+	if(length > m_maxMessageSize)
+	{
+		throw FileIoException(descriptorName(m_readDescriptor), "Message is longer than the channel accepts");
+	}
+
+	message.resize(length);
+	if(length > 0 && !readFully(message.data(), length))
+	{
+		throw FileIoException(descriptorName(m_readDescriptor), "Channel closed in the middle of a message");
+	}
+	return true;
+}
+
+bool MessageChannel::poll(int timeoutMilliseconds) const
+{
+	pollfd request;
+	request.fd = m_readDescriptor;
+	request.events = POLLIN;
+	request.revents = 0;
+	return ::poll(&request, 1, timeoutMilliseconds) > 0 && (request.revents & (POLLIN | POLLHUP)) != 0;
+}
+
+void MessageChannel::close()
+{
+	if(m_readDescriptor >= 0)
+	{
+		::close(m_readDescriptor);
+	}
+	if(m_writeDescriptor >= 0 && m_writeDescriptor != m_readDescriptor)
+	{
+		::close(m_writeDescriptor);
+	}
+	m_readDescriptor = -1;
+	m_writeDescriptor = -1;
+}
+
+bool MessageChannel::readFully(void* data, size_t size)
+{
+	char* position = static_cast<char*>(data);
+	size_t done = 0;
+	while(done < size)
+	{
+		ssize_t count = ::read(m_readDescriptor, position + done, size - done);
+		if(count < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			throw FileIoException(descriptorName(m_readDescriptor), std::strerror(errno));
+		}
+		if(count == 0)
+		{
+			if(done == 0)
+			{
+				return false;
+			}
+			throw FileIoException(descriptorName(m_readDescriptor), "Channel closed in the middle of a message");
+		}
+		done += static_cast<size_t>(count);
+	}
+	return true;
+}
+
+}
+
+#endif
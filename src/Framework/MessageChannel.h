@@ -0,0 +1,77 @@
+#ifndef MESSAGECHANNEL_H_
+#define MESSAGECHANNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rf
+{
+
+/**
+ * @brief Sends length-prefixed messages over a pair of POSIX file descriptors.
+ * @details A simple local transport for TileStreamEncoder messages, such as to a spectator view
+ * running in a second process. The descriptors can be the two ends of a socket pair from
+ * createLoopback(), which can be handed to a forked child, or the ends of two pipes.
+ *
+ * Writing to a channel whose other end was closed raises SIGPIPE, which a process using channels
+ * should ignore so send() throws instead.
+ *
+ * Only available on POSIX platforms.
+ */
+class MessageChannel
+{
+public:
+	///Take ownership of @a readDescriptor and @a writeDescriptor, which may be the same socket.
+	MessageChannel(int readDescriptor, int writeDescriptor);
+	~MessageChannel();
+
+	MessageChannel(const MessageChannel&) = delete;
+	MessageChannel& operator =(const MessageChannel&) = delete;
+	MessageChannel(MessageChannel&& other) noexcept;
+	MessageChannel& operator =(MessageChannel&& other) noexcept;
+
+	///Create two channels connected to each other through a Unix socket pair.
+	///@throw FileIoException if the socket pair can't be created.
+	static std::pair<MessageChannel, MessageChannel> createLoopback();
+
+	///Send @a size bytes at @a data as one message, blocking until it is written.
+	///@throw FileIoException if writing fails.
+	void send(const uint8_t* data, size_t size);
+	void send(const std::vector<uint8_t>& message) {send(message.data(), message.size());}
+
+	/**
+	 * @brief Replace @a message with the next message, blocking until one arrives.
+	 * @return false if the other end was closed.
+	 * @throw FileIoException if reading fails, the channel closes in the middle of a message, or
+	 * the message is longer than maxMessageSize(). The channel can't be used after a throw.
+	 */
+	bool receive(std::vector<uint8_t>& message);
+
+	///@brief Set the length of the longest message receive() accepts.
+	///@details The length comes from the other end, so it is checked before any memory is allocated for it.
+	void setMaxMessageSize(uint32_t size) {m_maxMessageSize = size;}
+	uint32_t maxMessageSize() const {return m_maxMessageSize;}
+
+	static constexpr uint32_t DefaultMaxMessageSize = 64 * 1024 * 1024;
+
+	///Return true if data is waiting to be received, waiting up to @a timeoutMilliseconds for it.
+	bool poll(int timeoutMilliseconds = 0) const;
+
+	int readDescriptor() const {return m_readDescriptor;}
+	int writeDescriptor() const {return m_writeDescriptor;}
+
+protected:
+	void close();
+	///Read exactly @a size bytes, returning false if the channel was closed before any were read.
+	bool readFully(void* data, size_t size);
+
+	int m_readDescriptor;
+	int m_writeDescriptor;
+	uint32_t m_maxMessageSize = DefaultMaxMessageSize;
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "Framework/Pathfinding/CostMap.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rf
+{
+
+constexpr uint8_t CostMap::MaxCost;
+constexpr uint8_t CostMap::Impassable;
+
+CostMap::CostMap(int width, int height, uint8_t initialCost):
+	m_width(width), m_height(height), m_costs(width * height, initialCost)
+{
+	assert(initialCost > 0);
+}
+
+void CostMap::setCost(int x, int y, uint8_t cost)
+{
+	assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+	assert(cost > 0);
+
+	uint8_t& current = m_costs[x + y * m_width];
+	if(current != cost)
+	{
+		current = cost;
+		m_changeLog.logChange(Rectanglei(x, y, 1, 1));
+	}
+}
+
+void CostMap::rebuild(const TileGrid& grid, const CostFunction& cost)
+{
+	updateFrom(grid, Rectanglei(0, 0, m_width, m_height), cost);
+}
+
+void CostMap::updateFrom(const TileGrid& grid, const Rectanglei& area, const CostFunction& cost)
+{
+	assert(grid.width() == m_width && grid.height() == m_height);
+
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+
+	int changedLeft = right;
+	int changedBottom = top;
+	int changedRight = left;
+	int changedTop = bottom;
+
+	for(int y = bottom; y < top; ++y)
+	{
+		const Tile* row = grid.data() + y * m_width;
+		uint8_t* costs = m_costs.data() + y * m_width;
+		for(int x = left; x < right; ++x)
+		{
+			uint8_t newCost = cost(row[x]);
+			assert(newCost > 0);
+			if(costs[x] != newCost)
+			{
+				costs[x] = newCost;
+				changedLeft = std::min(changedLeft, x);
+				changedRight = std::max(changedRight, x + 1);
+				changedBottom = std::min(changedBottom, y);
+				changedTop = std::max(changedTop, y + 1);
+			}
+		}
+	}
+
+	if(changedRight > changedLeft)
+	{
+		m_changeLog.logChange(Rectanglei(changedLeft, changedBottom, changedRight - changedLeft, changedTop - changedBottom));
+	}
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef COSTMAP_H_
+#define COSTMAP_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Framework/RegionChangeLog.h"
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief The cost of entering each cell of a map, one byte per cell.
+ * @details Costs range from 1 to MaxCost, and Impassable marks cells that can't be entered.
+ * A CostMap is derived from a TileGrid with a CostFunction and kept in sync by passing changed
+ * areas of the grid to updateFrom(). Changes are logged by revision so pathfinding structures
+ * such as DijkstraMap can update incrementally.
+ */
+class CostMap
+{
+public:
+	static constexpr uint8_t MaxCost = 254;
+	static constexpr uint8_t Impassable = 255;
+
+	///Return the cost of entering a tile, in [1, MaxCost], or Impassable.
+	typedef std::function<uint8_t (const Tile&)> CostFunction;
+
+	///Construct a map where every cell costs @a initialCost.
+	CostMap(int width, int height, uint8_t initialCost = 1);
+	~CostMap() = default;
+
+	CostMap(const CostMap&) = default;
+	CostMap(CostMap&&) = default;
+	CostMap& operator =(const CostMap&) = default;
+	CostMap& operator =(CostMap&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	///Return the cost of entering (@a x, @a y). Cells outside the map are Impassable.
+	uint8_t getCost(int x, int y) const;
+	void setCost(int x, int y, uint8_t cost);
+
+	bool isPassable(int x, int y) const {return getCost(x, y) != Impassable;}
+
+	///Recompute the whole map from @a grid, which must have the same dimensions.
+	void rebuild(const TileGrid& grid, const CostFunction& cost);
+	///Recompute @a area of the map from the same area of @a grid.
+	void updateFrom(const TileGrid& grid, const Rectanglei& area, const CostFunction& cost);
+
+	///Return a counter that is incremented whenever the map changes.
+	uint64_t revision() const {return m_changeLog.revision();}
+	const RegionChangeLog& changeLog() const {return m_changeLog;}
+
+	///Return the costs, stored row by row starting at y = 0.
+	const uint8_t* data() const {return m_costs.data();}
+
+protected:
+	int m_width;
+	int m_height;
+	std::vector<uint8_t> m_costs;
+
+	RegionChangeLog m_changeLog;
+};
+
+inline uint8_t CostMap::getCost(int x, int y) const
+{
+	if(x < 0 || y < 0 || x >= m_width || y >= m_height)
+	{
+		return Impassable;
+	}
+	return m_costs[x + y * m_width];
+}
+
+}
+
+#endif
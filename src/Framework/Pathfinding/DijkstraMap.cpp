@@ -0,0 +1,289 @@
+#include "Framework/Pathfinding/DijkstraMap.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Framework/Jobs/JobSystem.h"
+
+namespace rf
+{
+
+constexpr int DijkstraMap::Unreachable;
+
+DijkstraMap::DijkstraMap(int width, int height, Neighborhood neighborhood):
+	m_width(width), m_height(height), m_neighborhood(neighborhood),
+	m_offsets{{Vector2i(1, 0), Vector2i(-1, 0), Vector2i(0, 1), Vector2i(0, -1),
+		Vector2i(1, 1), Vector2i(-1, 1), Vector2i(1, -1), Vector2i(-1, -1)}},
+	m_distances(width * height, Unreachable),
+	m_isInvalidated(width * height, 0), m_isGoal(width * height, 0)
+{
+}
+
+void DijkstraMap::addGoal(const Vector2i& position, int value)
+{
+	assert(position.x >= 0 && position.x < m_width && position.y >= 0 && position.y < m_height);
+
+	int cell = position.x + position.y * m_width;
+	m_goals.push_back(Goal{cell, value});
+	m_isGoal[cell] = 1;
+	m_needsRecompute = true;
+}
+
+void DijkstraMap::clearGoals()
+{
+	for(const Goal& goal : m_goals)
+	{
+		m_isGoal[goal.cell] = 0;
+	}
+	m_goals.clear();
+	m_needsRecompute = true;
+}
+
+void DijkstraMap::update(const CostMap& costs)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+
+	if(m_needsRecompute || !updateIncrementally(costs))
+	{
+		recompute(costs);
+	}
+}
+
+void DijkstraMap::recompute(const CostMap& costs)
+{
+	std::fill(m_distances.begin(), m_distances.end(), Unreachable);
+
+	m_seeds.clear();
+	for(const Goal& goal : m_goals)
+	{
+		if(goal.value < m_distances[goal.cell])
+		{
+			m_distances[goal.cell] = goal.value;
+			m_seeds.push_back(Seed{goal.cell, goal.value});
+		}
+	}
+	propagate(costs);
+
+	m_needsRecompute = false;
+	m_revision = costs.revision();
+}
+
+void DijkstraMap::updateAll(const std::vector<DijkstraMap*>& maps, const CostMap& costs, JobSystem* jobSystem)
+{
+	auto updateMaps = [&maps, &costs](int first, int last)
+	{
+		for(int i = first; i < last; ++i)
+		{
+			maps[i]->update(costs);
+		}
+	};
+
+	int count = static_cast<int>(maps.size());
+	if(jobSystem != nullptr && count > 1)
+	{
+		jobSystem->parallelFor(0, count, 1, updateMaps);
+	}
+	else
+	{
+		updateMaps(0, count);
+	}
+}
+
+Vector2i DijkstraMap::nextStep(const Vector2i& position) const
+{
+	Vector2i best = position;
+	int bestDistance = distance(position);
+	for(int i = 0; i < neighborCount(); ++i)
+	{
+		Vector2i neighbor = position + m_offsets[i];
+		if(neighbor.x < 0 || neighbor.y < 0 || neighbor.x >= m_width || neighbor.y >= m_height)
+		{
+			continue;
+		}
+		int neighborDistance = distance(neighbor);
+		if(neighborDistance < bestDistance)
+		{
+			best = neighbor;
+			bestDistance = neighborDistance;
+		}
+	}
+	return best;
+}
+
+bool DijkstraMap::updateIncrementally(const CostMap& costs)
+{
+	if(costs.revision() == m_revision)
+	{
+		return true;
+	}
+
+	m_changedAreas.clear();
+	if(!costs.changeLog().changesSince(m_revision, m_changedAreas))
+	{
+		return false;
+	}
+
+	//Invalidate the changed cells and everything downstream of them: every cell whose
+	//distance may have come through an invalidated cell.
+	m_invalidated.clear();
+	m_stack.clear();
+	for(const Rectanglei& area : m_changedAreas)
+	{
+		for(int y = area.bottom(); y < area.top(); ++y)
+		{
+			for(int x = area.left(); x < area.right(); ++x)
+			{
+				m_stack.push_back(x + y * m_width);
+			}
+		}
+	}
+
+	while(!m_stack.empty())
+	{
+		int cell = m_stack.back();
+		m_stack.pop_back();
+		if(m_isInvalidated[cell] || m_isGoal[cell])
+		{
+			continue;
+		}
+
+		int oldDistance = m_distances[cell];
+		m_isInvalidated[cell] = 1;
+		m_invalidated.push_back(cell);
+		m_distances[cell] = Unreachable;
+		if(oldDistance == Unreachable)
+		{
+			continue;
+		}
+
+		int x = cell % m_width;
+		int y = cell / m_width;
+		for(int i = 0; i < neighborCount(); ++i)
+		{
+			int neighborX = x + m_offsets[i].x;
+			int neighborY = y + m_offsets[i].y;
+			uint8_t cost = costs.getCost(neighborX, neighborY);
+			if(cost == CostMap::Impassable)
+			{
+				continue;
+			}
+			int neighbor = neighborX + neighborY * m_width;
+			if(!m_isInvalidated[neighbor] && m_distances[neighbor] == oldDistance + cost)
+			{
+				m_stack.push_back(neighbor);
+			}
+		}
+	}
+
+	//Reseed the invalidated cells from their valid neighbors, then let Dijkstra fill them in.
+	m_seeds.clear();
+	for(int cell : m_invalidated)
+	{
+		int x = cell % m_width;
+		int y = cell / m_width;
+		uint8_t cost = costs.getCost(x, y);
+		if(cost != CostMap::Impassable)
+		{
+			int best = Unreachable;
+			for(int i = 0; i < neighborCount(); ++i)
+			{
+				int neighborX = x + m_offsets[i].x;
+				int neighborY = y + m_offsets[i].y;
+				if(neighborX < 0 || neighborY < 0 || neighborX >= m_width || neighborY >= m_height)
+				{
+					continue;
+				}
+				int neighbor = neighborX + neighborY * m_width;
+				if(!m_isInvalidated[neighbor] && m_distances[neighbor] != Unreachable)
+				{
+					best = std::min(best, m_distances[neighbor] + cost);
+				}
+			}
+			if(best != Unreachable)
+			{
+				m_distances[cell] = best;
+				m_seeds.push_back(Seed{cell, best});
+			}
+		}
+	}
+	for(int cell : m_invalidated)
+	{
+		m_isInvalidated[cell] = 0;
+	}
+
+	propagate(costs);
+	m_revision = costs.revision();
+	return true;
+}
+
+void DijkstraMap::propagate(const CostMap& costs)
+{
+	//Seeds can be spread over any range of distances, so they are fed into the circular bucket
+	//queue in order as the scan reaches them, which keeps every queued distance within
+	//MaxCost of the current one.
+	std::sort(m_seeds.begin(), m_seeds.end(),
+		[](const Seed& seed1, const Seed& seed2)
+		{
+			return seed1.distance < seed2.distance;
+		});
+
+	const uint8_t* costData = costs.data();
+	size_t nextSeed = 0;
+	int queuedCount = 0;
+	int current = m_seeds.empty() ? 0 : m_seeds.front().distance;
+
+	while(queuedCount > 0 || nextSeed < m_seeds.size())
+	{
+		if(queuedCount == 0)
+		{
+			current = std::max(current, m_seeds[nextSeed].distance);
+		}
+		std::vector<int>& bucket = m_buckets[current & BucketMask];
+		while(nextSeed < m_seeds.size() && m_seeds[nextSeed].distance == current)
+		{
+			bucket.push_back(m_seeds[nextSeed].cell);
+			++queuedCount;
+			++nextSeed;
+		}
+
+		//Costs are at least 1, so nothing is added to the current bucket while it is drained.
+		for(size_t i = 0; i < bucket.size(); ++i)
+		{
+			int cell = bucket[i];
+			--queuedCount;
+			if(m_distances[cell] != current)
+			{
+				continue;
+			}
+
+			int x = cell % m_width;
+			int y = cell / m_width;
+			for(int n = 0; n < neighborCount(); ++n)
+			{
+				int neighborX = x + m_offsets[n].x;
+				int neighborY = y + m_offsets[n].y;
+				if(neighborX < 0 || neighborY < 0 || neighborX >= m_width || neighborY >= m_height)
+				{
+					continue;
+				}
+				int neighbor = neighborX + neighborY * m_width;
+				uint8_t cost = costData[neighbor];
+				if(cost == CostMap::Impassable)
+				{
+					continue;
+				}
+				int newDistance = current + cost;
+				if(newDistance < m_distances[neighbor])
+				{
+					m_distances[neighbor] = newDistance;
+					m_buckets[newDistance & BucketMask].push_back(neighbor);
+					++queuedCount;
+				}
+			}
+		}
+		bucket.clear();
+		++current;
+	}
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef DIJKSTRAMAP_H_
+#define DIJKSTRAMAP_H_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Framework/Pathfinding/CostMap.h"
+
+namespace rf
+{
+class JobSystem;
+
+/**
+ * @brief The cost of the cheapest path from every cell of a CostMap to the nearest of a set of goals.
+ * @details Also known as a flow field: any number of agents heading for the same goals can follow
+ * nextStep() downhill instead of each running its own search, so one map per goal type serves
+ * every monster on a level.
+ *
+ * Distances are computed with Dijkstra's algorithm on a bucket queue, which is possible because
+ * costs are small integers. Buffers are kept between updates, and when only a few cells of the
+ * CostMap have changed, update() only recomputes the cells whose distances depended on them.
+ */
+class DijkstraMap
+{
+public:
+	static constexpr int Unreachable = std::numeric_limits<int>::max();
+
+	enum class Neighborhood
+	{
+		///Move in the four cardinal directions.
+		Four,
+		///Move in the eight cardinal and diagonal directions, with diagonal steps costing the same.
+		Eight
+	};
+
+	DijkstraMap(int width, int height, Neighborhood neighborhood = Neighborhood::Eight);
+	~DijkstraMap() = default;
+
+	DijkstraMap(const DijkstraMap&) = default;
+	DijkstraMap(DijkstraMap&&) = default;
+	DijkstraMap& operator =(const DijkstraMap&) = default;
+	DijkstraMap& operator =(DijkstraMap&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	/**
+	 * @brief Add a goal at @a position.
+	 * @details @a value is the distance the goal starts with; giving goals different values makes
+	 * some more attractive than others. The whole map is recomputed by the next update().
+	 */
+	void addGoal(const Vector2i& position, int value = 0);
+	void clearGoals();
+
+	/**
+	 * @brief Bring the distances up to date with @a costs.
+	 * @details If the goals are unchanged and the changes to @a costs since the last update are
+	 * still logged, only the affected cells are recomputed; otherwise the whole map is.
+	 */
+	void update(const CostMap& costs);
+
+	///Recompute the whole map.
+	void recompute(const CostMap& costs);
+
+	///Update several maps over the same costs, in parallel on @a jobSystem if it is not null.
+	static void updateAll(const std::vector<DijkstraMap*>& maps, const CostMap& costs, JobSystem* jobSystem = nullptr);
+
+	///Return the distance from (@a x, @a y) to the nearest goal, or Unreachable.
+	int distance(int x, int y) const {return m_distances[x + y * m_width];}
+	int distance(const Vector2i& position) const {return distance(position.x, position.y);}
+
+	///Return the neighbor of @a position closest to a goal, or @a position if none is closer.
+	Vector2i nextStep(const Vector2i& position) const;
+
+	const int* data() const {return m_distances.data();}
+
+protected:
+	struct Goal
+	{
+		int cell;
+		int value;
+	};
+
+	///A cell that enters the queue with a known distance.
+	struct Seed
+	{
+		int cell;
+		int distance;
+	};
+
+	static constexpr int BucketCount = 256;
+	static constexpr int BucketMask = BucketCount - 1;
+
+	int neighborCount() const {return m_neighborhood == Neighborhood::Four ? 4 : 8;}
+
+	///Return false if the change log no longer covers the last update.
+	bool updateIncrementally(const CostMap& costs);
+	///Run Dijkstra from the seeds in m_seeds.
+	void propagate(const CostMap& costs);
+
+	int m_width;
+	int m_height;
+	Neighborhood m_neighborhood;
+	///Offsets of the neighbors of a cell, as x, y pairs.
+	std::array<Vector2i, 8> m_offsets;
+
+	std::vector<Goal> m_goals;
+	std::vector<int> m_distances;
+
+	bool m_needsRecompute = true;
+	uint64_t m_revision = 0;
+
+	//Buffers kept between updates.
+	std::vector<Seed> m_seeds;
+	std::array<std::vector<int>, BucketCount> m_buckets;
+	std::vector<Rectanglei> m_changedAreas;
+	std::vector<int> m_invalidated;
+	std::vector<int> m_stack;
+	std::vector<uint8_t> m_isInvalidated;
+	std::vector<uint8_t> m_isGoal;
+};
+
+}
+
+#endif
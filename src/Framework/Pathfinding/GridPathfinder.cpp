@@ -0,0 +1,438 @@
+#include "Framework/Pathfinding/GridPathfinder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+
+namespace rf
+{
+
+constexpr int GridPathfinder::StraightCost;
+constexpr int GridPathfinder::DiagonalCost;
+constexpr int GridPathfinder::NoPath;
+
+namespace
+{
+
+const int directions[8][2] =
+{
+	{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}
+};
+
+int sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+}
+
+GridPathfinder::GridPathfinder(int width, int height):
+	m_width(width), m_height(height),
+	m_seenGeneration(width * height, 0), m_closedGeneration(width * height, 0),
+	m_costs(width * height, 0), m_parents(width * height, -1)
+{
+}
+
+bool GridPathfinder::findPath(const CostMap& costs, const Vector2i& start, const Vector2i& goal,
+		std::vector<Vector2i>& path)
+{
+	return findPath(costs, Rectanglei(0, 0, m_width, m_height), start, goal, path);
+}
+
+bool GridPathfinder::findPath(const CostMap& costs, const Rectanglei& bounds, const Vector2i& start,
+		const Vector2i& goal, std::vector<Vector2i>& path)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+
+	path.clear();
+	m_pathCost = NoPath;
+	beginSearch();
+
+	int startCell = start.x + start.y * m_width;
+	int goalCell = goal.x + goal.y * m_width;
+	open(startCell, 0, -1, estimateCost(start, goal));
+
+	while(!m_open.empty())
+	{
+		OpenEntry entry = popOpen();
+		int cell = entry.cell;
+		if(isClosed(cell))
+		{
+			continue;
+		}
+		m_closedGeneration[cell] = m_generation;
+
+		if(cell == goalCell)
+		{
+			m_pathCost = m_costs[cell];
+			reconstructPath(cell, false, path);
+			return true;
+		}
+
+		int x = cell % m_width;
+		int y = cell / m_width;
+		for(const int* direction : directions)
+		{
+			int neighborX = x + direction[0];
+			int neighborY = y + direction[1];
+			if(neighborX < bounds.left() || neighborX >= bounds.right()
+					|| neighborY < bounds.bottom() || neighborY >= bounds.top())
+			{
+				continue;
+			}
+			int step = stepCost(costs, x, y, direction[0], direction[1]);
+			if(step == NoPath)
+			{
+				continue;
+			}
+
+			int neighbor = neighborX + neighborY * m_width;
+			int cost = m_costs[cell] + step;
+			if(!isSeen(neighbor) || cost < m_costs[neighbor])
+			{
+				open(neighbor, cost, cell, cost + estimateCost(Vector2i(neighborX, neighborY), goal));
+			}
+		}
+	}
+	return false;
+}
+
+bool GridPathfinder::findPathJps(const CostMap& costs, const Vector2i& start, const Vector2i& goal,
+		std::vector<Vector2i>& path)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+
+	path.clear();
+	m_pathCost = NoPath;
+	beginSearch();
+
+	int startCell = start.x + start.y * m_width;
+	int goalCell = goal.x + goal.y * m_width;
+	if(!costs.isPassable(goal.x, goal.y))
+	{
+		return false;
+	}
+	open(startCell, 0, -1, estimateCost(start, goal));
+
+	//Successor directions of the current jump point, as dx, dy pairs.
+	int successors[8][2];
+
+	while(!m_open.empty())
+	{
+		OpenEntry entry = popOpen();
+		int cell = entry.cell;
+		if(isClosed(cell))
+		{
+			continue;
+		}
+		m_closedGeneration[cell] = m_generation;
+
+		if(cell == goalCell)
+		{
+			m_pathCost = m_costs[cell];
+			reconstructPath(cell, true, path);
+			return true;
+		}
+
+		int x = cell % m_width;
+		int y = cell / m_width;
+		int successorCount = 0;
+		auto addSuccessor = [&successors, &successorCount](int dx, int dy)
+		{
+			successors[successorCount][0] = dx;
+			successors[successorCount][1] = dy;
+			++successorCount;
+		};
+		auto walkable = [&costs](int cellX, int cellY)
+		{
+			return costs.isPassable(cellX, cellY);
+		};
+
+		int parent = m_parents[cell];
+		if(parent < 0)
+		{
+			for(const int* direction : directions)
+			{
+				if(stepCost(costs, x, y, direction[0], direction[1]) != NoPath)
+				{
+					addSuccessor(direction[0], direction[1]);
+				}
+			}
+		}
+		else
+		{
+			//Only the natural and forced neighbors for the direction of travel are considered.
+			int dx = sign(x - parent % m_width);
+			int dy = sign(y - parent / m_width);
+			if(dx != 0 && dy != 0)
+			{
+				bool canMoveY = walkable(x, y + dy);
+				bool canMoveX = walkable(x + dx, y);
+				if(canMoveY)
+				{
+					addSuccessor(0, dy);
+				}
+				if(canMoveX)
+				{
+					addSuccessor(dx, 0);
+				}
+				if(canMoveX && canMoveY && walkable(x + dx, y + dy))
+				{
+					addSuccessor(dx, dy);
+				}
+			}
+			else if(dx != 0)
+			{
+				bool canMoveAhead = walkable(x + dx, y);
+				bool canMoveUp = walkable(x, y + 1);
+				bool canMoveDown = walkable(x, y - 1);
+				if(canMoveAhead)
+				{
+					addSuccessor(dx, 0);
+					if(canMoveUp && walkable(x + dx, y + 1))
+					{
+						addSuccessor(dx, 1);
+					}
+					if(canMoveDown && walkable(x + dx, y - 1))
+					{
+						addSuccessor(dx, -1);
+					}
+				}
+				if(canMoveUp)
+				{
+					addSuccessor(0, 1);
+				}
+				if(canMoveDown)
+				{
+					addSuccessor(0, -1);
+				}
+			}
+			else
+			{
+				bool canMoveAhead = walkable(x, y + dy);
+				bool canMoveRight = walkable(x + 1, y);
+				bool canMoveLeft = walkable(x - 1, y);
+				if(canMoveAhead)
+				{
+					addSuccessor(0, dy);
+					if(canMoveRight && walkable(x + 1, y + dy))
+					{
+						addSuccessor(1, dy);
+					}
+					if(canMoveLeft && walkable(x - 1, y + dy))
+					{
+						addSuccessor(-1, dy);
+					}
+				}
+				if(canMoveRight)
+				{
+					addSuccessor(1, 0);
+				}
+				if(canMoveLeft)
+				{
+					addSuccessor(-1, 0);
+				}
+			}
+		}
+
+		for(int i = 0; i < successorCount; ++i)
+		{
+			int jumpPoint = jump(costs, x + successors[i][0], y + successors[i][1], successors[i][0],
+					successors[i][1], goalCell);
+			if(jumpPoint < 0 || isClosed(jumpPoint))
+			{
+				continue;
+			}
+
+			Vector2i jumpPosition(jumpPoint % m_width, jumpPoint / m_width);
+			int cost = m_costs[cell] + estimateCost(Vector2i(x, y), jumpPosition);
+			if(!isSeen(jumpPoint) || cost < m_costs[jumpPoint])
+			{
+				open(jumpPoint, cost, cell, cost + estimateCost(jumpPosition, goal));
+			}
+		}
+	}
+	return false;
+}
+
+void GridPathfinder::computeDistances(const CostMap& costs, const Rectanglei& bounds, const Vector2i& origin,
+		bool towardOrigin)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+
+	beginSearch();
+	open(origin.x + origin.y * m_width, 0, -1, 0);
+
+	while(!m_open.empty())
+	{
+		OpenEntry entry = popOpen();
+		int cell = entry.cell;
+		if(isClosed(cell))
+		{
+			continue;
+		}
+		m_closedGeneration[cell] = m_generation;
+
+		int x = cell % m_width;
+		int y = cell / m_width;
+		for(const int* direction : directions)
+		{
+			int neighborX = x + direction[0];
+			int neighborY = y + direction[1];
+			if(neighborX < bounds.left() || neighborX >= bounds.right()
+					|| neighborY < bounds.bottom() || neighborY >= bounds.top())
+			{
+				continue;
+			}
+
+			//Searching backwards, the cost is that of moving from the neighbor into this cell.
+			int step = towardOrigin ? stepCost(costs, neighborX, neighborY, -direction[0], -direction[1]) :
+					stepCost(costs, x, y, direction[0], direction[1]);
+			if(step == NoPath)
+			{
+				continue;
+			}
+
+			int neighbor = neighborX + neighborY * m_width;
+			int cost = m_costs[cell] + step;
+			if(!isSeen(neighbor) || cost < m_costs[neighbor])
+			{
+				open(neighbor, cost, cell, cost);
+			}
+		}
+	}
+}
+
+int GridPathfinder::distance(const Vector2i& position) const
+{
+	int cell = position.x + position.y * m_width;
+	return isClosed(cell) ? m_costs[cell] : NoPath;
+}
+
+int GridPathfinder::stepCost(const CostMap& costs, int x, int y, int dx, int dy)
+{
+	uint8_t cost = costs.getCost(x + dx, y + dy);
+	if(cost == CostMap::Impassable)
+	{
+		return NoPath;
+	}
+	if(dx != 0 && dy != 0)
+	{
+		if(!costs.isPassable(x + dx, y) || !costs.isPassable(x, y + dy))
+		{
+			return NoPath;
+		}
+		return cost * DiagonalCost;
+	}
+	return cost * StraightCost;
+}
+
+int GridPathfinder::estimateCost(const Vector2i& from, const Vector2i& to)
+{
+	int dx = std::abs(to.x - from.x);
+	int dy = std::abs(to.y - from.y);
+	return StraightCost * std::max(dx, dy) + (DiagonalCost - StraightCost) * std::min(dx, dy);
+}
+
+void GridPathfinder::beginSearch()
+{
+	++m_generation;
+	if(m_generation == 0)
+	{
+		//The counter wrapped, so old marks could be mistaken for current ones.
+		std::fill(m_seenGeneration.begin(), m_seenGeneration.end(), 0);
+		std::fill(m_closedGeneration.begin(), m_closedGeneration.end(), 0);
+		m_generation = 1;
+	}
+	m_open.clear();
+}
+
+void GridPathfinder::open(int cell, int cost, int parent, int priority)
+{
+	m_seenGeneration[cell] = m_generation;
+	m_costs[cell] = cost;
+	m_parents[cell] = parent;
+	m_open.push_back(OpenEntry{priority, cell});
+	std::push_heap(m_open.begin(), m_open.end(), std::greater<OpenEntry>());
+}
+
+GridPathfinder::OpenEntry GridPathfinder::popOpen()
+{
+	std::pop_heap(m_open.begin(), m_open.end(), std::greater<OpenEntry>());
+	OpenEntry entry = m_open.back();
+	m_open.pop_back();
+	return entry;
+}
+
+int GridPathfinder::jump(const CostMap& costs, int x, int y, int dx, int dy, int goal) const
+{
+	//Step in a straight or diagonal line until something forces a turn.
+	for(;;)
+	{
+		if(!costs.isPassable(x, y))
+		{
+			return -1;
+		}
+		int cell = x + y * m_width;
+		if(cell == goal)
+		{
+			return cell;
+		}
+
+		if(dx != 0 && dy != 0)
+		{
+			if(jump(costs, x + dx, y, dx, 0, goal) >= 0 || jump(costs, x, y + dy, 0, dy, goal) >= 0)
+			{
+				return cell;
+			}
+			if(!costs.isPassable(x + dx, y) || !costs.isPassable(x, y + dy))
+			{
+				return -1;
+			}
+		}
+		else if(dx != 0)
+		{
+			if((costs.isPassable(x, y + 1) && !costs.isPassable(x - dx, y + 1))
+					|| (costs.isPassable(x, y - 1) && !costs.isPassable(x - dx, y - 1)))
+			{
+				return cell;
+			}
+		}
+		else
+		{
+			if((costs.isPassable(x + 1, y) && !costs.isPassable(x + 1, y - dy))
+					|| (costs.isPassable(x - 1, y) && !costs.isPassable(x - 1, y - dy)))
+			{
+				return cell;
+			}
+		}
+
+		x += dx;
+		y += dy;
+	}
+}
+
+void GridPathfinder::reconstructPath(int goal, bool expandJumps, std::vector<Vector2i>& path) const
+{
+	for(int cell = goal; cell >= 0; cell = m_parents[cell])
+	{
+		Vector2i position(cell % m_width, cell / m_width);
+		int parent = m_parents[cell];
+		path.push_back(position);
+
+		if(expandJumps && parent >= 0)
+		{
+			//Fill in the cells skipped by the jump, which lie on a straight or diagonal line.
+			Vector2i parentPosition(parent % m_width, parent / m_width);
+			Vector2i step(sign(parentPosition.x - position.x), sign(parentPosition.y - position.y));
+			for(Vector2i between = position + step; !(between == parentPosition); between += step)
+			{
+				path.push_back(between);
+			}
+		}
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+}
@@ -0,0 +1,113 @@
+#ifndef GRIDPATHFINDER_H_
+#define GRIDPATHFINDER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Pathfinding/CostMap.h"
+
+namespace rf
+{
+
+/**
+ * @brief Point to point searches over a CostMap.
+ * @details Moves go to any of the eight neighbors. A straight move costs StraightCost times the
+ * cost of the cell entered and a diagonal move DiagonalCost times it, and diagonal moves may not
+ * cut the corner of an impassable cell.
+ *
+ * All buffers are sized to the map once and reused by every search, so searches don't allocate
+ * apart from growing the output path. A GridPathfinder must only be used by one thread at a time;
+ * give each thread its own to search in parallel.
+ */
+class GridPathfinder
+{
+public:
+	static constexpr int StraightCost = 10;
+	static constexpr int DiagonalCost = 14;
+	static constexpr int NoPath = -1;
+
+	GridPathfinder(int width, int height);
+	~GridPathfinder() = default;
+
+	GridPathfinder(const GridPathfinder&) = default;
+	GridPathfinder(GridPathfinder&&) = default;
+	GridPathfinder& operator =(const GridPathfinder&) = default;
+	GridPathfinder& operator =(GridPathfinder&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	/**
+	 * @brief Find the cheapest path from @a start to @a goal with A*.
+	 * @param path Set to the cells of the path, from @a start to @a goal inclusive.
+	 * @return false if there is no path.
+	 */
+	bool findPath(const CostMap& costs, const Vector2i& start, const Vector2i& goal, std::vector<Vector2i>& path);
+
+	///Find the cheapest path that stays within @a bounds.
+	bool findPath(const CostMap& costs, const Rectanglei& bounds, const Vector2i& start, const Vector2i& goal,
+			std::vector<Vector2i>& path);
+
+	/**
+	 * @brief Find the shortest path from @a start to @a goal with jump point search.
+	 * @details Jump point search skips over runs of open cells instead of expanding them one at a
+	 * time, which makes it many times faster than A* on open maps, but it only works for uniform
+	 * costs: every passable cell is treated as costing 1, whatever its cost in @a costs. The
+	 * resulting path is expanded to include every cell.
+	 */
+	bool findPathJps(const CostMap& costs, const Vector2i& start, const Vector2i& goal, std::vector<Vector2i>& path);
+
+	///Return the cost of the last path found.
+	int pathCost() const {return m_pathCost;}
+
+	/**
+	 * @brief Compute the cost of the cheapest path within @a bounds between @a origin and every cell.
+	 * @details If @a towardOrigin is false costs are for paths from @a origin, otherwise for paths
+	 * to @a origin. Read the results with distance() before the next search.
+	 */
+	void computeDistances(const CostMap& costs, const Rectanglei& bounds, const Vector2i& origin, bool towardOrigin = false);
+
+	///Return a distance computed by computeDistances(), or NoPath if the cell wasn't reached.
+	int distance(const Vector2i& position) const;
+
+	///Return the cost of moving from (@a x, @a y) by (@a dx, @a dy), or NoPath if the move isn't allowed.
+	static int stepCost(const CostMap& costs, int x, int y, int dx, int dy);
+
+	///Return a lower bound on the cost of a path between two cells.
+	static int estimateCost(const Vector2i& from, const Vector2i& to);
+
+protected:
+	struct OpenEntry
+	{
+		int priority;
+		int cell;
+
+		bool operator >(const OpenEntry& entry) const {return priority > entry.priority;}
+	};
+
+	///Start a new search, invalidating the results of the previous one.
+	void beginSearch();
+	bool isSeen(int cell) const {return m_seenGeneration[cell] == m_generation;}
+	bool isClosed(int cell) const {return m_closedGeneration[cell] == m_generation;}
+	void open(int cell, int cost, int parent, int priority);
+	OpenEntry popOpen();
+
+	int jump(const CostMap& costs, int x, int y, int dx, int dy, int goal) const;
+	void reconstructPath(int goal, bool expandJumps, std::vector<Vector2i>& path) const;
+
+	int m_width;
+	int m_height;
+
+	uint32_t m_generation = 0;
+	std::vector<uint32_t> m_seenGeneration;
+	std::vector<uint32_t> m_closedGeneration;
+	std::vector<int> m_costs;
+	std::vector<int> m_parents;
+	std::vector<OpenEntry> m_open;
+
+	int m_pathCost = NoPath;
+};
+
+}
+
+#endif
@@ -0,0 +1,439 @@
+#include "Framework/Pathfinding/HierarchicalPathfinder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+namespace rf
+{
+
+constexpr int HierarchicalPathfinder::NoPath;
+
+namespace
+{
+///Entrances shorter than this get one transition in the middle, longer ones one at each end.
+const int singleTransitionLength = 6;
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(int width, int height, int clusterSize):
+	m_width(width), m_height(height), m_clusterSize(clusterSize),
+	m_clustersX((width + clusterSize - 1) / clusterSize), m_clustersY((height + clusterSize - 1) / clusterSize),
+	m_localSearch(width, height),
+	m_searchGeneration(width * height, 0), m_searchCosts(width * height, 0), m_searchParents(width * height, -1)
+{
+	assert(clusterSize > 0);
+
+	m_clusters.resize(m_clustersX * m_clustersY);
+	m_borders.resize(m_clusters.size() * 2);
+	for(int y = 0; y < m_clustersY; ++y)
+	{
+		for(int x = 0; x < m_clustersX; ++x)
+		{
+			int left = x * clusterSize;
+			int bottom = y * clusterSize;
+			m_clusters[x + y * m_clustersX].bounds = Rectanglei(left, bottom,
+					std::min(clusterSize, width - left), std::min(clusterSize, height - bottom));
+		}
+	}
+}
+
+int HierarchicalPathfinder::update(const CostMap& costs)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+
+	std::vector<bool> dirty(m_clusters.size(), false);
+	m_changes.clear();
+	if(!m_isBuilt || !costs.changeLog().changesSince(m_revision, m_changes))
+	{
+		std::fill(dirty.begin(), dirty.end(), true);
+	}
+	else
+	{
+		for(const Rectanglei& area : m_changes)
+		{
+			int left = std::max(area.left(), 0) / m_clusterSize;
+			int bottom = std::max(area.bottom(), 0) / m_clusterSize;
+			int right = (std::min(area.right(), m_width) - 1) / m_clusterSize;
+			int top = (std::min(area.top(), m_height) - 1) / m_clusterSize;
+			for(int y = bottom; y <= top; ++y)
+			{
+				for(int x = left; x <= right; ++x)
+				{
+					dirty[x + y * m_clustersX] = true;
+				}
+			}
+		}
+	}
+
+	m_isBuilt = true;
+	m_revision = costs.revision();
+	rebuildClusters(costs, dirty);
+	return static_cast<int>(std::count(dirty.begin(), dirty.end(), true));
+}
+
+bool HierarchicalPathfinder::findPath(const CostMap& costs, const Vector2i& start, const Vector2i& goal,
+		std::vector<Vector2i>& path)
+{
+	assert(costs.width() == m_width && costs.height() == m_height);
+	assert(m_isBuilt && m_revision == costs.revision());
+
+	path.clear();
+	m_pathCost = NoPath;
+	if(!costs.isPassable(goal.x, goal.y))
+	{
+		return false;
+	}
+	if(start == goal)
+	{
+		path.push_back(start);
+		m_pathCost = 0;
+		return true;
+	}
+
+	int startCell = toCell(start);
+	int goalCell = toCell(goal);
+	const Cluster& startCluster = m_clusters[clusterAt(startCell)];
+	const Cluster& goalCluster = m_clusters[clusterAt(goalCell)];
+
+	//A path that stays inside a single cluster may be better than any through its entrances.
+	int localCost = NoPath;
+	if(&startCluster == &goalCluster && m_localSearch.findPath(costs, startCluster.bounds, start, goal, path))
+	{
+		localCost = m_localSearch.pathCost();
+	}
+
+	//Connect the endpoints to the entrances of their clusters.
+	m_startEdges.clear();
+	m_localSearch.computeDistances(costs, startCluster.bounds, start);
+	for(const Node& node : startCluster.nodes)
+	{
+		int cost = m_localSearch.distance(toPosition(node.cell));
+		if(cost != NoPath)
+		{
+			m_startEdges.push_back(Edge{node.cell, cost});
+		}
+	}
+
+	m_goalEdges.clear();
+	m_localSearch.computeDistances(costs, goalCluster.bounds, goal, true);
+	for(const Node& node : goalCluster.nodes)
+	{
+		int cost = m_localSearch.distance(toPosition(node.cell));
+		if(cost != NoPath)
+		{
+			m_goalEdges.push_back(Edge{node.cell, cost});
+		}
+	}
+
+	if(!searchAbstractGraph(start, goal, m_abstractPath)
+			|| (localCost != NoPath && localCost <= m_searchCosts[goalCell]))
+	{
+		if(localCost == NoPath)
+		{
+			return false;
+		}
+		//The local search already left its path in the output.
+		m_pathCost = localCost;
+		return true;
+	}
+
+	path.clear();
+	return refinePath(costs, m_abstractPath, path);
+}
+
+int HierarchicalPathfinder::nodeCount() const
+{
+	int count = 0;
+	for(const Cluster& cluster : m_clusters)
+	{
+		count += static_cast<int>(cluster.nodes.size());
+	}
+	return count;
+}
+
+int HierarchicalPathfinder::clusterAt(int cell) const
+{
+	return (cell % m_width) / m_clusterSize + (cell / m_width) / m_clusterSize * m_clustersX;
+}
+
+void HierarchicalPathfinder::rebuildClusters(const CostMap& costs, const std::vector<bool>& dirty)
+{
+	//A changed cluster changes the entrances on all four of its borders, and so the nodes of
+	//the neighbors across them too.
+	std::vector<bool> affected(m_clusters.size(), false);
+	for(int y = 0; y < m_clustersY; ++y)
+	{
+		for(int x = 0; x < m_clustersX; ++x)
+		{
+			int cluster = x + y * m_clustersX;
+			if(!dirty[cluster])
+			{
+				continue;
+			}
+
+			affected[cluster] = true;
+			if(x + 1 < m_clustersX)
+			{
+				findTransitions(costs, cluster, EastBorder);
+				affected[cluster + 1] = true;
+			}
+			if(y + 1 < m_clustersY)
+			{
+				findTransitions(costs, cluster, NorthBorder);
+				affected[cluster + m_clustersX] = true;
+			}
+			if(x > 0)
+			{
+				findTransitions(costs, cluster - 1, EastBorder);
+				affected[cluster - 1] = true;
+			}
+			if(y > 0)
+			{
+				findTransitions(costs, cluster - m_clustersX, NorthBorder);
+				affected[cluster - m_clustersX] = true;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < m_clusters.size(); ++i)
+	{
+		if(affected[i])
+		{
+			buildNodes(costs, static_cast<int>(i));
+		}
+	}
+}
+
+void HierarchicalPathfinder::findTransitions(const CostMap& costs, int cluster, Border border)
+{
+	const Rectanglei& bounds = m_clusters[cluster].bounds;
+	std::vector<Transition>& transitions = m_borders[cluster * 2 + border];
+	transitions.clear();
+
+	//Walk along the border, finding the runs of cells that are open on both sides.
+	Vector2i first = border == EastBorder ? Vector2i(bounds.right() - 1, bounds.bottom()) :
+			Vector2i(bounds.left(), bounds.top() - 1);
+	Vector2i along = border == EastBorder ? Vector2i(0, 1) : Vector2i(1, 0);
+	Vector2i across = border == EastBorder ? Vector2i(1, 0) : Vector2i(0, 1);
+	int length = border == EastBorder ? bounds.height() : bounds.width();
+
+	auto addTransition = [&](int offset)
+	{
+		Vector2i lower = first + along * offset;
+		transitions.push_back(Transition{toCell(lower), toCell(lower + across)});
+	};
+
+	int runStart = -1;
+	for(int i = 0; i <= length; ++i)
+	{
+		Vector2i lower = first + along * i;
+		Vector2i upper = lower + across;
+		bool isOpen = i < length && costs.isPassable(lower.x, lower.y) && costs.isPassable(upper.x, upper.y);
+		if(isOpen && runStart < 0)
+		{
+			runStart = i;
+		}
+		else if(!isOpen && runStart >= 0)
+		{
+			if(i - runStart < singleTransitionLength)
+			{
+				addTransition((runStart + i - 1) / 2);
+			}
+			else
+			{
+				addTransition(runStart);
+				addTransition(i - 1);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void HierarchicalPathfinder::buildNodes(const CostMap& costs, int cluster)
+{
+	Cluster& current = m_clusters[cluster];
+	current.nodes.clear();
+
+	auto addLink = [&](int cell, int target)
+	{
+		auto node = std::find_if(current.nodes.begin(), current.nodes.end(),
+			[cell](const Node& node)
+			{
+				return node.cell == cell;
+			});
+		if(node == current.nodes.end())
+		{
+			current.nodes.push_back(Node{cell, std::vector<Edge>()});
+			node = current.nodes.end() - 1;
+		}
+
+		Vector2i from = toPosition(cell);
+		Vector2i to = toPosition(target);
+		node->edges.push_back(Edge{target, GridPathfinder::stepCost(costs, from.x, from.y, to.x - from.x, to.y - from.y)});
+	};
+
+	int x = cluster % m_clustersX;
+	int y = cluster / m_clustersX;
+	for(const Transition& transition : m_borders[cluster * 2 + EastBorder])
+	{
+		addLink(transition.lowerCell, transition.upperCell);
+	}
+	for(const Transition& transition : m_borders[cluster * 2 + NorthBorder])
+	{
+		addLink(transition.lowerCell, transition.upperCell);
+	}
+	if(x > 0)
+	{
+		for(const Transition& transition : m_borders[(cluster - 1) * 2 + EastBorder])
+		{
+			addLink(transition.upperCell, transition.lowerCell);
+		}
+	}
+	if(y > 0)
+	{
+		for(const Transition& transition : m_borders[(cluster - m_clustersX) * 2 + NorthBorder])
+		{
+			addLink(transition.upperCell, transition.lowerCell);
+		}
+	}
+
+	//Cache the cost of crossing the cluster between each pair of its entrances.
+	for(Node& node : current.nodes)
+	{
+		m_localSearch.computeDistances(costs, current.bounds, toPosition(node.cell));
+		for(const Node& other : current.nodes)
+		{
+			int cost = m_localSearch.distance(toPosition(other.cell));
+			if(&other != &node && cost != NoPath)
+			{
+				node.edges.push_back(Edge{other.cell, cost});
+			}
+		}
+	}
+}
+
+const HierarchicalPathfinder::Node* HierarchicalPathfinder::findNode(int cell) const
+{
+	for(const Node& node : m_clusters[clusterAt(cell)].nodes)
+	{
+		if(node.cell == cell)
+		{
+			return &node;
+		}
+	}
+	return nullptr;
+}
+
+bool HierarchicalPathfinder::searchAbstractGraph(const Vector2i& start, const Vector2i& goal, std::vector<int>& cells)
+{
+	++m_generation;
+	if(m_generation == 0)
+	{
+		std::fill(m_searchGeneration.begin(), m_searchGeneration.end(), 0);
+		m_generation = 1;
+	}
+	m_open.clear();
+
+	int startCell = toCell(start);
+	int goalCell = toCell(goal);
+	int goalCluster = clusterAt(goalCell);
+
+	auto open = [&](int cell, int cost, int parent)
+	{
+		if(m_searchGeneration[cell] == m_generation && m_searchCosts[cell] <= cost)
+		{
+			return;
+		}
+		m_searchGeneration[cell] = m_generation;
+		m_searchCosts[cell] = cost;
+		m_searchParents[cell] = parent;
+		m_open.push_back(SearchEntry{cost + GridPathfinder::estimateCost(toPosition(cell), goal), cell});
+		std::push_heap(m_open.begin(), m_open.end(), std::greater<SearchEntry>());
+	};
+
+	open(startCell, 0, -1);
+	while(!m_open.empty())
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), std::greater<SearchEntry>());
+		SearchEntry entry = m_open.back();
+		m_open.pop_back();
+
+		int cell = entry.cell;
+		int cost = m_searchCosts[cell];
+		if(entry.priority > cost + GridPathfinder::estimateCost(toPosition(cell), goal))
+		{
+			//A cheaper way here was found after this entry was queued.
+			continue;
+		}
+
+		if(cell == goalCell)
+		{
+			cells.clear();
+			for(int step = goalCell; step >= 0; step = m_searchParents[step])
+			{
+				cells.push_back(step);
+			}
+			std::reverse(cells.begin(), cells.end());
+			return true;
+		}
+
+		if(cell == startCell)
+		{
+			for(const Edge& edge : m_startEdges)
+			{
+				open(edge.target, cost + edge.cost, cell);
+			}
+		}
+		if(const Node* node = findNode(cell))
+		{
+			for(const Edge& edge : node->edges)
+			{
+				open(edge.target, cost + edge.cost, cell);
+			}
+		}
+		if(clusterAt(cell) == goalCluster)
+		{
+			for(const Edge& edge : m_goalEdges)
+			{
+				if(edge.target == cell)
+				{
+					open(goalCell, cost + edge.cost, cell);
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool HierarchicalPathfinder::refinePath(const CostMap& costs, const std::vector<int>& cells, std::vector<Vector2i>& path)
+{
+	int totalCost = 0;
+	path.push_back(toPosition(cells.front()));
+	for(size_t i = 1; i < cells.size(); ++i)
+	{
+		Vector2i from = toPosition(cells[i - 1]);
+		Vector2i to = toPosition(cells[i]);
+		int cluster = clusterAt(cells[i - 1]);
+		if(cluster != clusterAt(cells[i]))
+		{
+			//Crossing a border is a single step between neighboring cells.
+			totalCost += GridPathfinder::stepCost(costs, from.x, from.y, to.x - from.x, to.y - from.y);
+			path.push_back(to);
+			continue;
+		}
+
+		if(!m_localSearch.findPath(costs, m_clusters[cluster].bounds, from, to, m_segment))
+		{
+			//The graph is out of date with the costs.
+			path.clear();
+			return false;
+		}
+		totalCost += m_localSearch.pathCost();
+		path.insert(path.end(), m_segment.begin() + 1, m_segment.end());
+	}
+
+	m_pathCost = totalCost;
+	return true;
+}
+
+}
@@ -0,0 +1,151 @@
+#ifndef HIERARCHICALPATHFINDER_H_
+#define HIERARCHICALPATHFINDER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Pathfinding/GridPathfinder.h"
+
+namespace rf
+{
+
+/**
+ * @brief Long distance pathfinding over a CostMap with HPA*.
+ * @details The map is divided into square clusters. Where two neighboring clusters can be crossed
+ * between, entrance cells are placed on both sides of the border, and the cost of the cheapest path
+ * between every pair of entrances of a cluster, staying inside it, is cached. A query searches this
+ * small abstract graph and then refines each of its edges with a local search bounded to a single
+ * cluster, so the work no longer grows with the area between the endpoints.
+ *
+ * Paths are close to optimal but not guaranteed to be, because they are constrained to pass
+ * through entrances; the difference is largest for short paths on cluttered maps. Use
+ * GridPathfinder for short paths or where exact paths matter.
+ *
+ * update() only rebuilds the clusters that contain cells changed since the last update, along with
+ * the entrances and cached costs of their neighbors, which share their borders.
+ */
+class HierarchicalPathfinder
+{
+public:
+	static constexpr int NoPath = GridPathfinder::NoPath;
+
+	HierarchicalPathfinder(int width, int height, int clusterSize = 16);
+	~HierarchicalPathfinder() = default;
+
+	HierarchicalPathfinder(const HierarchicalPathfinder&) = default;
+	HierarchicalPathfinder(HierarchicalPathfinder&&) = default;
+	HierarchicalPathfinder& operator =(const HierarchicalPathfinder&) = default;
+	HierarchicalPathfinder& operator =(HierarchicalPathfinder&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+	int clusterSize() const {return m_clusterSize;}
+
+	/**
+	 * @brief Bring the cluster graph up to date with @a costs.
+	 * @details The first update, and any update after more changes than the CostMap logs, builds
+	 * every cluster.
+	 * @return The number of clusters rebuilt.
+	 */
+	int update(const CostMap& costs);
+
+	/**
+	 * @brief Find a path from @a start to @a goal.
+	 * @details update() must have been called since @a costs last changed.
+	 * @param path Set to the cells of the path, from @a start to @a goal inclusive.
+	 * @return false if there is no path.
+	 */
+	bool findPath(const CostMap& costs, const Vector2i& start, const Vector2i& goal, std::vector<Vector2i>& path);
+
+	///Return the cost of the last path found.
+	int pathCost() const {return m_pathCost;}
+
+	///Return the number of entrance nodes in the abstract graph.
+	int nodeCount() const;
+
+protected:
+	struct Edge
+	{
+		int target;
+		int cost;
+	};
+
+	struct Node
+	{
+		int cell;
+		std::vector<Edge> edges;
+	};
+
+	struct Cluster
+	{
+		Rectanglei bounds;
+		std::vector<Node> nodes;
+	};
+
+	///A pair of entrance cells facing each other across a border.
+	struct Transition
+	{
+		///The cell in the cluster to the west or south.
+		int lowerCell;
+		///The cell in the cluster to the east or north.
+		int upperCell;
+	};
+
+	enum Border
+	{
+		EastBorder = 0,
+		NorthBorder = 1
+	};
+
+	struct SearchEntry
+	{
+		int priority;
+		int cell;
+
+		bool operator >(const SearchEntry& entry) const {return priority > entry.priority;}
+	};
+
+	int clusterAt(int cell) const;
+	Vector2i toPosition(int cell) const {return Vector2i(cell % m_width, cell / m_width);}
+	int toCell(const Vector2i& position) const {return position.x + position.y * m_width;}
+
+	void rebuildClusters(const CostMap& costs, const std::vector<bool>& dirty);
+	void findTransitions(const CostMap& costs, int cluster, Border border);
+	void buildNodes(const CostMap& costs, int cluster);
+	const Node* findNode(int cell) const;
+
+	bool searchAbstractGraph(const Vector2i& start, const Vector2i& goal, std::vector<int>& cells);
+	bool refinePath(const CostMap& costs, const std::vector<int>& cells, std::vector<Vector2i>& path);
+
+	int m_width;
+	int m_height;
+	int m_clusterSize;
+	int m_clustersX;
+	int m_clustersY;
+
+	std::vector<Cluster> m_clusters;
+	///The transitions across the east and north borders of each cluster, two entries per cluster.
+	std::vector<std::vector<Transition>> m_borders;
+	bool m_isBuilt = false;
+	uint64_t m_revision = 0;
+
+	GridPathfinder m_localSearch;
+	std::vector<Rectanglei> m_changes;
+
+	//Buffers for searching the abstract graph, indexed by cell and reused between queries.
+	uint32_t m_generation = 0;
+	std::vector<uint32_t> m_searchGeneration;
+	std::vector<int> m_searchCosts;
+	std::vector<int> m_searchParents;
+	std::vector<SearchEntry> m_open;
+	std::vector<Edge> m_startEdges;
+	std::vector<Edge> m_goalEdges;
+	std::vector<int> m_abstractPath;
+	std::vector<Vector2i> m_segment;
+
+	int m_pathCost = NoPath;
+};
+
+}
+
+#endif
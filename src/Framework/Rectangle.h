@@ -11,6 +11,7 @@
 #include "Vector2.h"
 
 #include <algorithm>
+#include <vector>
 
 namespace rf
 {
@@ -0,0 +1,64 @@
+#include "Framework/RegionChangeLog.h"
+
+namespace rf
+{
+
+RegionChangeLog::RegionChangeLog(size_t capacity):
+	m_capacity(capacity)
+{
+}
+
+void RegionChangeLog::logChange(const Rectanglei& area)
+{
+	++m_revision;
+	if(m_changes.size() == m_capacity)
+	{
+		m_oldestCheckableRevision = m_changes.front().first;
+		m_changes.erase(m_changes.begin());
+	}
+	m_changes.push_back(std::make_pair(m_revision, area));
+}
+
+bool RegionChangeLog::changedSince(uint64_t revision, const Rectanglei& area) const
+{
+	if(revision >= m_revision)
+	{
+		return false;
+	}
+	if(revision < m_oldestCheckableRevision)
+	{
+		return true;
+	}
+
+	for(auto it = m_changes.rbegin(); it != m_changes.rend() && it->first > revision; ++it)
+	{
+		const Rectanglei& changed = it->second;
+		if(changed.left() < area.right() && area.left() < changed.right()
+				&& changed.bottom() < area.top() && area.bottom() < changed.top())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RegionChangeLog::changesSince(uint64_t revision, std::vector<Rectanglei>& areas) const
+{
+	if(revision < m_oldestCheckableRevision)
+	{
+		return false;
+	}
+
+	auto it = m_changes.begin();
+	while(it != m_changes.end() && it->first <= revision)
+	{
+		++it;
+	}
+	for(; it != m_changes.end(); ++it)
+	{
+		areas.push_back(it->second);
+	}
+	return true;
+}
+
+}
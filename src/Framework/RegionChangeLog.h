@@ -0,0 +1,55 @@
+#ifndef REGIONCHANGELOG_H_
+#define REGIONCHANGELOG_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Framework/Rectangle.h"
+
+namespace rf
+{
+
+/**
+ * @brief Records which areas of a grid changed in each revision.
+ * @details Each call to logChange() starts a new revision. Only the most recent changes are
+ * kept, so questions about revisions older than that are answered conservatively.
+ */
+class RegionChangeLog
+{
+public:
+	explicit RegionChangeLog(size_t capacity = 256);
+	~RegionChangeLog() = default;
+
+	RegionChangeLog(const RegionChangeLog&) = default;
+	RegionChangeLog(RegionChangeLog&&) = default;
+	RegionChangeLog& operator =(const RegionChangeLog&) = default;
+	RegionChangeLog& operator =(RegionChangeLog&&) = default;
+
+	///Return the current revision, which is the number of changes logged so far.
+	uint64_t revision() const {return m_revision;}
+
+	///Record that @a area changed, starting a new revision.
+	void logChange(const Rectanglei& area);
+
+	///Return true if any part of @a area may have changed since @a revision.
+	bool changedSince(uint64_t revision, const Rectanglei& area) const;
+
+	/**
+	 * @brief Append the areas changed since @a revision to @a areas.
+	 * @return false, leaving @a areas untouched, if @a revision is too old to be answered.
+	 */
+	bool changesSince(uint64_t revision, std::vector<Rectanglei>& areas) const;
+
+protected:
+	size_t m_capacity;
+	uint64_t m_revision = 0;
+	///Revisions older than this can't be checked because their changes were dropped.
+	uint64_t m_oldestCheckableRevision = 0;
+	///The revision each change produced and the area it covered, oldest first.
+	std::vector<std::pair<uint64_t, Rectanglei>> m_changes;
+};
+
+}
+
+#endif
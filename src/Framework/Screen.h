@@ -3,8 +3,15 @@
 
 #include <string>
 
+#include "Framework/Rectangle.h"
+
 namespace rf
 {
+class TileGridBatch;
+
+///A stable identifier for a Screen registered with a ScreenManager, valid until the Screen is removed.
+typedef int ScreenHandle;
+const ScreenHandle invalidScreenHandle = -1;
 
 /**
  * @brief Represents a transparent 'screen' on which content is rendered.
@@ -13,6 +20,9 @@ namespace rf
  * order and each occupies the entire screen. Screens are generally created at the beginning
  * of the program and stored in an inactive state when they don't need drawn. This allows
  * persistent state even when a screen is not visible.
+ *
+ * A screen that fills part of the screen with opaque content declares it with setOpaqueArea(),
+ * so the ScreenManager can skip drawing screens below that are completely hidden.
  */
 
 class Screen
@@ -28,10 +38,24 @@ public:
 	Screen& operator =(Screen&&) = delete;
 
 	///Return the name of the Screen.
-	std::string name() const {return m_name;}
+	const std::string& name() const {return m_name;}
+	///Return the handle the ScreenManager gave the Screen, or invalidScreenHandle if it isn't registered.
+	ScreenHandle handle() const {return m_handle;}
+
+	///@brief Declare that the Screen draws opaque content over all of @a area.
+	///@details An empty area, the default, means the Screen hides nothing below it.
+	void setOpaqueArea(const Rectanglei& area) {m_opaqueArea = area;}
+	const Rectanglei& opaqueArea() const {return m_opaqueArea;}
+
+	///Set whether update() is called while the Screen is completely hidden by opaque screens above it.
+	void setUpdatedWhenHidden(bool updated) {m_isUpdatedWhenHidden = updated;}
+	bool isUpdatedWhenHidden() const {return m_isUpdatedWhenHidden;}
 
 protected:
 	std::string m_name;
+	ScreenHandle m_handle = invalidScreenHandle;
+	Rectanglei m_opaqueArea;
+	bool m_isUpdatedWhenHidden = true;
 
 	///Called when the Screen is activated or made an overlay.
 	virtual void onActivate(bool isOverlay) {};
@@ -41,6 +65,13 @@ protected:
 	virtual void update() = 0;
 	///Called every frame on active Screens. All drawing should occur only here.
 	virtual void draw() = 0;
+	/**
+	 * @brief Called every frame on visible Screens instead of draw() when the ScreenManager has a TileGridBatch.
+	 * @details Screens that only draw TileGrids can add them to the batch here, so the grids of
+	 * several screens are drawn together, and return true. Returning false, the default, has
+	 * draw() called as usual.
+	 */
+	virtual bool submitTiles(TileGridBatch&) {return false;}
 };
 
 }
@@ -4,181 +4,373 @@
 
 #include "Framework/Exceptions/NotFoundException.h"
 #include "Framework/Exceptions/ObjectExistsException.h"
+#include "Framework/TileGridBatch.h"
 
 namespace rf
 {
 
-void ScreenManager::addScreen(std::unique_ptr<Screen> screen)
+namespace
+{
+
+inline bool isEmpty(const Rectanglei& area)
+{
+	return area.width() <= 0 || area.height() <= 0;
+}
+
+///Append the parts of @a area outside @a hole to @a pieces, as at most four rectangles.
+void subtract(const Rectanglei& area, const Rectanglei& hole, std::vector<Rectanglei>& pieces)
+{
+	int left = std::max(area.left(), hole.left());
+	int bottom = std::max(area.bottom(), hole.bottom());
+	int right = std::min(area.right(), hole.right());
+	int top = std::min(area.top(), hole.top());
+	if(left >= right || bottom >= top)
+	{
+		pieces.push_back(area);
+		return;
+	}
+
+	//Full width strips below and above the hole, then the parts beside it.
+	if(area.bottom() < bottom)
+	{
+		pieces.push_back(Rectanglei(area.left(), area.bottom(), area.width(), bottom - area.bottom()));
+	}
+	if(top < area.top())
+	{
+		pieces.push_back(Rectanglei(area.left(), top, area.width(), area.top() - top));
+	}
+	if(area.left() < left)
+	{
+		pieces.push_back(Rectanglei(area.left(), bottom, left - area.left(), top - bottom));
+	}
+	if(right < area.right())
+	{
+		pieces.push_back(Rectanglei(right, bottom, area.right() - right, top - bottom));
+	}
+}
+
+}
+
+ScreenHandle ScreenManager::addScreen(std::unique_ptr<Screen> screen)
 {
 	if(hasScreen(screen->name()))
 	{
 		throw ObjectExistsException("Cannot add a new screen with name '" + screen->name() +
 				"' as a screen with that name already exists");
 	}
-	m_screens[screen->name()] = std::move(screen);
+	ScreenHandle handle = m_screens.size();
+	screen->m_handle = handle;
+	m_handles[screen->name()] = handle;
+	m_screens.push_back(std::move(screen));
+	m_isOverlay.push_back(false);
+	return handle;
+}
+
+ScreenHandle ScreenManager::findScreen(const std::string& name) const
+{
+	auto iter = m_handles.find(name);
+	return iter != m_handles.end() ? iter->second : invalidScreenHandle;
 }
 
-bool ScreenManager::hasScreen(const std::string& str) const
+bool ScreenManager::hasScreen(const std::string& name) const
 {
-	return m_screens.find(str) != m_screens.end();
+	return m_handles.find(name) != m_handles.end();
+}
+
+bool ScreenManager::hasScreen(ScreenHandle handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_screens.size()) && m_screens[handle];
 }
 
 std::unique_ptr<Screen> ScreenManager::removeScreen(const std::string& name)
 {
-	auto iter = m_screens.find(name);
-	if(iter == m_screens.end())
+	ScreenHandle handle = findScreen(name);
+	if(handle == invalidScreenHandle)
 	{
 		throw NotFoundException("Screen with the name '" + name + "' could not be removed "
 				"as no screen is registered with that name");
 	}
-	std::unique_ptr<Screen> screen = std::move(iter->second);
-	if(m_activeScreen == screen.get())
+	return removeScreen(handle);
+}
+
+std::unique_ptr<Screen> ScreenManager::removeScreen(ScreenHandle handle)
+{
+	Screen* screen = requireScreen(handle);
+	if(m_activeScreen == screen)
 	{
 		m_activeScreen->onDeactivate();
 		m_activeScreen = nullptr;
 	}
-	//If the screen to be removed is an overlay, remove it
-	for(auto it = m_overlayStack.begin(); it != m_overlayStack.end(); ++it)
-	{
-		if(*it == screen.get())
-		{
-			(*it)->onDeactivate();
-			m_overlayStack.erase(it);
-			break;
-		}
-	}
-	m_screens.erase(iter);
-	return screen;
+	removeOverlay(handle);
+
+	m_handles.erase(screen->name());
+	screen->m_handle = invalidScreenHandle;
+	return std::move(m_screens[handle]);
+}
+
+Screen* ScreenManager::getScreen(const std::string& name)
+{
+	ScreenHandle handle = findScreen(name);
+	return handle != invalidScreenHandle ? m_screens[handle].get() : nullptr;
+}
+
+Screen* ScreenManager::getScreen(ScreenHandle handle)
+{
+	return hasScreen(handle) ? m_screens[handle].get() : nullptr;
 }
 
 void ScreenManager::activateScreen(const std::string& name)
 {
-	Screen* screen;
-	try
-	{
-		screen = m_screens.at(name).get();
-	}
-	catch(const NotFoundException&)
-	{
-		throw NotFoundException("Screen '" + name + "' could not be activated"
-				"as no screen with that name is registered");
-	}
+	activateScreen(requireHandle(name));
+}
+
+void ScreenManager::activateScreen(ScreenHandle handle)
+{
+	Screen* screen = requireScreen(handle);
 	if(screen == m_activeScreen)
 	{
 		return;
 	}
-	if(isOverlay(name))
+	if(m_isOverlay[handle])
 	{
 		//TODO: Make another one of these
-		throw Exception("Screen '" + name + "' is already an overlay. "
+		throw Exception("Screen '" + screen->name() + "' is already an overlay. "
 				"A screen may not be both an overlay and the active screen at the same time");
 	}
+	if(m_activeScreen)
+	{
+		m_activeScreen->onDeactivate();
+	}
 	m_activeScreen = screen;
 	screen->onActivate(false);
 }
 
-Screen* ScreenManager::getScreen(const std::string& name)
+void ScreenManager::addOverlay(const std::string& name)
 {
-	auto iter = m_screens.find(name);
-	if(iter != m_screens.end())
+	addOverlay(requireHandle(name));
+}
+
+void ScreenManager::addOverlay(ScreenHandle handle)
+{
+	Screen* screen = requireScreen(handle);
+	if(m_isOverlay[handle])
 	{
-		return iter->second.get();
+		return;
 	}
-	else
+	if(screen == m_activeScreen)
 	{
-		return nullptr;
+		throw Exception("The screen '" + screen->name() + "' is the active screen, "
+				"it may not also be made an overlay screen.");
 	}
+	m_overlayStack.push_back(screen);
+	m_isOverlay[handle] = true;
+	screen->onActivate(true);
 }
 
-void ScreenManager::addOverlay(const std::string& name)
+void ScreenManager::removeOverlay(const std::string& name)
+{
+	removeOverlay(findScreen(name));
+}
+
+void ScreenManager::removeOverlay(ScreenHandle handle)
+{
+	if(!isOverlay(handle))
+	{
+		return;
+	}
+	Screen* screen = m_screens[handle].get();
+	m_overlayStack.erase(std::find(m_overlayStack.begin(), m_overlayStack.end(), screen));
+	m_isOverlay[handle] = false;
+	screen->onDeactivate();
+}
+
+bool ScreenManager::isOverlay(const std::string& name) const
+{
+	return isOverlay(findScreen(name));
+}
+
+bool ScreenManager::isOverlay(ScreenHandle handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_isOverlay.size()) && m_isOverlay[handle];
+}
+
+int ScreenManager::getOverlayPosition(const std::string& name) const
 {
 	if(!isOverlay(name))
 	{
-		Screen* screen = getScreen(name);
-		if(!screen)
-		{
-			throw NotFoundException("No screen registered with the name '" + name + "'");
-		}
-		if(screen == m_activeScreen)
-		{
-			throw Exception("The screen '" + name + "' is the active screen, "
-					"it may not also be made an overlay screen.");
+		throw NotFoundException("No screen with name '" + name + "' is currently acting as an an overlay.");
+	}
+	return getOverlayPosition(findScreen(name));
+}
 
-		}
-		m_overlayStack.push_back(screen);
+int ScreenManager::getOverlayPosition(ScreenHandle handle) const
+{
+	if(!isOverlay(handle))
+	{
+		throw NotFoundException("No screen with handle " + std::to_string(handle) +
+				" is currently acting as an an overlay.");
+	}
+	const Screen* screen = m_screens[handle].get();
+	return std::find(m_overlayStack.begin(), m_overlayStack.end(), screen) - m_overlayStack.begin();
+}
+
+void ScreenManager::moveOverlay(const std::string& name, int newPosition)
+{
+	moveOverlay(requireHandle(name), newPosition);
+}
+
+void ScreenManager::moveOverlay(ScreenHandle handle, int newPosition)
+{
+	Screen* screen = requireScreen(handle);
+	bool wasOverlay = m_isOverlay[handle];
+	if(wasOverlay)
+	{
+		//Moving an overlay doesn't deactivate it.
+		m_overlayStack.erase(std::find(m_overlayStack.begin(), m_overlayStack.end(), screen));
+	}
+	else if(screen == m_activeScreen)
+	{
+		throw Exception("The screen '" + screen->name() + "' is the active screen, "
+				"it may not also be made an overlay screen.");
+	}
+
+	newPosition = std::max(newPosition, 0);
+	newPosition = std::min(newPosition, static_cast<int>(m_overlayStack.size()));
+	m_overlayStack.insert(m_overlayStack.begin() + newPosition, screen);
+	if(!wasOverlay)
+	{
+		m_isOverlay[handle] = true;
 		screen->onActivate(true);
 	}
 }
 
-void ScreenManager::removeOverlay(const std::string& name)
+void ScreenManager::removeAllOverlays()
 {
-	if(isOverlay(name))
+	//Clear the stack first so the callbacks see no overlays left.
+	std::deque<Screen*> overlays;
+	overlays.swap(m_overlayStack);
+	for(Screen* overlay : overlays)
 	{
-		for(auto it = m_overlayStack.begin(); it != m_overlayStack.end(); ++it)
-		{
-			if((*it)->name() == name)
-			{
-				(*it)->onDeactivate();
-				m_overlayStack.erase(it);
-				break;
-			}
-		}
+		m_isOverlay[overlay->m_handle] = false;
+	}
+	for(Screen* overlay : overlays)
+	{
+		overlay->onDeactivate();
 	}
 }
 
-bool ScreenManager::isOverlay(const std::string& name) const
+bool ScreenManager::isHidden(const std::string& name) const
+{
+	return isHidden(findScreen(name));
+}
+
+bool ScreenManager::isHidden(ScreenHandle handle) const
 {
-	for(auto it : m_overlayStack)
+	for(const Layer& layer : m_layers)
 	{
-		if(it->name() == name)
+		if(layer.handle == handle)
 		{
-			return true;
+			return layer.isHidden;
 		}
 	}
 	return false;
 }
 
-int ScreenManager::getOverlayPosition(const std::string& name) const
+void ScreenManager::draw()
 {
-	int pos = 0;
-	for(auto it : m_overlayStack)
+	findHiddenScreens();
+	for(const Layer& layer : m_layers)
 	{
-		if(it->name() == name)
+		Screen* screen = getScreen(layer.handle);
+		if(screen == nullptr || layer.isHidden)
+		{
+			continue;
+		}
+		if(m_tileBatch != nullptr)
 		{
-			return pos;
+			if(screen->submitTiles(*m_tileBatch))
+			{
+				continue;
+			}
+			//Tiles from the screens below have to be drawn before this screen draws over them.
+			m_tileBatch->flush();
 		}
-		++pos;
+		screen->draw();
+	}
+
+	if(m_tileBatch != nullptr)
+	{
+		m_tileBatch->flush();
 	}
-	throw NotFoundException("No screen with name '" + name + "' is currently acting as an an overlay.");
 }
 
-void ScreenManager::moveOverlay(const std::string& name, int newPosition)
+void ScreenManager::update()
 {
-	removeOverlay(name);
-	Screen* screen = getScreen(name);
-	newPosition = std::max(newPosition, static_cast<int>(m_overlayStack.size()));
-	newPosition = std::min(newPosition, 0);
-	m_overlayStack.insert(m_overlayStack.begin() + newPosition + 1, screen);
+	findHiddenScreens();
+	for(const Layer& layer : m_layers)
+	{
+		//A screen may remove others while it updates.
+		Screen* screen = getScreen(layer.handle);
+		if(screen != nullptr && (!layer.isHidden || screen->isUpdatedWhenHidden()))
+		{
+			screen->update();
+		}
+	}
 }
 
-void ScreenManager::removeAllOverlays()
+ScreenHandle ScreenManager::requireHandle(const std::string& name) const
 {
-	m_overlayStack.clear();
+	ScreenHandle handle = findScreen(name);
+	if(handle == invalidScreenHandle)
+	{
+		throw NotFoundException("No screen registered with the name '" + name + "'");
+	}
+	return handle;
 }
 
-void ScreenManager::draw()
+Screen* ScreenManager::requireScreen(ScreenHandle handle) const
 {
-	if(m_activeScreen)
+	if(!hasScreen(handle))
 	{
-		m_activeScreen->draw();
+		throw NotFoundException("No screen registered with the handle " + std::to_string(handle));
 	}
+	return m_screens[handle].get();
 }
 
-void ScreenManager::update()
+void ScreenManager::findHiddenScreens()
 {
+	m_layers.clear();
 	if(m_activeScreen)
 	{
-		m_activeScreen->update();
+		m_layers.push_back({m_activeScreen->m_handle, false});
+	}
+	for(Screen* overlay : m_overlayStack)
+	{
+		m_layers.push_back({overlay->m_handle, false});
+	}
+
+	if(isEmpty(m_viewArea))
+	{
+		return;
+	}
+
+	//Walk down from the top, cutting each screen's opaque area out of what is still uncovered.
+	m_uncoveredAreas.assign(1, m_viewArea);
+	for(auto layer = m_layers.rbegin(); layer != m_layers.rend(); ++layer)
+	{
+		layer->isHidden = m_uncoveredAreas.empty();
+		const Rectanglei& opaqueArea = m_screens[layer->handle]->opaqueArea();
+		if(layer->isHidden || isEmpty(opaqueArea))
+		{
+			continue;
+		}
+
+		m_remainingAreas.clear();
+		for(const Rectanglei& area : m_uncoveredAreas)
+		{
+			subtract(area, opaqueArea, m_remainingAreas);
+		}
+		std::swap(m_uncoveredAreas, m_remainingAreas);
 	}
 }
 
@@ -5,11 +5,13 @@
 #include <memory>
 #include <string>
 #include <deque>
+#include <vector>
 
 #include "Framework/Screen.h"
 
 namespace rf
 {
+class TileGridBatch;
 
 /**
  * @brief Manages the updating and rendering of Screen objects.
@@ -18,6 +20,11 @@ namespace rf
  * which presents information on top of the active screen.
  * All Screen objects are owned by the ScreenManager and can be assumed to exist until
  * the screen manager is destroyed or RemoveScreen is called.
+ *
+ * The active screen is drawn first, followed by the overlays in z-order. Once the opaque areas
+ * of the screens above a screen cover the whole view area it is hidden: it is not drawn, and
+ * only updated if it asks to be. With a TileGridBatch set, the grids that screens submit are
+ * drawn together, with the batch flushed before any screen that draws itself.
  */
 class ScreenManager
 {
@@ -33,59 +40,79 @@ public:
 	/**
 	 * @brief Adds a new Screen.
 	 * @param screen The Screen to add.
+	 * @return The handle of the Screen, which stays valid until the Screen is removed.
 	 * @throw ObjectAlreadyExistsException A Screen with the name @a name already exists.
 	 */
-	void addScreen(std::unique_ptr<Screen> screen);
+	ScreenHandle addScreen(std::unique_ptr<Screen> screen);
+
+	///Return the handle of the screen named @a name, or invalidScreenHandle if no screen is registered with that name.
+	ScreenHandle findScreen(const std::string& name) const;
 
 	///Return true if a screen with the name @a name is registered, false otherwise.
 	bool hasScreen(const std::string& name) const;
+	///Return true if a screen with the handle @a handle is registered, false otherwise.
+	bool hasScreen(ScreenHandle handle) const;
 
 	/**
 	 * @brief Remove a registered Screen.
 	 * @param name The name of the Screen to remove.
 	 * @return A std::unique_ptr owning the removed Screen.
-	 * @throw std::out_of_range No screen is registered with the name @a name.
+	 * @throw NotFoundException No screen is registered with the name @a name.
 	 */
 	std::unique_ptr<Screen> removeScreen(const std::string& name);
+	///Same as removeScreen(), for the screen with the handle @a handle.
+	std::unique_ptr<Screen> removeScreen(ScreenHandle handle);
 
 	///Return the active screen or nullptr if there is no active screen.
 	Screen* getActiveScreen() {return m_activeScreen;}
 
-	///Return the string registered with the given name or nullptr if no screen is registerd with that name.
+	///Return the screen registered with the given name or nullptr if no screen is registerd with that name.
 	Screen* getScreen(const std::string& name);
+	///Return the screen registered with the given handle or nullptr if no screen is registerd with that handle.
+	Screen* getScreen(ScreenHandle handle);
 
 	/**
 	 * @brief Activate a screen with the given name, deactivating any previously active screen.
 	 * @details If the screen is currently the active screen, this function does nothing.
 	 * @param name The name of the screen to activate.
-	 * @throw std::out_of_range No screen is registered with the name @a name.
-	 * @throw std::runtime_error The screen is currently an overlay screen.
+	 * @throw NotFoundException No screen is registered with the name @a name.
+	 * @throw Exception The screen is currently an overlay screen.
 	 * A screen may not be both an overlay and the active screen at the same time.
 	 */
 	void activateScreen(const std::string& name);
+	///Same as activateScreen(), for the screen with the handle @a handle.
+	void activateScreen(ScreenHandle handle);
 
 	/**
 	 * @brief Make the Screen named @a name an active overlay.
 	 * @details If the screen is currently an overlay, this function does nothing.
-	 * @throw std::out_of_range No screen is registered with the name @a name.
-	 * @throw std::runtime_error The screen is currently the active screen.
+	 * @throw NotFoundException No screen is registered with the name @a name.
+	 * @throw Exception The screen is currently the active screen.
 	 * A screen may not be both an overlay and the active screen at the same time.
 	 */
 	void addOverlay(const std::string& name);
+	///Same as addOverlay(), for the screen with the handle @a handle.
+	void addOverlay(ScreenHandle handle);
 
 	///If the screen named @a name is an overlay, deactivate it, otherwise, do nothing.
 	void removeOverlay(const std::string& name);
+	///If the screen with the handle @a handle is an overlay, deactivate it, otherwise, do nothing.
+	void removeOverlay(ScreenHandle handle);
 	///Return true if the screen named @a name is an overlay, false otherwise
 	bool isOverlay(const std::string& name) const;
+	///Return true if the screen with the handle @a handle is an overlay, false otherwise
+	bool isOverlay(ScreenHandle handle) const;
 
 	/**
 	 * @brief Return the overlay position of the screen named @a name.
 	 * @details The overlay position is the index in the z-order of overlay screens.
 	 * The overlay with position = 0 is the first drawn followed by 1 and so on
 	 * until the end of the overlay stack.
-	 * @throw std::out_of_range No screen is registered with the name @a name.
+	 * @throw NotFoundException The screen named @a name is not an overlay.
 	 */
 	int getOverlayPosition(const std::string& name) const;
+	///Same as getOverlayPosition(), for the screen with the handle @a handle.
+	int getOverlayPosition(ScreenHandle handle) const;
 
 	///Return the current number of active overlays.
 	int overlayCount() const {return m_overlayStack.size();}
@@ -93,27 +120,68 @@ public:
 	/**
 	 * @brief Change the overlay position of the Screen named @a name to @a newPosition.
 	 * @details @a newPosition is clamped to the valid range of overlay positions
-	 * (0, overlayCount] and is inserted before the element currently in that position, if any.
+	 * [0, overlayCount] and is inserted before the element currently in that position, if any.
 	 * If the Screen is not an overlay before calling this function, it is inserted
 	 * as an overlay into the position specified.
 	 * @param name The name of the overlay Screen to move.
 	 * @param newPosition The position to move to.
-	 * @throw std::out_of_range No screen is registered with the name @a name.
+	 * @throw NotFoundException No screen is registered with the name @a name.
+	 * @throw Exception The screen is currently the active screen.
 	 */
 	void moveOverlay(const std::string& name, int newPosition);
+	///Same as moveOverlay(), for the screen with the handle @a handle.
+	void moveOverlay(ScreenHandle handle, int newPosition);
 
 	///Deactivate all overlay screens
 	void removeAllOverlays();
 
+	///@brief Set the area all screens draw in, which decides when a screen is hidden.
+	///@details While the area is empty, the default, no screen is hidden.
+	void setViewArea(const Rectanglei& area) {m_viewArea = area;}
+	const Rectanglei& viewArea() const {return m_viewArea;}
+
+	///Draw the tiles screens submit with Screen::submitTiles() through @a batch, or don't ask screens for tiles if nullptr.
+	void setTileBatch(TileGridBatch* batch) {m_tileBatch = batch;}
+
+	///Return true if the Screen named @a name was hidden by the screens above it in the last draw() or update().
+	bool isHidden(const std::string& name) const;
+	///Return true if the Screen with the handle @a handle was hidden by the screens above it in the last draw() or update().
+	bool isHidden(ScreenHandle handle) const;
+
 	void draw();
 	void update();
 
 protected:
-
-	std::unordered_map<std::string, std::unique_ptr<Screen>> m_screens;
+	///A screen in z-order. Screens are found by handle, so one removed during update() or draw() is skipped.
+	struct Layer
+	{
+		ScreenHandle handle;
+		bool isHidden;
+	};
+
+	///Return the handle of the screen named @a name, throwing NotFoundException if there is none.
+	ScreenHandle requireHandle(const std::string& name) const;
+	///Return the screen with the handle @a handle, throwing NotFoundException if there is none.
+	Screen* requireScreen(ScreenHandle handle) const;
+
+	///Fill m_layers with the active screen and overlays from the bottom up, and find the hidden ones.
+	void findHiddenScreens();
+
+	///Screens indexed by handle. Handles are not reused, so removed screens leave an empty slot.
+	std::vector<std::unique_ptr<Screen>> m_screens;
+	std::unordered_map<std::string, ScreenHandle> m_handles;
+	///Whether the screen with each handle is in m_overlayStack.
+	std::vector<bool> m_isOverlay;
 
 	Screen* m_activeScreen = nullptr;
 	std::deque<Screen*> m_overlayStack;
+
+	Rectanglei m_viewArea;
+	TileGridBatch* m_tileBatch = nullptr;
+	std::vector<Layer> m_layers;
+	///The parts of the view area not yet covered by opaque screens, while finding hidden screens.
+	std::vector<Rectanglei> m_uncoveredAreas;
+	std::vector<Rectanglei> m_remainingAreas;
 };
 
 }
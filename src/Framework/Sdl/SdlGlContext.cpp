@@ -30,6 +30,11 @@ void SdlGlContext::setVerticalSync(bool enabled)
 	SDL_GL_SetSwapInterval(enabled == true ? 1 : 0);
 }
 
+bool SdlGlContext::isVerticalSyncEnabled() const
+{
+	return SDL_GL_GetSwapInterval() != 0;
+}
+
 void SdlGlContext::applyContextSettings(const ContextSettings& settings)
 {
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, settings.doubleBuffered == true ? 1 : 0);
@@ -37,6 +37,8 @@ public:
 	void makeCurrent(const SdlWindow& window);
 
 	void setVerticalSync(bool enabled);
+	///Return true if the swap interval is on and display() waits for the vertical blank.
+	bool isVerticalSyncEnabled() const;
 
 	void display();
 
@@ -0,0 +1,321 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "Framework/Rectangle.h"
+#include "Framework/Vector2.h"
+
+namespace rf
+{
+
+/**
+ * @brief An index of entities by the grid cell they stand on.
+ * @details Every cell holds the head of an intrusive, doubly linked list of the entities on it, so
+ * finding, adding, removing or moving an entity is constant time. Entities are stored by value in
+ * a single vector, with removed slots kept on a free list for reuse, so there are no allocations
+ * per entity once the vector has grown.
+ *
+ * The grid is also divided into square blocks with a count of the entities in each, so area queries
+ * skip empty parts of the map a block at a time rather than a cell at a time.
+ *
+ * @a Type is what the index stores for each entity, typically a pointer or an index into the game's
+ * own entity storage. Entity ids are reused after an entity is removed.
+ */
+template<typename Type>
+class SpatialIndex
+{
+public:
+	typedef int EntityId;
+	static constexpr EntityId NoEntity = -1;
+
+	struct Move
+	{
+		EntityId entity;
+		Vector2i position;
+	};
+
+	SpatialIndex(int width, int height);
+	~SpatialIndex() = default;
+
+	SpatialIndex(const SpatialIndex&) = default;
+	SpatialIndex(SpatialIndex&&) = default;
+	SpatialIndex& operator =(const SpatialIndex&) = default;
+	SpatialIndex& operator =(SpatialIndex&&) = default;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+	///Return the number of entities in the index.
+	int size() const {return m_size;}
+
+	///Add an entity at @a position, which must be within the grid.
+	EntityId insert(const Vector2i& position, Type value);
+	void remove(EntityId entity);
+	void clear();
+
+	void move(EntityId entity, const Vector2i& position);
+	///Apply a batch of moves in order, such as every move of a turn.
+	void move(const std::vector<Move>& moves);
+
+	const Vector2i& position(EntityId entity) const {return m_entries[entity].position;}
+	Type& value(EntityId entity) {return m_entries[entity].value;}
+	const Type& value(EntityId entity) const {return m_entries[entity].value;}
+
+	bool isOccupied(int x, int y) const {return m_cells[x + y * m_width] != NoEntity;}
+	bool isOccupied(const Vector2i& position) const {return isOccupied(position.x, position.y);}
+
+	/**
+	 * @brief Return the first entity on @a position, or NoEntity.
+	 * @details The others follow with nextInCell(), most recently arrived first.
+	 */
+	EntityId firstAt(const Vector2i& position) const {return m_cells[position.x + position.y * m_width];}
+	EntityId nextInCell(EntityId entity) const {return m_entries[entity].next;}
+
+	///Call @a fn(EntityId, const Type&) for each entity on @a position.
+	template<typename FnType>
+	void forEachAt(const Vector2i& position, const FnType& fn) const;
+
+	/**
+	 * @brief Call @a fn(EntityId, const Type&) for each entity within @a area.
+	 * @details The area is clipped to the grid. Entities are visited in no particular order, and
+	 * must not be added, removed or moved by @a fn.
+	 */
+	template<typename FnType>
+	void forEachIn(const Rectanglei& area, const FnType& fn) const;
+
+	///Call @a fn(EntityId, const Type&) for each entity at a Euclidean distance of at most @a radius from @a center.
+	template<typename FnType>
+	void forEachInRadius(const Vector2i& center, int radius, const FnType& fn) const;
+
+	///Append the entities within @a area to @a entities.
+	void query(const Rectanglei& area, std::vector<EntityId>& entities) const;
+
+protected:
+	static constexpr int BlockShift = 3;
+	static constexpr int BlockSize = 1 << BlockShift;
+
+	struct Entry
+	{
+		Type value;
+		Vector2i position;
+		///The next entity in the same cell, or in the free list if the entry is unused.
+		EntityId next;
+		EntityId previous;
+		bool active;
+	};
+
+	void link(EntityId entity);
+	void unlink(EntityId entity);
+	int blockIndex(const Vector2i& position) const
+		{return (position.x >> BlockShift) + (position.y >> BlockShift) * m_blocksX;}
+
+	int m_width;
+	int m_height;
+	int m_blocksX;
+	int m_size = 0;
+
+	///The first entity on each cell.
+	std::vector<EntityId> m_cells;
+	///The number of entities in each block of cells.
+	std::vector<int> m_blockCounts;
+	std::vector<Entry> m_entries;
+	EntityId m_freeList = NoEntity;
+};
+
+template<typename Type>
+constexpr typename SpatialIndex<Type>::EntityId SpatialIndex<Type>::NoEntity;
+
+template<typename Type>
+SpatialIndex<Type>::SpatialIndex(int width, int height):
+	m_width(width), m_height(height), m_blocksX((width + BlockSize - 1) >> BlockShift),
+	m_cells(width * height, NoEntity), m_blockCounts(m_blocksX * ((height + BlockSize - 1) >> BlockShift), 0)
+{
+}
+
+template<typename Type>
+typename SpatialIndex<Type>::EntityId SpatialIndex<Type>::insert(const Vector2i& position, Type value)
+{
+	assert(position.x >= 0 && position.y >= 0 && position.x < m_width && position.y < m_height);
+
+	EntityId entity = m_freeList;
+	if(entity != NoEntity)
+	{
+		m_freeList = m_entries[entity].next;
+		m_entries[entity] = Entry{std::move(value), position, NoEntity, NoEntity, true};
+	}
+	else
+	{
+		entity = static_cast<EntityId>(m_entries.size());
+		m_entries.push_back(Entry{std::move(value), position, NoEntity, NoEntity, true});
+	}
+
+	link(entity);
+	++m_size;
+	return entity;
+}
+
+template<typename Type>
+void SpatialIndex<Type>::remove(EntityId entity)
+{
+	assert(m_entries[entity].active);
+
+	unlink(entity);
+	Entry& entry = m_entries[entity];
+	entry.active = false;
+	entry.next = m_freeList;
+	m_freeList = entity;
+	--m_size;
+}
+
+template<typename Type>
+void SpatialIndex<Type>::clear()
+{
+	std::fill(m_cells.begin(), m_cells.end(), NoEntity);
+	std::fill(m_blockCounts.begin(), m_blockCounts.end(), 0);
+	m_entries.clear();
+	m_freeList = NoEntity;
+	m_size = 0;
+}
+
+template<typename Type>
+void SpatialIndex<Type>::move(EntityId entity, const Vector2i& position)
+{
+	assert(m_entries[entity].active);
+	assert(position.x >= 0 && position.y >= 0 && position.x < m_width && position.y < m_height);
+
+	if(m_entries[entity].position == position)
+	{
+		return;
+	}
+	unlink(entity);
+	m_entries[entity].position = position;
+	link(entity);
+}
+
+template<typename Type>
+void SpatialIndex<Type>::move(const std::vector<Move>& moves)
+{
+	for(const Move& entityMove : moves)
+	{
+		move(entityMove.entity, entityMove.position);
+	}
+}
+
+template<typename Type>
+template<typename FnType>
+void SpatialIndex<Type>::forEachAt(const Vector2i& position, const FnType& fn) const
+{
+	for(EntityId entity = firstAt(position); entity != NoEntity; entity = m_entries[entity].next)
+	{
+		fn(entity, m_entries[entity].value);
+	}
+}
+
+template<typename Type>
+template<typename FnType>
+void SpatialIndex<Type>::forEachIn(const Rectanglei& area, const FnType& fn) const
+{
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), m_width);
+	int top = std::min(area.top(), m_height);
+	if(left >= right || bottom >= top)
+	{
+		return;
+	}
+
+	for(int blockY = bottom >> BlockShift; blockY <= (top - 1) >> BlockShift; ++blockY)
+	{
+		for(int blockX = left >> BlockShift; blockX <= (right - 1) >> BlockShift; ++blockX)
+		{
+			if(m_blockCounts[blockX + blockY * m_blocksX] == 0)
+			{
+				continue;
+			}
+
+			int cellLeft = std::max(blockX << BlockShift, left);
+			int cellRight = std::min((blockX + 1) << BlockShift, right);
+			int cellBottom = std::max(blockY << BlockShift, bottom);
+			int cellTop = std::min((blockY + 1) << BlockShift, top);
+			for(int y = cellBottom; y < cellTop; ++y)
+			{
+				const EntityId* row = &m_cells[y * m_width];
+				for(int x = cellLeft; x < cellRight; ++x)
+				{
+					for(EntityId entity = row[x]; entity != NoEntity; entity = m_entries[entity].next)
+					{
+						fn(entity, m_entries[entity].value);
+					}
+				}
+			}
+		}
+	}
+}
+
+template<typename Type>
+template<typename FnType>
+void SpatialIndex<Type>::forEachInRadius(const Vector2i& center, int radius, const FnType& fn) const
+{
+	int radiusSquared = radius * radius;
+	forEachIn(Rectanglei(center.x - radius, center.y - radius, 2 * radius + 1, 2 * radius + 1),
+		[&](EntityId entity, const Type& value)
+		{
+			const Vector2i& position = m_entries[entity].position;
+			int dx = position.x - center.x;
+			int dy = position.y - center.y;
+			if(dx * dx + dy * dy <= radiusSquared)
+			{
+				fn(entity, value);
+			}
+		});
+}
+
+template<typename Type>
+void SpatialIndex<Type>::query(const Rectanglei& area, std::vector<EntityId>& entities) const
+{
+	forEachIn(area,
+		[&entities](EntityId entity, const Type&)
+		{
+			entities.push_back(entity);
+		});
+}
+
+template<typename Type>
+void SpatialIndex<Type>::link(EntityId entity)
+{
+	Entry& entry = m_entries[entity];
+	EntityId& head = m_cells[entry.position.x + entry.position.y * m_width];
+	entry.previous = NoEntity;
+	entry.next = head;
+	if(head != NoEntity)
+	{
+		m_entries[head].previous = entity;
+	}
+	head = entity;
+	++m_blockCounts[blockIndex(entry.position)];
+}
+
+template<typename Type>
+void SpatialIndex<Type>::unlink(EntityId entity)
+{
+	Entry& entry = m_entries[entity];
+	if(entry.previous != NoEntity)
+	{
+		m_entries[entry.previous].next = entry.next;
+	}
+	else
+	{
+		m_cells[entry.position.x + entry.position.y * m_width] = entry.next;
+	}
+	if(entry.next != NoEntity)
+	{
+		m_entries[entry.next].previous = entry.previous;
+	}
+	--m_blockCounts[blockIndex(entry.position)];
+}
+
+}
+
+#endif
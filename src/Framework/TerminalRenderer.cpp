@@ -0,0 +1,365 @@
+#include "Framework/TerminalRenderer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Framework/Exceptions/FileIoException.h"
+
+namespace rf
+{
+
+namespace
+{
+
+const char* const escape = "\x1b[";
+
+///The standard xterm colors of the first 16 palette entries.
+const uint8_t systemColors[16][3] =
+{
+	{0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0}, {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+	{127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0}, {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}
+};
+const uint8_t cubeLevels[6] = {0, 95, 135, 175, 215, 255};
+
+inline void appendNumber(int value, std::string& output)
+{
+	char digits[12];
+	int count = 0;
+	do
+	{
+		digits[count++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while(value > 0);
+	while(count > 0)
+	{
+		output += digits[--count];
+	}
+}
+
+inline int digitCount(int value)
+{
+	int count = 1;
+	while(value >= 10)
+	{
+		value /= 10;
+		++count;
+	}
+	return count;
+}
+
+///Return the index of the color cube level closest to @a value.
+inline int cubeLevel(int value)
+{
+	return value < 48 ? 0 : value < 115 ? 1 : (value - 35) / 40;
+}
+
+inline int distanceSquared(const Color& a, const Color& b)
+{
+	int red = a.red - b.red;
+	int green = a.green - b.green;
+	int blue = a.blue - b.blue;
+	return red * red + green * green + blue * blue;
+}
+
+long writeDescriptor(int fileDescriptor, const char* data, size_t size)
+{
+#if defined(_WIN32)
+	return ::_write(fileDescriptor, data, static_cast<unsigned int>(size));
+#else
+	return ::write(fileDescriptor, data, size);
+#endif
+}
+
+}
+
+TerminalRenderer::TerminalRenderer(const TileGrid* grid, int fileDescriptor, ColorMode colorMode):
+	m_grid(grid), m_fileDescriptor(fileDescriptor), m_colorMode(colorMode)
+{
+}
+
+void TerminalRenderer::render()
+{
+	m_output.clear();
+	render(m_output);
+	if(m_output.empty())
+	{
+		return;
+	}
+
+	//A partial write only happens on a full pipe or socket, and then the rest follows in order.
+	size_t written = 0;
+	while(written < m_output.size())
+	{
+		long count = writeDescriptor(m_fileDescriptor, m_output.data() + written, m_output.size() - written);
+		if(count < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			throw FileIoException("file descriptor " + std::to_string(m_fileDescriptor), std::strerror(errno));
+		}
+		written += static_cast<size_t>(count);
+	}
+}
+
+void TerminalRenderer::render(std::string& output)
+{
+	const int width = m_grid->width();
+	const int height = m_grid->height();
+	if(width != m_lastFrame.width() || height != m_lastFrame.height())
+	{
+		m_lastFrame = TileGrid(width, height);
+		invalidate();
+	}
+
+	bool redraw = m_needsRedraw;
+	if(redraw)
+	{
+		//Hide the cursor so it doesn't flicker across the screen while cells are drawn.
+		output += escape;
+		output += "?25l";
+		//Erase with the default colors, so nothing of a larger earlier frame is left beside the grid.
+		output += escape;
+		output += "0m";
+		output += escape;
+		output += "2J";
+	}
+
+	for(int y = 0; y < height; ++y)
+	{
+		const Tile* row = m_grid->data() + static_cast<size_t>(y) * width;
+		Tile* lastRow = m_lastFrame.data() + static_cast<size_t>(y) * width;
+		if(!redraw && std::memcmp(static_cast<const void*>(row), static_cast<const void*>(lastRow), width * sizeof(Tile)) == 0)
+		{
+			continue;
+		}
+
+		int line = y + 1;
+		for(int x = 0; x < width; ++x)
+		{
+			if(!redraw && row[x] == lastRow[x])
+			{
+				continue;
+			}
+			moveCursor(line, x + 1, output);
+			setColors(row[x].foregroundColor(), row[x].backgroundColor(), output);
+			appendGlyph(row[x].tileIndex(), output);
+			lastRow[x] = row[x];
+			++m_cursorColumn;
+		}
+		//After the last column the cursor may be waiting to wrap, so its position is unknown.
+		if(m_cursorColumn > width)
+		{
+			m_cursorColumn = 0;
+		}
+	}
+	m_needsRedraw = false;
+}
+
+void TerminalRenderer::setGrid(const TileGrid* grid)
+{
+	m_grid = grid;
+}
+
+void TerminalRenderer::setColorMode(ColorMode colorMode)
+{
+	m_colorMode = colorMode;
+	invalidate();
+}
+
+void TerminalRenderer::setCodePointMapping(std::function<uint32_t (unsigned int)> mapping)
+{
+	m_codePointMapping = std::move(mapping);
+	invalidate();
+}
+
+void TerminalRenderer::invalidate()
+{
+	m_needsRedraw = true;
+	m_cursorLine = 0;
+	m_cursorColumn = 0;
+	m_hasColors = false;
+}
+
+std::string TerminalRenderer::restoreSequence() const
+{
+	std::string output = escape;
+	output += "0m";
+	output += escape;
+	appendNumber(m_grid->height() + 1, output);
+	output += ";1H";
+	output += escape;
+	output += "?25h";
+	return output;
+}
+
+Color TerminalRenderer::paletteColor(int index)
+{
+	if(index < 16)
+	{
+		return Color(systemColors[index][0], systemColors[index][1], systemColors[index][2]);
+	}
+	if(index < 232)
+	{
+		index -= 16;
+		return Color(cubeLevels[index / 36], cubeLevels[index / 6 % 6], cubeLevels[index % 6]);
+	}
+	uint8_t gray = static_cast<uint8_t>(8 + 10 * (index - 232));
+	return Color(gray, gray, gray);
+}
+
+int TerminalRenderer::closestPaletteIndex(const Color& color)
+{
+	//The 16 system colors are left out since terminals often redefine them.
+	int cubeIndex = 16 + 36 * cubeLevel(color.red) + 6 * cubeLevel(color.green) + cubeLevel(color.blue);
+
+	int average = (color.red + color.green + color.blue) / 3;
+	int grayIndex = average > 238 ? 255 : 232 + std::max(0, (average - 3) / 10);
+
+	return distanceSquared(color, paletteColor(grayIndex)) < distanceSquared(color, paletteColor(cubeIndex)) ?
+			grayIndex : cubeIndex;
+}
+
+void TerminalRenderer::moveCursor(int line, int column, std::string& output)
+{
+	if(line == m_cursorLine && column == m_cursorColumn)
+	{
+		return;
+	}
+
+	//Use whichever of an absolute move, a move right or a new line is shortest.
+	int absoluteLength = 4 + digitCount(line) + digitCount(column);
+	if(line == m_cursorLine && m_cursorColumn > 0 && column > m_cursorColumn)
+	{
+		int distance = column - m_cursorColumn;
+		int forwardLength = distance == 1 ? 3 : 3 + digitCount(distance);
+		if(forwardLength < absoluteLength)
+		{
+			output += escape;
+			if(distance > 1)
+			{
+				appendNumber(distance, output);
+			}
+			output += 'C';
+			m_cursorColumn = column;
+			return;
+		}
+	}
+	else if(m_cursorLine > 0 && line == m_cursorLine + 1 && column == 1)
+	{
+		output += "\r\n";
+		m_cursorLine = line;
+		m_cursorColumn = column;
+		return;
+	}
+
+	output += escape;
+	appendNumber(line, output);
+	output += ';';
+	appendNumber(column, output);
+	output += 'H';
+	m_cursorLine = line;
+	m_cursorColumn = column;
+}
+
+void TerminalRenderer::setColors(const Color& foreground, const Color& background, std::string& output)
+{
+	//Compare the colors as the terminal will show them, so colors that map to the same palette
+	//entry don't cause redundant sequences.
+	Color shownForeground(foreground.red, foreground.green, foreground.blue);
+	Color shownBackground(background.red, background.green, background.blue);
+	if(m_colorMode == ColorMode::Palette256)
+	{
+		shownForeground = paletteColor(closestPaletteIndex(shownForeground));
+		shownBackground = paletteColor(closestPaletteIndex(shownBackground));
+	}
+
+	bool foregroundChanged = !m_hasColors || shownForeground != m_foreground;
+	bool backgroundChanged = !m_hasColors || shownBackground != m_background;
+	if(!foregroundChanged && !backgroundChanged)
+	{
+		return;
+	}
+
+	output += escape;
+	if(foregroundChanged)
+	{
+		appendColor(shownForeground, true, output);
+	}
+	if(backgroundChanged)
+	{
+		if(foregroundChanged)
+		{
+			output += ';';
+		}
+		appendColor(shownBackground, false, output);
+	}
+	output += 'm';
+
+	m_foreground = shownForeground;
+	m_background = shownBackground;
+	m_hasColors = true;
+}
+
+void TerminalRenderer::appendColor(const Color& color, bool isForeground, std::string& output)
+{
+	output += isForeground ? "38;" : "48;";
+	if(m_colorMode == ColorMode::Palette256)
+	{
+		output += "5;";
+		appendNumber(closestPaletteIndex(color), output);
+		return;
+	}
+
+	output += "2;";
+	appendNumber(color.red, output);
+	output += ';';
+	appendNumber(color.green, output);
+	output += ';';
+	appendNumber(color.blue, output);
+}
+
+void TerminalRenderer::appendGlyph(unsigned int tileIndex, std::string& output)
+{
+	uint32_t codePoint = m_codePointMapping ? m_codePointMapping(tileIndex) : tileIndex;
+
+	//Control characters and invalid code points would corrupt the terminal's state.
+	if(codePoint < 0x20 || (codePoint >= 0x7F && codePoint < 0xA0) || (codePoint >= 0xD800 && codePoint < 0xE000) ||
+			codePoint > 0x10FFFF)
+	{
+		codePoint = ' ';
+	}
+
+	if(codePoint < 0x80)
+	{
+		output += static_cast<char>(codePoint);
+	}
+	else if(codePoint < 0x800)
+	{
+		output += static_cast<char>(0xC0 | (codePoint >> 6));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else if(codePoint < 0x10000)
+	{
+		output += static_cast<char>(0xE0 | (codePoint >> 12));
+		output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+	else
+	{
+		output += static_cast<char>(0xF0 | (codePoint >> 18));
+		output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+		output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+}
+
+}
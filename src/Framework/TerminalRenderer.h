@@ -0,0 +1,101 @@
+#ifndef TERMINALRENDERER_H_
+#define TERMINALRENDERER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief Draws a TileGrid on an ANSI/VT terminal, for play over SSH and headless servers.
+ * @details The renderer keeps the last frame it drew and on each render() emits only what changed:
+ * a cursor move where the next changed cell isn't under the cursor, an SGR sequence where the
+ * colors differ from the current ones, and the glyph as UTF-8. A frame goes out in a single
+ * write() where the descriptor allows it.
+ *
+ * Tile indices are taken to be Unicode code points, as they are with TextTileSet; other tile sets
+ * can translate them with setCodePointMapping(). Every glyph is assumed to be one column wide.
+ * Row 0 of the grid is drawn on the first line, matching the top-down layout of the glyph bitmaps.
+ */
+class TerminalRenderer
+{
+public:
+	enum class ColorMode
+	{
+		///24-bit SGR colors, supported by most modern terminals.
+		TrueColor,
+		///The xterm 256-color palette, for terminals without truecolor support.
+		Palette256
+	};
+
+	///Draw @a grid to the file descriptor @a fileDescriptor, standard output by default.
+	explicit TerminalRenderer(const TileGrid* grid, int fileDescriptor = 1, ColorMode colorMode = ColorMode::TrueColor);
+	~TerminalRenderer() = default;
+
+	TerminalRenderer(const TerminalRenderer&) = delete;
+	TerminalRenderer(TerminalRenderer&&) = default;
+	TerminalRenderer& operator =(const TerminalRenderer&) = delete;
+	TerminalRenderer& operator =(TerminalRenderer&&) = default;
+
+	///Write the changes since the last frame to the file descriptor.
+	///@throw FileIoException if writing fails.
+	void render();
+
+	///Append the changes since the last frame to @a output instead of writing them, such as to send them over a socket.
+	void render(std::string& output);
+
+	///@brief Draw a different grid from now on.
+	///@details The next frame is diffed against the last one drawn, so switching between snapshots is cheap.
+	void setGrid(const TileGrid* grid);
+	const TileGrid* getGrid() const {return m_grid;}
+
+	void setColorMode(ColorMode colorMode);
+	ColorMode getColorMode() const {return m_colorMode;}
+
+	void setCodePointMapping(std::function<uint32_t (unsigned int)> mapping);
+
+	///@brief Clear the terminal and redraw every cell on the next frame, such as after the terminal was resized.
+	///@details This also happens when the size of the grid changes.
+	void invalidate();
+
+	///Return the sequence that resets the colors, shows the cursor and moves it below the grid.
+	std::string restoreSequence() const;
+
+	///Return the RGB color the xterm 256-color palette entry @a index stands for.
+	static Color paletteColor(int index);
+	///Return the xterm 256-color palette entry closest to @a color.
+	static int closestPaletteIndex(const Color& color);
+
+protected:
+	void moveCursor(int line, int column, std::string& output);
+	void setColors(const Color& foreground, const Color& background, std::string& output);
+	void appendColor(const Color& color, bool isForeground, std::string& output);
+	void appendGlyph(unsigned int tileIndex, std::string& output);
+
+	const TileGrid* m_grid;
+	int m_fileDescriptor;
+	ColorMode m_colorMode;
+	std::function<uint32_t (unsigned int)> m_codePointMapping;
+
+	///The cells as last drawn, in the same layout as the grid.
+	TileGrid m_lastFrame = TileGrid(0, 0);
+	bool m_needsRedraw = true;
+
+	///Where the terminal's cursor is, 1-based, or 0 if unknown.
+	int m_cursorLine = 0;
+	int m_cursorColumn = 0;
+	///The colors the terminal is drawing with, valid when m_hasColors is true.
+	Color m_foreground;
+	Color m_background;
+	bool m_hasColors = false;
+
+	std::string m_output;
+};
+
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef TILE_H_
 #define TILE_H_
 
+#include <type_traits>
+#include <cstddef>
+
 #include "Framework/Color.h"
 
 namespace rf
@@ -13,10 +16,18 @@ public:
 	Tile(const Color& foregroundColor, const Color& backgroundColor, unsigned int tileIndex);
 	~Tile() = default;
 
-	Tile(const Tile& other);
-	Tile(Tile&& other) noexcept;
-	Tile& operator =(const Tile& other);
-	Tile& operator =(Tile&& other) noexcept;
+	Tile(const Tile& other) = default;
+	Tile(Tile&& other) noexcept = default;
+	Tile& operator =(const Tile& other) = default;
+	Tile& operator =(Tile&& other) noexcept = default;
+
+	bool operator ==(const Tile& tile) const
+	{
+		return m_tileIndex == tile.m_tileIndex && m_foregroundColor == tile.m_foregroundColor &&
+				m_backgroundColor == tile.m_backgroundColor;
+	}
+	bool operator !=(const Tile& tile) const
+		{return !(*this == tile);}
 
 	const Color& foregroundColor() const {return m_foregroundColor;}
 	const Color& backgroundColor() const {return m_backgroundColor;}
@@ -26,40 +37,22 @@ public:
 	Tile& setBackgroundColor(const Color& color) {m_backgroundColor = color; return *this;}
 	Tile& setTileIndex(unsigned int index) {m_tileIndex = index; return *this;}
 
+	///Return the byte offset of the foreground color within a Tile, for bulk row operations.
+	static constexpr size_t foregroundColorOffset() {return offsetof(Tile, m_foregroundColor);}
+	///Return the byte offset of the background color within a Tile, for bulk row operations.
+	static constexpr size_t backgroundColorOffset() {return offsetof(Tile, m_backgroundColor);}
+	///Return the byte offset of the tile index within a Tile, for bulk row operations.
+	static constexpr size_t tileIndexOffset() {return offsetof(Tile, m_tileIndex);}
+
 protected:
 	Color m_foregroundColor = Color::white();
 	Color m_backgroundColor = Color::black();
 	unsigned int m_tileIndex = ' ';
 };
 
-inline Tile::Tile(const Tile& other):
-	m_foregroundColor(other.m_foregroundColor), m_backgroundColor(other.m_backgroundColor),
-	m_tileIndex(other.m_tileIndex)
-{
-}
-
-inline Tile::Tile(Tile&& other) noexcept:
-	m_foregroundColor(other.m_foregroundColor), m_backgroundColor(other.m_backgroundColor),
-	m_tileIndex(other.m_tileIndex)
-{
-}
-
-inline Tile& Tile::operator =(const Tile& other)
-{
-	m_foregroundColor = other.m_foregroundColor;
-	m_backgroundColor = other.m_backgroundColor;
-	m_tileIndex = other.m_tileIndex;
-	return *this;
-}
-
-inline Tile& Tile::operator =(Tile&& other) noexcept
-{
-	m_foregroundColor = other.m_foregroundColor;
-	m_backgroundColor = other.m_backgroundColor;
-	m_tileIndex = other.m_tileIndex;
-	return *this;
-}
-
+static_assert(std::is_trivially_copyable<Tile>::value,
+		"Tile must stay trivially copyable so grids of them can be copied with memcpy");
+static_assert(sizeof(Tile) == 12, "Tile is expected to pack into 12 bytes");
 
 }
 
@@ -0,0 +1,169 @@
+#include "Framework/TileBlit.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Framework/TileGridView.h"
+#include "Framework/Colorf.h"
+
+namespace rf
+{
+
+namespace
+{
+
+Color blendColor(const Color& source, const Color& destination)
+{
+	if(source.alpha == 255)
+	{
+		return source;
+	}
+	else if(source.alpha == 0)
+	{
+		return destination;
+	}
+	return Color(Colorf::alphaBlend(Colorf(source), Colorf(destination)));
+}
+
+///Copy the channels selected by the flags of @a count tiles, skipping those rejected by @a isVisible.
+template<typename VisibilityFn>
+void copyChannels(const Tile* source, Tile* destination, int count, bool copyIndex,
+		bool copyForeground, bool copyBackground, const VisibilityFn& isVisible)
+{
+	for(int i = 0; i < count; ++i)
+	{
+		const Tile& from = source[i];
+		if(!isVisible(from))
+		{
+			continue;
+		}
+		Tile& to = destination[i];
+		if(copyIndex)
+		{
+			to.setTileIndex(from.tileIndex());
+		}
+		if(copyForeground)
+		{
+			to.setForegroundColor(from.foregroundColor());
+		}
+		if(copyBackground)
+		{
+			to.setBackgroundColor(from.backgroundColor());
+		}
+	}
+}
+
+void blendChannels(const Tile* source, Tile* destination, int count, bool copyIndex,
+		bool blendForeground, bool blendBackground)
+{
+	for(int i = 0; i < count; ++i)
+	{
+		const Tile& from = source[i];
+		Tile& to = destination[i];
+		if(copyIndex && from.foregroundColor().alpha != 0)
+		{
+			to.setTileIndex(from.tileIndex());
+		}
+		if(blendForeground)
+		{
+			to.setForegroundColor(blendColor(from.foregroundColor(), to.foregroundColor()));
+		}
+		if(blendBackground)
+		{
+			to.setBackgroundColor(blendColor(from.backgroundColor(), to.backgroundColor()));
+		}
+	}
+}
+
+}
+
+BlitMask BlitMask::copy(const Flags<TileChannel>& channels)
+{
+	BlitMask mask;
+	mask.channels = channels;
+	return mask;
+}
+
+BlitMask BlitMask::tileIndexKey(unsigned int transparentIndex)
+{
+	BlitMask mask;
+	mask.mode = Mode::TileIndexKey;
+	mask.transparentTileIndex = transparentIndex;
+	return mask;
+}
+
+BlitMask BlitMask::backgroundColorKey(const Color& transparentColor)
+{
+	BlitMask mask;
+	mask.mode = Mode::BackgroundColorKey;
+	mask.transparentColor = transparentColor;
+	return mask;
+}
+
+BlitMask BlitMask::alphaBlend()
+{
+	BlitMask mask;
+	mask.mode = Mode::AlphaBlend;
+	return mask;
+}
+
+void blit(const TileGridView& source, TileGridView& destination, const Vector2i& offset,
+		const BlitMask& mask)
+{
+	bool copyIndex = mask.channels.hasFlag(TileChannel::TileIndex);
+	bool copyForeground = mask.channels.hasFlag(TileChannel::ForegroundColor);
+	bool copyBackground = mask.channels.hasFlag(TileChannel::BackgroundColor);
+
+	if(mask.mode == BlitMask::Mode::Copy && copyIndex && copyForeground && copyBackground)
+	{
+		destination.blit(source, offset);
+		return;
+	}
+
+	int left = std::max(offset.x, 0);
+	int bottom = std::max(offset.y, 0);
+	int right = std::min(offset.x + source.width(), destination.width());
+	int top = std::min(offset.y + source.height(), destination.height());
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+	int width = right - left;
+	int sourceX = left - offset.x;
+
+	for(int y = bottom; y < top; ++y)
+	{
+		const Tile* from = source.rowBegin(y - offset.y) + sourceX;
+		Tile* to = destination.rowBegin(y) + left;
+
+		switch(mask.mode)
+		{
+		case BlitMask::Mode::Copy:
+			copyChannels(from, to, width, copyIndex, copyForeground, copyBackground,
+				[](const Tile&)
+				{
+					return true;
+				});
+			break;
+		case BlitMask::Mode::TileIndexKey:
+			copyChannels(from, to, width, copyIndex, copyForeground, copyBackground,
+				[&mask](const Tile& tile)
+				{
+					return tile.tileIndex() != mask.transparentTileIndex;
+				});
+			break;
+		case BlitMask::Mode::BackgroundColorKey:
+			copyChannels(from, to, width, copyIndex, copyForeground, copyBackground,
+				[&mask](const Tile& tile)
+				{
+					return tile.backgroundColor() != mask.transparentColor;
+				});
+			break;
+		case BlitMask::Mode::AlphaBlend:
+			blendChannels(from, to, width, copyIndex, copyForeground, copyBackground);
+			break;
+		}
+	}
+}
+
+}
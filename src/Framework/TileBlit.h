@@ -0,0 +1,68 @@
+#ifndef TILEBLIT_H_
+#define TILEBLIT_H_
+
+#include "Framework/Flags.h"
+#include "Framework/Color.h"
+#include "Framework/Vector2.h"
+
+namespace rf
+{
+class TileGridView;
+
+///The separately copyable parts of a Tile.
+enum class TileChannel
+{
+	TileIndex = 0x1,
+	ForegroundColor = 0x2,
+	BackgroundColor = 0x4
+};
+
+/**
+ * @brief Controls which parts of the source tiles blit() writes and how they are combined
+ * with the destination.
+ */
+struct BlitMask
+{
+	enum class Mode
+	{
+		///Copy the selected channels of every source tile.
+		Copy,
+		///Copy the selected channels of source tiles whose tile index is not transparentTileIndex.
+		TileIndexKey,
+		///Copy the selected channels of source tiles whose background is not transparentColor.
+		BackgroundColorKey,
+		///Blend the selected color channels over the destination with Colorf::alphaBlend,
+		///and copy the tile index, if selected, of source tiles with a non-transparent foreground.
+		AlphaBlend
+	};
+
+	Flags<TileChannel> channels = {TileChannel::TileIndex, TileChannel::ForegroundColor,
+			TileChannel::BackgroundColor};
+	Mode mode = Mode::Copy;
+	unsigned int transparentTileIndex = 0;
+	Color transparentColor = Color(0, 0, 0, 0);
+
+	///Return a mask that copies @a channels of every tile.
+	static BlitMask copy(const Flags<TileChannel>& channels = {TileChannel::TileIndex,
+			TileChannel::ForegroundColor, TileChannel::BackgroundColor});
+	///Return a mask that skips source tiles with the tile index @a transparentIndex.
+	static BlitMask tileIndexKey(unsigned int transparentIndex);
+	///Return a mask that skips source tiles with the background color @a transparentColor.
+	static BlitMask backgroundColorKey(const Color& transparentColor);
+	///Return a mask that alpha blends source colors over the destination.
+	static BlitMask alphaBlend();
+};
+
+/**
+ * @brief Combine the tiles of @a source into @a destination with the bottom-left corner of
+ * @a source at @a offset within @a destination.
+ * @details The source rectangle is clipped against the destination once, after which each row
+ * is processed in a single loop. A plain copy of every channel reduces to one memmove per row
+ * and may be used with overlapping views; all other masks require that the views do not overlap.
+ */
+void blit(const TileGridView& source, TileGridView& destination, const Vector2i& offset,
+		const BlitMask& mask = BlitMask());
+
+}
+
+#endif
@@ -11,17 +11,21 @@ TileGrid::TileGrid(int width, int height):
 }
 
 TileGrid::TileGrid(const TileGrid& other):
+	m_defaultState(other.m_defaultState), m_clearState(other.m_clearState),
 	m_width(other.m_width), m_height(other.m_height), m_tiles(other.m_tiles)
 {
 }
 
 TileGrid::TileGrid(TileGrid&& other) noexcept:
+	m_defaultState(other.m_defaultState), m_clearState(other.m_clearState),
 	m_width(other.m_width), m_height(other.m_height), m_tiles(std::move(other.m_tiles))
 {
 }
 
 TileGrid& TileGrid::operator =(const TileGrid& other)
 {
+	m_defaultState = other.m_defaultState;
+	m_clearState = other.m_clearState;
 	m_width = other.m_width;
 	m_height = other.m_height;
 	m_tiles = other.m_tiles;
@@ -30,6 +34,8 @@ TileGrid& TileGrid::operator =(const TileGrid& other)
 
 TileGrid& TileGrid::operator =(TileGrid&& other) noexcept
 {
+	m_defaultState = other.m_defaultState;
+	m_clearState = other.m_clearState;
 	m_width = other.m_width;
 	m_height = other.m_height;
 	m_tiles = std::move(other.m_tiles);
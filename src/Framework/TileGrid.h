@@ -53,6 +53,10 @@ public:
 	void setTile(size_t index, const Tile& tile) {m_tiles[index] = tile;}
 	void setTile(int x, int y, const Tile& tile) {m_tiles[x + m_width * y] = tile;}
 
+	///Return the tiles of the grid, stored contiguously row by row starting at y = 0.
+	Tile* data() {return m_tiles.data();}
+	const Tile* data() const {return m_tiles.data();}
+
 protected:
 
 	Tile m_defaultState;
@@ -0,0 +1,139 @@
+#include "Framework/TileGridBatch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "Framework/Gl/ShaderProgram.h"
+#include "Framework/TileSet.h"
+
+namespace rf
+{
+
+constexpr int TileGridBatch::verticesPerTile;
+
+TileGridBatch::TileGridBatch(std::shared_ptr<gl::ShaderProgram> shader, gl::Context* context,
+		const Matrix3f& transform):
+	m_context(context), m_shader(std::move(shader)), m_projectionTransform(transform),
+	m_vao(context),
+	m_vertexBuffer(gl::VertexBufferObject::UsageType::StreamDraw, context),
+	m_indexBuffer(gl::BufferObject::UsageType::StaticDraw, gl::IndexBufferObject::IndexFormat::UInt, context)
+{
+	createVertexArrayObject();
+}
+
+void TileGridBatch::add(const TileGrid& grid, TileSet* tileSet, const Vector2i& location)
+{
+	if(tileSet != m_tileSet)
+	{
+		flush();
+		m_tileSet = tileSet;
+	}
+
+	const int tileWidth = tileSet->tileWidth();
+	const int tileHeight = tileSet->tileHeight();
+	size_t first = m_vertices.size();
+	m_vertices.resize(first + static_cast<size_t>(grid.width()) * grid.height() * verticesPerTile);
+
+	Vertex* vertices = m_vertices.data() + first;
+	for(int y = 0; y < grid.height(); ++y)
+	{
+		float bottom = static_cast<float>(location.y + y * tileHeight);
+		float top = bottom + tileHeight;
+		for(int x = 0; x < grid.width(); ++x)
+		{
+			const Tile& tile = grid.getTile(x, y);
+			TileSet::TileLocation loc = tileSet->getTileLocation(tile.tileIndex());
+			float left = static_cast<float>(location.x + x * tileWidth);
+			float right = left + tileWidth;
+
+			//The same corners and texture coordinates as TileGridRenderer uses.
+			const float corners[verticesPerTile][4] =
+			{
+				{left, bottom, loc.bottomLeft.x, loc.bottomLeft.y},
+				{left, top, loc.bottomLeft.x, loc.topRight.y},
+				{right, top, loc.topRight.x, loc.topRight.y},
+				{right, bottom, loc.topRight.x, loc.bottomLeft.y}
+			};
+			uint32_t fgColor = tile.foregroundColor().toRgbaEndianAware();
+			uint32_t bgColor = tile.backgroundColor().toRgbaEndianAware();
+			for(int i = 0; i < verticesPerTile; ++i)
+			{
+				vertices[i] = {corners[i][0], corners[i][1], corners[i][2], corners[i][3],
+						static_cast<float>(loc.layer), fgColor, bgColor};
+			}
+			vertices += verticesPerTile;
+			m_texture = loc.texture;
+		}
+	}
+}
+
+void TileGridBatch::flush()
+{
+	if(m_vertices.empty())
+	{
+		return;
+	}
+
+	//The element array binding belongs to the bound VAO, so bind ours before touching the index
+	//buffer, or whichever VAO a renderer left bound would be pointed at it.
+	size_t tileCount = queuedTileCount();
+	m_vao.bind();
+	m_vertexBuffer.bind();
+	m_vertexBuffer.setData(m_vertices);
+	reserveIndices(tileCount);
+
+	m_context->setActiveTextureUnit(0);
+	m_texture->bind();
+
+	m_shader->bind();
+	m_shader->setUniformValue("transform", m_projectionTransform);
+	m_shader->setUniformValue("texSampler", 0);
+	m_context->drawIndexedPrimitives(gl::PrimitiveType::Triangles, static_cast<int>(6 * tileCount),
+			gl::IndexFormat::UInt, 0);
+
+	++m_drawCallCount;
+	m_vertices.clear();
+}
+
+void TileGridBatch::reserveIndices(size_t tileCount)
+{
+	if(tileCount <= m_indexedTileCount)
+	{
+		return;
+	}
+
+	//Grow geometrically so a growing batch doesn't rebuild the indices every frame.
+	size_t newCount = std::max(tileCount, m_indexedTileCount * 2);
+	std::vector<unsigned int> indices(newCount * 6);
+	for(size_t tile = 0; tile < newCount; ++tile)
+	{
+		unsigned int vertex = static_cast<unsigned int>(tile * verticesPerTile);
+		unsigned int* index = &indices[tile * 6];
+		index[0] = vertex;
+		index[1] = vertex + 1;
+		index[2] = vertex + 2;
+		index[3] = vertex + 2;
+		index[4] = vertex + 3;
+		index[5] = vertex;
+	}
+	m_indexBuffer.bind();
+	m_indexBuffer.setData(indices);
+	m_indexedTileCount = newCount;
+}
+
+void TileGridBatch::createVertexArrayObject()
+{
+	m_vao.bind();
+	m_vao.attachVertexBuffer(0, 2, gl::VertexBufferObject::ComponentType::Float,
+			&m_vertexBuffer, offsetof(Vertex, x), sizeof(Vertex), false);
+	m_vao.attachVertexBuffer(1, 3, gl::VertexBufferObject::ComponentType::Float,
+			&m_vertexBuffer, offsetof(Vertex, ux), sizeof(Vertex), false);
+	m_vao.attachVertexBuffer(2, 4, gl::VertexBufferObject::ComponentType::UByte,
+			&m_vertexBuffer, offsetof(Vertex, fgColor), sizeof(Vertex), true);
+	m_vao.attachVertexBuffer(3, 4, gl::VertexBufferObject::ComponentType::UByte,
+			&m_vertexBuffer, offsetof(Vertex, bgColor), sizeof(Vertex), true);
+	m_vao.setIndexBuffer(&m_indexBuffer);
+	m_context->unbindVertexArray();
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef TILEGRIDBATCH_H_
+#define TILEGRIDBATCH_H_
+
+#include "TileGrid.h"
+
+#include <memory>
+#include <vector>
+
+#include "Framework/Gl/IndexBufferObject.h"
+#include "Framework/Gl/VertexArrayObject.h"
+#include "Framework/Gl/VertexBufferObject.h"
+#include "Framework/Matrix3.h"
+
+namespace rf
+{
+class TileSet;
+namespace gl
+{
+class ShaderProgram;
+class Texture;
+}
+
+/**
+ * @brief Draws several TileGrids that share a TileSet with one draw call.
+ * @details Grids are queued with add() and drawn in the order they were added by flush(). Adding
+ * a grid with a different TileSet flushes the grids queued before it. Unlike TileGridRenderer,
+ * nothing is kept between frames, so the batch suits small grids such as overlays that are drawn
+ * together; a large grid that is drawn on its own is better served by TileGridRenderer.
+ *
+ * Uses the shaders from TileGridRenderer::createDefaultShaders(), or ones with the same inputs.
+ */
+class TileGridBatch
+{
+public:
+	TileGridBatch(std::shared_ptr<gl::ShaderProgram> shader, gl::Context* context, const Matrix3f& transform);
+	~TileGridBatch() = default;
+
+	TileGridBatch(const TileGridBatch&) = delete;
+	TileGridBatch(TileGridBatch&&) = delete;
+	TileGridBatch& operator =(const TileGridBatch&) = delete;
+	TileGridBatch& operator =(TileGridBatch&&) = delete;
+
+	///Queue @a grid to be drawn with @a tileSet at @a location, as TileGridRenderer::render() places it.
+	void add(const TileGrid& grid, TileSet* tileSet, const Vector2i& location);
+
+	///Draw the queued grids.
+	void flush();
+
+	///Return the number of tiles waiting to be drawn.
+	size_t queuedTileCount() const {return m_vertices.size() / verticesPerTile;}
+	///Return the number of draw calls made by flush() so far.
+	int drawCallCount() const {return m_drawCallCount;}
+
+	void setTransform(const Matrix3f& transform) {m_projectionTransform = transform;}
+
+protected:
+	struct Vertex
+	{
+		float x;
+		float y;
+		float ux;
+		float uy;
+		float uz;
+
+		uint32_t fgColor;
+		uint32_t bgColor;
+	};
+
+	void createVertexArrayObject();
+	///Make the index buffer hold the indices of at least @a tileCount tiles. m_vao must be bound.
+	void reserveIndices(size_t tileCount);
+
+	gl::Context* m_context;
+	std::shared_ptr<gl::ShaderProgram> m_shader;
+	Matrix3f m_projectionTransform;
+
+	gl::VertexArrayObject m_vao;
+	gl::VertexBufferObject m_vertexBuffer;
+	gl::IndexBufferObject m_indexBuffer;
+	size_t m_indexedTileCount = 0;
+
+	TileSet* m_tileSet = nullptr;
+	///The texture holding the queued tiles; a TileSet keeps all its tiles in one texture.
+	gl::Texture* m_texture = nullptr;
+	std::vector<Vertex> m_vertices;
+	int m_drawCallCount = 0;
+
+	static constexpr int verticesPerTile = 4;
+};
+
+}
+
+#endif
@@ -0,0 +1,262 @@
+#include "Framework/TileGridCompositor.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rf
+{
+
+TileGridCompositor::TileGridCompositor(int width, int height):
+	m_output(width, height), m_dirtyRows(height)
+{
+	invalidate();
+}
+
+TileGridCompositor::LayerId TileGridCompositor::addLayer(const TileGridView& source, int zOrder,
+		const Vector2i& offset, const BlitMask& mask)
+{
+	LayerId id = m_nextLayerId++;
+	insertLayer(Layer(id, source, zOrder, offset, mask));
+	invalidate(Rectanglei(offset, source.width(), source.height()));
+	return id;
+}
+
+void TileGridCompositor::removeLayer(LayerId layer)
+{
+	auto it = findLayerIterator(layer);
+	invalidate(it->bounds());
+	m_layers.erase(it);
+}
+
+void TileGridCompositor::setLayerOffset(LayerId layer, const Vector2i& offset)
+{
+	Layer& entry = findLayer(layer);
+	if(entry.offset == offset)
+	{
+		return;
+	}
+	invalidate(entry.bounds());
+	entry.offset = offset;
+	invalidate(entry.bounds());
+}
+
+void TileGridCompositor::setLayerZOrder(LayerId layer, int zOrder)
+{
+	auto it = findLayerIterator(layer);
+	if(it->zOrder == zOrder)
+	{
+		return;
+	}
+	Layer entry = std::move(*it);
+	m_layers.erase(it);
+	entry.zOrder = zOrder;
+	invalidate(entry.bounds());
+	insertLayer(std::move(entry));
+}
+
+void TileGridCompositor::setLayerVisible(LayerId layer, bool visible)
+{
+	Layer& entry = findLayer(layer);
+	if(entry.visible != visible)
+	{
+		entry.visible = visible;
+		invalidate(entry.bounds());
+	}
+}
+
+void TileGridCompositor::setLayerMask(LayerId layer, const BlitMask& mask)
+{
+	Layer& entry = findLayer(layer);
+	entry.mask = mask;
+	invalidate(entry.bounds());
+}
+
+void TileGridCompositor::markDirty(LayerId layer)
+{
+	invalidate(findLayer(layer).bounds());
+}
+
+void TileGridCompositor::markDirty(LayerId layer, const Rectanglei& area)
+{
+	const Layer& entry = findLayer(layer);
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), entry.source.width());
+	int top = std::min(area.top(), entry.source.height());
+	if(right > left && top > bottom)
+	{
+		invalidate(Rectanglei(left + entry.offset.x, bottom + entry.offset.y, right - left, top - bottom));
+	}
+}
+
+void TileGridCompositor::invalidate(const Rectanglei& area)
+{
+	int left = std::max(area.left(), 0);
+	int bottom = std::max(area.bottom(), 0);
+	int right = std::min(area.right(), width());
+	int top = std::min(area.top(), height());
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+
+	for(int y = bottom; y < top; ++y)
+	{
+		m_dirtyRows[y].add(left, right);
+	}
+	m_isDirty = true;
+}
+
+void TileGridCompositor::setClearTile(const Tile& tile)
+{
+	if(tile != m_clearTile)
+	{
+		m_clearTile = tile;
+		invalidate();
+	}
+}
+
+void TileGridCompositor::composite()
+{
+	m_updatedRegions.clear();
+	if(!m_isDirty)
+	{
+		return;
+	}
+
+	//A span is rebuilt as a single rectangle with the same span in the rows above it, which are
+	//removed from those rows as they are taken in.
+	for(int y = 0; y < height(); ++y)
+	{
+		DirtyRow& row = m_dirtyRows[y];
+		for(int i = 0; i < row.count; ++i)
+		{
+			const DirtySpan& span = row.spans[i];
+			int runEnd = y + 1;
+			while(runEnd < height() && m_dirtyRows[runEnd].remove(span))
+			{
+				++runEnd;
+			}
+
+			Rectanglei region(span.begin, y, span.end - span.begin, runEnd - y);
+			compositeRegion(region);
+			m_updatedRegions.push_back(region);
+		}
+		row.count = 0;
+	}
+
+	m_isDirty = false;
+}
+
+void TileGridCompositor::DirtyRow::add(int begin, int end)
+{
+	DirtySpan merged{begin, end};
+	DirtySpan result[MaxDirtySpans + 1];
+	int resultCount = 0;
+
+	int i = 0;
+	for(; i < count && spans[i].end < begin; ++i)
+	{
+		result[resultCount++] = spans[i];
+	}
+	for(; i < count && spans[i].begin <= end; ++i)
+	{
+		merged.begin = std::min(merged.begin, spans[i].begin);
+		merged.end = std::max(merged.end, spans[i].end);
+	}
+	result[resultCount++] = merged;
+	for(; i < count; ++i)
+	{
+		result[resultCount++] = spans[i];
+	}
+
+	if(resultCount > MaxDirtySpans)
+	{
+		//Join the two neighbouring spans with the smallest gap between them.
+		int closest = 0;
+		for(int j = 1; j + 1 < resultCount; ++j)
+		{
+			if(result[j + 1].begin - result[j].end < result[closest + 1].begin - result[closest].end)
+			{
+				closest = j;
+			}
+		}
+		result[closest].end = result[closest + 1].end;
+		std::copy(result + closest + 2, result + resultCount, result + closest + 1);
+		--resultCount;
+	}
+
+	std::copy(result, result + resultCount, spans);
+	count = resultCount;
+}
+
+bool TileGridCompositor::DirtyRow::remove(const DirtySpan& span)
+{
+	for(int i = 0; i < count && spans[i].begin <= span.begin; ++i)
+	{
+		if(spans[i].begin == span.begin && spans[i].end == span.end)
+		{
+			std::copy(spans + i + 1, spans + count, spans + i);
+			--count;
+			return true;
+		}
+	}
+	return false;
+}
+
+TileGridCompositor::Layer& TileGridCompositor::findLayer(LayerId layer)
+{
+	return *findLayerIterator(layer);
+}
+
+std::vector<TileGridCompositor::Layer>::iterator TileGridCompositor::findLayerIterator(LayerId layer)
+{
+	auto it = std::find_if(m_layers.begin(), m_layers.end(),
+		[layer](const Layer& entry)
+		{
+			return entry.id == layer;
+		});
+	assert(it != m_layers.end());
+	return it;
+}
+
+void TileGridCompositor::insertLayer(Layer&& layer)
+{
+	auto position = std::find_if(m_layers.begin(), m_layers.end(),
+		[&layer](const Layer& entry)
+		{
+			return entry.zOrder > layer.zOrder;
+		});
+	m_layers.insert(position, std::move(layer));
+}
+
+void TileGridCompositor::compositeRegion(const Rectanglei& region)
+{
+	TileGridView output(&m_output);
+	output.setBox(region, m_clearTile);
+
+	for(const Layer& layer : m_layers)
+	{
+		if(!layer.visible)
+		{
+			continue;
+		}
+
+		Rectanglei bounds = layer.bounds();
+		int left = std::max(region.left(), bounds.left());
+		int bottom = std::max(region.bottom(), bounds.bottom());
+		int right = std::min(region.right(), bounds.right());
+		int top = std::min(region.top(), bounds.top());
+		if(right <= left || top <= bottom)
+		{
+			continue;
+		}
+
+		const Vector2i& sourcePosition = layer.source.position();
+		TileGridView part(sourcePosition.x + left - layer.offset.x, sourcePosition.y + bottom - layer.offset.y,
+				right - left, top - bottom, layer.source.getBaseGrid());
+		blit(part, output, Vector2i(left, bottom), layer.mask);
+	}
+}
+
+}
@@ -0,0 +1,156 @@
+#ifndef TILEGRIDCOMPOSITOR_H_
+#define TILEGRIDCOMPOSITOR_H_
+
+#include <vector>
+
+#include "Framework/TileGrid.h"
+#include "Framework/TileGridView.h"
+#include "Framework/TileBlit.h"
+
+namespace rf
+{
+
+/**
+ * @brief Flattens a stack of TileGridViews, drawn in z-order, into a single TileGrid.
+ * @details Each layer is a view of a grid owned by the caller, placed at an offset in the output
+ * and combined with the layers below it by a BlitMask. The compositor cannot see writes to those
+ * grids, so after changing a layer the caller reports the changed area with markDirty().
+ * composite() then rebuilds only the dirty cells of the output, from every layer that covers them.
+ *
+ * Dirty areas are kept as a few disjoint spans of columns per output row, so the work done by
+ * composite() is proportional to the changed area rather than the size of the output. Changes far
+ * apart on the same row stay separate until a row has more than MaxDirtySpans of them, when the
+ * two spans closest together are joined.
+ */
+class TileGridCompositor
+{
+public:
+	typedef int LayerId;
+
+	TileGridCompositor(int width, int height);
+	~TileGridCompositor() = default;
+
+	TileGridCompositor(const TileGridCompositor&) = delete;
+	TileGridCompositor(TileGridCompositor&&) = default;
+	TileGridCompositor& operator =(const TileGridCompositor&) = delete;
+	TileGridCompositor& operator =(TileGridCompositor&&) = default;
+
+	int width() const {return m_output.width();}
+	int height() const {return m_output.height();}
+
+	/**
+	 * @brief Add a layer that draws @a source with its bottom-left corner at @a offset in the output.
+	 * @details Layers with a higher @a zOrder are drawn over those with a lower one, and layers with
+	 * equal z-orders are drawn in the order they were added. The grid @a source views must outlive
+	 * the layer. The area of the new layer is marked dirty.
+	 * @return The id used to refer to the layer.
+	 */
+	LayerId addLayer(const TileGridView& source, int zOrder, const Vector2i& offset = Vector2i(0, 0),
+			const BlitMask& mask = BlitMask());
+	///Remove a layer and mark its area dirty.
+	void removeLayer(LayerId layer);
+
+	///Move a layer to @a offset, marking both its old and new areas dirty.
+	void setLayerOffset(LayerId layer, const Vector2i& offset);
+	void setLayerZOrder(LayerId layer, int zOrder);
+	void setLayerVisible(LayerId layer, bool visible);
+	void setLayerMask(LayerId layer, const BlitMask& mask);
+
+	const Vector2i& getLayerOffset(LayerId layer) const {return findLayer(layer).offset;}
+	int getLayerZOrder(LayerId layer) const {return findLayer(layer).zOrder;}
+	bool isLayerVisible(LayerId layer) const {return findLayer(layer).visible;}
+	const BlitMask& getLayerMask(LayerId layer) const {return findLayer(layer).mask;}
+
+	///Mark the whole of a layer as changed.
+	void markDirty(LayerId layer);
+	///Mark @a area, in the coordinates of the layer's view, as changed.
+	void markDirty(LayerId layer, const Rectanglei& area);
+
+	///Mark @a area of the output as needing to be recomposited.
+	void invalidate(const Rectanglei& area);
+	///Mark the whole output as needing to be recomposited.
+	void invalidate() {invalidate(Rectanglei(0, 0, width(), height()));}
+
+	///Set the tile that output cells are cleared to before the layers are drawn over them.
+	void setClearTile(const Tile& tile);
+	const Tile& getClearTile() const {return m_clearTile;}
+
+	///Return true if any part of the output needs to be recomposited.
+	bool isDirty() const {return m_isDirty;}
+
+	/**
+	 * @brief Rebuild the dirty cells of the output from the layers.
+	 * @details The rectangles that were rebuilt are available from updatedRegions() until the
+	 * next call.
+	 */
+	void composite();
+
+	const TileGrid& output() const {return m_output;}
+
+	///Return the areas of the output rebuilt by the last call to composite().
+	const std::vector<Rectanglei>& updatedRegions() const {return m_updatedRegions;}
+
+protected:
+	struct Layer
+	{
+		Layer(LayerId id, const TileGridView& source, int zOrder, const Vector2i& offset,
+				const BlitMask& mask):
+			id(id), source(source), zOrder(zOrder), offset(offset), mask(mask)
+		{}
+
+		///Return the area the layer covers in the output.
+		Rectanglei bounds() const {return Rectanglei(offset, source.width(), source.height());}
+
+		LayerId id;
+		TileGridView source;
+		int zOrder;
+		Vector2i offset;
+		BlitMask mask;
+		bool visible = true;
+	};
+
+	static constexpr int MaxDirtySpans = 4;
+
+	///The dirty columns [begin, end) of a row of the output.
+	struct DirtySpan
+	{
+		int begin;
+		int end;
+	};
+
+	///The dirty spans of a row of the output, disjoint and sorted by column.
+	struct DirtyRow
+	{
+		///Add [begin, end), merging it with the spans it overlaps or touches.
+		void add(int begin, int end);
+		///Remove @a span if the row has exactly that span, returning true if it did.
+		bool remove(const DirtySpan& span);
+
+		DirtySpan spans[MaxDirtySpans];
+		int count = 0;
+	};
+
+	Layer& findLayer(LayerId layer);
+	const Layer& findLayer(LayerId layer) const {return const_cast<TileGridCompositor*>(this)->findLayer(layer);}
+	std::vector<Layer>::iterator findLayerIterator(LayerId layer);
+
+	///Insert a layer after every layer with a z-order less than or equal to its own.
+	void insertLayer(Layer&& layer);
+
+	void compositeRegion(const Rectanglei& region);
+
+	TileGrid m_output;
+	Tile m_clearTile;
+
+	///Layers in drawing order, bottom first.
+	std::vector<Layer> m_layers;
+	LayerId m_nextLayerId = 0;
+
+	std::vector<DirtyRow> m_dirtyRows;
+	bool m_isDirty = false;
+	std::vector<Rectanglei> m_updatedRegions;
+};
+
+}
+
+#endif
@@ -0,0 +1,525 @@
+#include "Framework/TileGridFile.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RF_HAS_MMAP 1
+#endif
+
+#include "Framework/Exceptions/FileIoException.h"
+#include "Framework/TileSpan.h"
+
+namespace rf
+{
+
+constexpr uint16_t TileGridFile::Version;
+constexpr uint32_t TileGridFile::ByteOrderMark;
+
+namespace
+{
+
+const char magic[4] = {'R', 'F', 'T', 'G'};
+
+static_assert(sizeof(TileGridFile::Header) == 40, "TileGridFile::Header must not contain padding");
+static_assert(sizeof(TileGridFile::Header) % alignof(Tile) == 0, "Tiles following the header must be aligned");
+
+///Append @a size bytes at @a data to @a buffer.
+inline void append(std::vector<char>& buffer, const void* data, size_t size)
+{
+	const char* bytes = static_cast<const char*>(data);
+	buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+///Return the number of bytes between the read position of @a file and its end.
+uint64_t bytesLeft(std::ifstream& file)
+{
+	std::streamoff position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff end = file.tellg();
+	file.seekg(position);
+	return end > position ? static_cast<uint64_t>(end - position) : 0;
+}
+
+///Construct a grid of the size given in a file's header, which validateHeader() has already checked.
+TileGrid allocateGrid(int width, int height, const std::string& fileName)
+{
+	try
+	{
+		return TileGrid(width, height);
+	}
+	catch(const std::bad_alloc&)
+	{
+		throw FileIoException(fileName, "TileGrid file is too large to load");
+	}
+}
+
+///Reads values out of a payload, throwing if it runs past the end.
+class PayloadReader
+{
+public:
+	PayloadReader(const std::vector<char>& payload, const std::string& fileName):
+		m_position(payload.data()), m_end(payload.data() + payload.size()), m_fileName(fileName)
+	{
+	}
+
+	void read(void* data, size_t size)
+	{
+		if(static_cast<size_t>(m_end - m_position) < size)
+		{
+			throw FileIoException(m_fileName, "TileGrid file is truncated");
+		}
+		std::memcpy(data, m_position, size);
+		m_position += size;
+	}
+
+	bool atEnd() const {return m_position == m_end;}
+
+private:
+	const char* m_position;
+	const char* m_end;
+	const std::string& m_fileName;
+};
+
+}
+
+void TileGridFile::save(const TileGrid& grid, const std::string& fileName, Encoding encoding)
+{
+	assert(encoding == Encoding::Raw || encoding == Encoding::RunLength);
+
+	size_t tileCount = static_cast<size_t>(grid.width()) * grid.height();
+	if(encoding == Encoding::Raw)
+	{
+		size_t payloadSize = tileCount * sizeof(Tile);
+		write(fileName, makeHeader(grid.width(), grid.height(), encoding, payloadSize), grid.data(), payloadSize);
+		return;
+	}
+
+	//Each run is its length followed by the tile. Runs stop at the end of each row.
+	std::vector<char> payload;
+	for(int y = 0; y < grid.height(); ++y)
+	{
+		const Tile* row = grid.data() + static_cast<size_t>(y) * grid.width();
+		int x = 0;
+		while(x < grid.width())
+		{
+			int end = x + 1;
+			while(end < grid.width() && row[end] == row[x])
+			{
+				++end;
+			}
+			uint32_t length = static_cast<uint32_t>(end - x);
+			append(payload, &length, sizeof(length));
+			append(payload, &row[x], sizeof(Tile));
+			x = end;
+		}
+	}
+	write(fileName, makeHeader(grid.width(), grid.height(), encoding, payload.size()), payload.data(), payload.size());
+}
+
+TileGrid TileGridFile::load(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary | std::ios::in);
+	if(!file.is_open())
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+
+	Header header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if(file.gcount() != sizeof(header))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+	validateHeader(header, fileName);
+	//Check the sizes in the header against the file before allocating anything from them.
+	if(header.payloadSize > bytesLeft(file))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+
+	size_t tileCount = static_cast<size_t>(header.width) * header.height;
+	if(header.encoding == Encoding::Raw)
+	{
+		//The fast path: read the tiles straight into the grid.
+		std::streamsize size = static_cast<std::streamsize>(tileCount * sizeof(Tile));
+		if(header.payloadSize != static_cast<uint64_t>(size))
+		{
+			throw FileIoException(fileName, "TileGrid file has the wrong size");
+		}
+		TileGrid grid = allocateGrid(header.width, header.height, fileName);
+		file.read(reinterpret_cast<char*>(grid.data()), size);
+		if(file.gcount() != size)
+		{
+			throw FileIoException(fileName, "TileGrid file is truncated");
+		}
+		return grid;
+	}
+
+	if(header.encoding != Encoding::RunLength)
+	{
+		throw FileIoException(fileName, "TileGrid file is a delta, not a full grid");
+	}
+	//Every row holds at least one run.
+	const uint64_t runSize = sizeof(uint32_t) + sizeof(Tile);
+	if(header.payloadSize < static_cast<uint64_t>(header.height) * runSize)
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+
+	std::vector<char> payload(static_cast<size_t>(header.payloadSize));
+	file.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+	if(file.gcount() != static_cast<std::streamsize>(payload.size()))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+
+	TileGrid grid = allocateGrid(header.width, header.height, fileName);
+	PayloadReader reader(payload, fileName);
+	for(int y = 0; y < header.height; ++y)
+	{
+		Tile* row = grid.data() + static_cast<size_t>(y) * header.width;
+		uint32_t x = 0;
+		while(x < static_cast<uint32_t>(header.width))
+		{
+			uint32_t length;
+			Tile tile;
+			reader.read(&length, sizeof(length));
+			reader.read(static_cast<void*>(&tile), sizeof(Tile));
+			if(length == 0 || length > header.width - x)
+			{
+				throw FileIoException(fileName, "TileGrid file has an invalid run");
+			}
+			tilespan::fill(row + x, row + x + length, tile);
+			x += length;
+		}
+	}
+	return grid;
+}
+
+void TileGridFile::saveDelta(const TileGrid& grid, const TileGrid& base, const std::string& fileName)
+{
+	assert(grid.width() == base.width() && grid.height() == base.height());
+
+	//Each record is the index of its first tile, the number of tiles, and the tiles. A record costs
+	//less than one tile, so spans are never joined across unchanged tiles.
+	std::vector<char> payload;
+	uint32_t tileCount = static_cast<uint32_t>(grid.width()) * grid.height();
+	const Tile* tiles = grid.data();
+	const Tile* baseTiles = base.data();
+	uint32_t index = 0;
+	while(index < tileCount)
+	{
+		if(tiles[index] == baseTiles[index])
+		{
+			++index;
+			continue;
+		}
+		uint32_t end = index + 1;
+		while(end < tileCount && tiles[end] != baseTiles[end])
+		{
+			++end;
+		}
+		uint32_t count = end - index;
+		append(payload, &index, sizeof(index));
+		append(payload, &count, sizeof(count));
+		append(payload, tiles + index, count * sizeof(Tile));
+		index = end;
+	}
+
+	write(fileName, makeHeader(grid.width(), grid.height(), Encoding::Delta, payload.size(), hash(base)),
+		payload.data(), payload.size());
+}
+
+void TileGridFile::applyDelta(const std::string& fileName, TileGrid& grid)
+{
+	std::vector<char> payload;
+	Header header = read(fileName, payload);
+	if(header.encoding != Encoding::Delta)
+	{
+		throw FileIoException(fileName, "TileGrid file is not a delta");
+	}
+	if(header.width != grid.width() || header.height != grid.height() || header.baseHash != hash(grid))
+	{
+		throw FileIoException(fileName, "TileGrid delta does not match its base grid");
+	}
+
+	//Check every record before changing the grid, so a corrupt delta leaves it untouched.
+	uint32_t tileCount = static_cast<uint32_t>(grid.width()) * grid.height();
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		PayloadReader reader(payload, fileName);
+		while(!reader.atEnd())
+		{
+			uint32_t index;
+			uint32_t count;
+			reader.read(&index, sizeof(index));
+			reader.read(&count, sizeof(count));
+			if(index >= tileCount || count > tileCount - index)
+			{
+				throw FileIoException(fileName, "TileGrid delta has an invalid record");
+			}
+			if(pass == 0)
+			{
+				std::vector<Tile> skipped(count);
+				reader.read(static_cast<void*>(skipped.data()), count * sizeof(Tile));
+			}
+			else
+			{
+				reader.read(static_cast<void*>(grid.data() + index), count * sizeof(Tile));
+			}
+		}
+	}
+}
+
+uint64_t TileGridFile::hash(const TileGrid& grid)
+{
+	//FNV-1a over the dimensions and the tile bytes.
+	uint64_t result = 14695981039346656037ull;
+	auto add = [&result](const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(size_t i = 0; i < size; ++i)
+		{
+			result = (result ^ bytes[i]) * 1099511628211ull;
+		}
+	};
+
+	int32_t dimensions[2] = {grid.width(), grid.height()};
+	add(dimensions, sizeof(dimensions));
+	add(grid.data(), static_cast<size_t>(grid.width()) * grid.height() * sizeof(Tile));
+	return result;
+}
+
+void TileGridFile::validateHeader(const Header& header, const std::string& fileName)
+{
+	if(std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+	{
+		throw FileIoException(fileName, "Not a TileGrid file");
+	}
+	if(header.byteOrder != ByteOrderMark || header.tileSize != sizeof(Tile))
+	{
+		throw FileIoException(fileName, "TileGrid file was saved on an incompatible platform");
+	}
+	if(header.version > Version)
+	{
+		throw FileIoException(fileName, "TileGrid file was saved by a newer version");
+	}
+	if(header.width < 0 || header.height < 0 || header.encoding > Encoding::Delta)
+	{
+		throw FileIoException(fileName, "TileGrid file has an invalid header");
+	}
+	//TileGrid indexes its tiles with int, and the byte size must fit in size_t.
+	uint64_t tileCount = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height);
+	if(tileCount > static_cast<uint64_t>(std::numeric_limits<int>::max())
+			|| tileCount > std::numeric_limits<size_t>::max() / sizeof(Tile))
+	{
+		throw FileIoException(fileName, "TileGrid file has an invalid header");
+	}
+}
+
+TileGridFile::Header TileGridFile::makeHeader(int width, int height, Encoding encoding, uint64_t payloadSize,
+	uint64_t baseHash)
+{
+	Header header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = Version;
+	header.encoding = encoding;
+	header.width = width;
+	header.height = height;
+	header.tileSize = sizeof(Tile);
+	header.byteOrder = ByteOrderMark;
+	header.baseHash = baseHash;
+	header.payloadSize = payloadSize;
+	return header;
+}
+
+void TileGridFile::write(const std::string& fileName, const Header& header, const void* payload, size_t payloadSize)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::out | std::ios::trunc);
+	if(!file.is_open())
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(static_cast<const char*>(payload), static_cast<std::streamsize>(payloadSize));
+	file.flush();
+	if(!file)
+	{
+		throw FileIoException(fileName, "Unable to write TileGrid file");
+	}
+}
+
+TileGridFile::Header TileGridFile::read(const std::string& fileName, std::vector<char>& payload)
+{
+	std::ifstream file(fileName, std::ios::binary | std::ios::in);
+	if(!file.is_open())
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+
+	Header header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if(file.gcount() != sizeof(header))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+	validateHeader(header, fileName);
+	if(header.payloadSize > bytesLeft(file))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+
+	payload.resize(static_cast<size_t>(header.payloadSize));
+	file.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+	if(file.gcount() != static_cast<std::streamsize>(payload.size()))
+	{
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+	return header;
+}
+
+MappedTileGrid::MappedTileGrid(const std::string& fileName)
+{
+	const char* data = nullptr;
+	size_t size = 0;
+
+#ifdef RF_HAS_MMAP
+	int descriptor = ::open(fileName.c_str(), O_RDONLY);
+	if(descriptor < 0)
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+	struct stat status;
+	if(::fstat(descriptor, &status) != 0)
+	{
+		::close(descriptor);
+		throw FileIoException(fileName, "Unable to read file size");
+	}
+	size = static_cast<size_t>(status.st_size);
+	if(size >= sizeof(TileGridFile::Header))
+	{
+		void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if(mapping == MAP_FAILED)
+		{
+			::close(descriptor);
+			throw FileIoException(fileName, "Unable to map file");
+		}
+		m_mapping = mapping;
+		m_mappingSize = size;
+		data = static_cast<const char*>(mapping);
+	}
+	//The mapping stays valid after the descriptor is closed.
+	::close(descriptor);
+#else
+	std::ifstream file(fileName, std::ios::binary | std::ios::in | std::ios::ate);
+	if(!file.is_open())
+	{
+		throw FileIoException(fileName, "Unable to open file");
+	}
+	m_buffer.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+	size = static_cast<size_t>(file.gcount());
+	data = m_buffer.data();
+#endif
+
+	if(size < sizeof(TileGridFile::Header))
+	{
+		unmap();
+		throw FileIoException(fileName, "TileGrid file is truncated");
+	}
+
+	TileGridFile::Header header;
+	std::memcpy(&header, data, sizeof(header));
+	try
+	{
+		TileGridFile::validateHeader(header, fileName);
+		if(header.encoding != TileGridFile::Encoding::Raw)
+		{
+			throw FileIoException(fileName, "Only raw TileGrid files can be mapped");
+		}
+		uint64_t tilesSize = static_cast<uint64_t>(header.width) * header.height * sizeof(Tile);
+		if(header.payloadSize != tilesSize || size - sizeof(header) < tilesSize)
+		{
+			throw FileIoException(fileName, "TileGrid file is truncated");
+		}
+	}
+	catch(...)
+	{
+		unmap();
+		throw;
+	}
+
+	m_width = header.width;
+	m_height = header.height;
+	m_tiles = reinterpret_cast<const Tile*>(data + sizeof(header));
+}
+
+MappedTileGrid::~MappedTileGrid()
+{
+	unmap();
+}
+
+MappedTileGrid::MappedTileGrid(MappedTileGrid&& other) noexcept:
+	m_width(other.m_width), m_height(other.m_height), m_tiles(other.m_tiles),
+	m_mapping(other.m_mapping), m_mappingSize(other.m_mappingSize), m_buffer(std::move(other.m_buffer))
+{
+	other.m_width = 0;
+	other.m_height = 0;
+	other.m_tiles = nullptr;
+	other.m_mapping = nullptr;
+	other.m_mappingSize = 0;
+}
+
+MappedTileGrid& MappedTileGrid::operator =(MappedTileGrid&& other) noexcept
+{
+	if(&other != this)
+	{
+		unmap();
+		m_width = other.m_width;
+		m_height = other.m_height;
+		m_tiles = other.m_tiles;
+		m_mapping = other.m_mapping;
+		m_mappingSize = other.m_mappingSize;
+		m_buffer = std::move(other.m_buffer);
+		other.m_width = 0;
+		other.m_height = 0;
+		other.m_tiles = nullptr;
+		other.m_mapping = nullptr;
+		other.m_mappingSize = 0;
+	}
+	return *this;
+}
+
+void MappedTileGrid::copyTo(TileGrid& grid) const
+{
+	assert(grid.width() == m_width && grid.height() == m_height);
+
+	tilespan::copy(m_tiles, static_cast<size_t>(m_width) * m_height, grid.data());
+}
+
+void MappedTileGrid::unmap()
+{
+#ifdef RF_HAS_MMAP
+	if(m_mapping != nullptr)
+	{
+		::munmap(m_mapping, m_mappingSize);
+	}
+#endif
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_buffer.clear();
+	m_tiles = nullptr;
+}
+
+}
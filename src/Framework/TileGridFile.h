@@ -0,0 +1,130 @@
+#ifndef TILEGRIDFILE_H_
+#define TILEGRIDFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief Saves and loads TileGrids in a versioned binary format.
+ * @details A file is a fixed size header followed by the tiles in one of three encodings:
+ * - Raw: every tile as it is laid out in memory, row by row. Loading is a single read, and the
+ *   file can be mapped into memory with MappedTileGrid.
+ * - RunLength: each row as runs of identical tiles, for maps with large areas of the same tile.
+ * - Delta: only the spans of tiles that differ from a base grid, for cheap autosaves on top of a
+ *   full save. The header records a hash of the base, which is checked when the delta is applied.
+ *
+ * Tiles are stored in the byte order of the machine that saved them; loading a file saved on a
+ * machine of the other byte order fails rather than producing garbage.
+ *
+ * All functions throw FileIoException if a file can't be opened, read or written, or is not a
+ * valid file of the expected kind.
+ */
+class TileGridFile
+{
+public:
+	enum class Encoding : uint16_t
+	{
+		Raw = 0,
+		RunLength = 1,
+		Delta = 2
+	};
+
+	static constexpr uint16_t Version = 1;
+
+	///Save @a grid to @a fileName with @a encoding, which must be Raw or RunLength.
+	static void save(const TileGrid& grid, const std::string& fileName, Encoding encoding = Encoding::Raw);
+
+	///Load a grid saved with save().
+	static TileGrid load(const std::string& fileName);
+
+	///Save the tiles of @a grid that differ from @a base, which must have the same dimensions.
+	static void saveDelta(const TileGrid& grid, const TileGrid& base, const std::string& fileName);
+
+	/**
+	 * @brief Apply a delta saved with saveDelta() to @a grid.
+	 * @details @a grid must hold the same tiles as the base the delta was saved against.
+	 */
+	static void applyDelta(const std::string& fileName, TileGrid& grid);
+
+	///Return a hash of the dimensions and tiles of @a grid, as recorded by saveDelta().
+	static uint64_t hash(const TileGrid& grid);
+
+	///The header at the start of every file.
+	struct Header
+	{
+		char magic[4];
+		uint16_t version;
+		Encoding encoding;
+		int32_t width;
+		int32_t height;
+		uint32_t tileSize;
+		///Always ByteOrderMark, to detect files from machines of the other byte order.
+		uint32_t byteOrder;
+		///The hash of the base grid of a delta, otherwise zero.
+		uint64_t baseHash;
+		///The number of bytes following the header.
+		uint64_t payloadSize;
+	};
+
+	static constexpr uint32_t ByteOrderMark = 0x01020304;
+
+	///Check @a header, throwing FileIoException naming @a fileName if it is not a valid header.
+	static void validateHeader(const Header& header, const std::string& fileName);
+
+protected:
+	static Header makeHeader(int width, int height, Encoding encoding, uint64_t payloadSize, uint64_t baseHash = 0);
+	static void write(const std::string& fileName, const Header& header, const void* payload, size_t payloadSize);
+	static Header read(const std::string& fileName, std::vector<char>& payload);
+};
+
+/**
+ * @brief A Raw TileGrid file mapped into memory, so its tiles can be read without loading them.
+ * @details The tiles are read straight out of the page cache, so opening a map costs almost nothing
+ * and only the parts that are used are ever read from disk. The file must not be changed while it is
+ * mapped. On platforms without mmap the file is read into memory instead.
+ */
+class MappedTileGrid
+{
+public:
+	///@throw FileIoException if the file can't be mapped or is not a Raw TileGrid file.
+	explicit MappedTileGrid(const std::string& fileName);
+	~MappedTileGrid();
+
+	MappedTileGrid(const MappedTileGrid&) = delete;
+	MappedTileGrid& operator =(const MappedTileGrid&) = delete;
+	MappedTileGrid(MappedTileGrid&& other) noexcept;
+	MappedTileGrid& operator =(MappedTileGrid&& other) noexcept;
+
+	int width() const {return m_width;}
+	int height() const {return m_height;}
+
+	const Tile& getTile(int x, int y) const {return m_tiles[x + y * m_width];}
+	const Tile* rowBegin(int y) const {return m_tiles + y * m_width;}
+	///Return the tiles, stored row by row starting at y = 0.
+	const Tile* data() const {return m_tiles;}
+
+	///Copy the tiles to @a grid, which must have the same dimensions.
+	void copyTo(TileGrid& grid) const;
+
+protected:
+	void unmap();
+
+	int m_width = 0;
+	int m_height = 0;
+	const Tile* m_tiles = nullptr;
+
+	void* m_mapping = nullptr;
+	size_t m_mappingSize = 0;
+	///Holds the file contents where it can't be mapped.
+	std::vector<char> m_buffer;
+};
+
+}
+
+#endif
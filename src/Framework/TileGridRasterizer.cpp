@@ -0,0 +1,167 @@
+#include "Framework/TileGridRasterizer.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Framework/CpuTileSet.h"
+#include "Framework/Jobs/JobSystem.h"
+
+namespace rf
+{
+
+namespace
+{
+
+const int rowsPerJob = 2;
+const int bytesPerPixel = 4;
+
+///The colors of one tile, in the form the shader blends them.
+struct TileColors
+{
+	///The foreground color with an alpha of one; the glyph's coverage scales all four channels.
+	float foreground[4];
+	///The background color premultiplied by its alpha, and the alpha.
+	float background[4];
+	float foregroundAlpha;
+
+	TileColors(const Color& foregroundColor, const Color& backgroundColor)
+	{
+		float backgroundAlpha = backgroundColor.alpha / 255.0f;
+		foreground[0] = foregroundColor.red / 255.0f;
+		foreground[1] = foregroundColor.green / 255.0f;
+		foreground[2] = foregroundColor.blue / 255.0f;
+		foreground[3] = 1.0f;
+		background[0] = backgroundColor.red / 255.0f * backgroundAlpha;
+		background[1] = backgroundColor.green / 255.0f * backgroundAlpha;
+		background[2] = backgroundColor.blue / 255.0f * backgroundAlpha;
+		background[3] = backgroundAlpha;
+		foregroundAlpha = foregroundColor.alpha / 255.0f;
+	}
+
+	///Return the shaded pixel for @a coverage, packed in image byte order.
+	uint32_t shade(uint8_t coverage) const
+	{
+		//The texture is white, so only its alpha changes the foreground color.
+		float alpha = coverage / 255.0f * foregroundAlpha;
+		uint8_t bytes[4];
+#if defined(__SSE2__)
+		__m128 blended = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(foreground), _mm_set1_ps(alpha)),
+				_mm_mul_ps(_mm_loadu_ps(background), _mm_set1_ps(1.0f - alpha)));
+		__m128i channels = _mm_cvtps_epi32(_mm_mul_ps(blended, _mm_set1_ps(255.0f)));
+		channels = _mm_packs_epi32(channels, channels);
+		channels = _mm_packus_epi16(channels, channels);
+		uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(channels));
+		std::memcpy(bytes, &packed, sizeof(bytes));
+#else
+		for(int channel = 0; channel < 4; ++channel)
+		{
+			float blended = foreground[channel] * alpha + background[channel] * (1.0f - alpha);
+			long value = std::lrint(blended * 255.0f);
+			bytes[channel] = static_cast<uint8_t>(value < 0 ? 0 : value > 255 ? 255 : value);
+		}
+#endif
+		uint32_t pixel;
+		std::memcpy(&pixel, bytes, sizeof(pixel));
+		return pixel;
+	}
+};
+
+}
+
+TileGridRasterizer::TileGridRasterizer(CpuTileSet* tileSet, JobSystem* jobSystem):
+	m_tileSet(tileSet), m_jobSystem(jobSystem)
+{
+}
+
+int TileGridRasterizer::imageWidth(const TileGrid& grid) const
+{
+	return grid.width() * m_tileSet->tileWidth();
+}
+
+int TileGridRasterizer::imageHeight(const TileGrid& grid) const
+{
+	return grid.height() * m_tileSet->tileHeight();
+}
+
+void TileGridRasterizer::render(const TileGrid& grid, uint8_t* pixels, size_t pitch)
+{
+	assert(pitch >= static_cast<size_t>(imageWidth(grid)) * bytesPerPixel);
+
+	//Consecutive cells often share a tile, so only changes of index go to the tile set.
+	size_t cellCount = static_cast<size_t>(grid.width()) * grid.height();
+	m_cellCoverage.resize(cellCount);
+	unsigned int lastIndex = 0;
+	const uint8_t* lastCoverage = nullptr;
+	for(size_t cell = 0; cell < cellCount; ++cell)
+	{
+		unsigned int index = grid.getTile(cell).tileIndex();
+		if(lastCoverage == nullptr || index != lastIndex)
+		{
+			lastIndex = index;
+			lastCoverage = m_tileSet->getCoverage(index);
+		}
+		m_cellCoverage[cell] = lastCoverage;
+	}
+
+	if(m_jobSystem != nullptr)
+	{
+		m_jobSystem->parallelFor(0, grid.height(), rowsPerJob,
+			[this, &grid, pixels, pitch](int firstRow, int lastRow)
+			{
+				renderRows(grid, firstRow, lastRow, pixels, pitch);
+			});
+	}
+	else
+	{
+		renderRows(grid, 0, grid.height(), pixels, pitch);
+	}
+}
+
+void TileGridRasterizer::render(const TileGrid& grid, std::vector<uint8_t>& pixels)
+{
+	size_t pitch = static_cast<size_t>(imageWidth(grid)) * bytesPerPixel;
+	pixels.resize(pitch * imageHeight(grid));
+	render(grid, pixels.data(), pitch);
+}
+
+uint32_t TileGridRasterizer::shadePixel(uint8_t coverage, const Color& foreground, const Color& background)
+{
+	return TileColors(foreground, background).shade(coverage);
+}
+
+void TileGridRasterizer::renderRows(const TileGrid& grid, int firstRow, int lastRow, uint8_t* pixels, size_t pitch)
+{
+	const int tileWidth = m_tileSet->tileWidth();
+	const int tileHeight = m_tileSet->tileHeight();
+
+	for(int y = firstRow; y < lastRow; ++y)
+	{
+		for(int x = 0; x < grid.width(); ++x)
+		{
+			const Tile& tile = grid.getTile(x, y);
+			const uint8_t* coverage = m_cellCoverage[x + static_cast<size_t>(y) * grid.width()];
+			TileColors colors(tile.foregroundColor(), tile.backgroundColor());
+			//Most of a glyph's cell is empty, and shows only the background.
+			uint32_t emptyPixel = colors.shade(0);
+
+			for(int row = 0; row < tileHeight; ++row)
+			{
+				uint8_t* destination = pixels + (static_cast<size_t>(y) * tileHeight + row) * pitch +
+						static_cast<size_t>(x) * tileWidth * bytesPerPixel;
+				const uint8_t* source = coverage + row * tileWidth;
+				for(int column = 0; column < tileWidth; ++column)
+				{
+					uint32_t pixel = source[column] == 0 ? emptyPixel : colors.shade(source[column]);
+					std::memcpy(destination + column * bytesPerPixel, &pixel, sizeof(pixel));
+				}
+			}
+		}
+	}
+}
+
+}
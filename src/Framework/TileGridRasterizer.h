@@ -0,0 +1,57 @@
+#ifndef TILEGRIDRASTERIZER_H_
+#define TILEGRIDRASTERIZER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+class CpuTileSet;
+class JobSystem;
+
+/**
+ * @brief Renders a TileGrid to an RGBA image on the CPU, for screenshots and for tests without a GPU.
+ * @details Each pixel is computed with the formula of the fragment shader that every
+ * TileGridRenderer program shares, with the glyph texture's alpha taken from the CpuTileSet's
+ * coverage, so the image matches what the GL path draws at one texel per pixel.
+ *
+ * Images are 8 bits per channel in R, G, B, A byte order with rows from the top down, and grid
+ * row 0 at the top. Rows of tiles are split into bands that run in parallel when a JobSystem is
+ * given.
+ */
+class TileGridRasterizer
+{
+public:
+	explicit TileGridRasterizer(CpuTileSet* tileSet, JobSystem* jobSystem = nullptr);
+	~TileGridRasterizer() = default;
+
+	TileGridRasterizer(const TileGridRasterizer&) = delete;
+	TileGridRasterizer(TileGridRasterizer&&) = default;
+	TileGridRasterizer& operator =(const TileGridRasterizer&) = delete;
+	TileGridRasterizer& operator =(TileGridRasterizer&&) = default;
+
+	int imageWidth(const TileGrid& grid) const;
+	int imageHeight(const TileGrid& grid) const;
+
+	///Render @a grid into @a pixels, which holds imageHeight() rows of imageWidth() pixels, @a pitch bytes apart.
+	void render(const TileGrid& grid, uint8_t* pixels, size_t pitch);
+	///Render @a grid into @a pixels, resizing it to hold the image with no padding between rows.
+	void render(const TileGrid& grid, std::vector<uint8_t>& pixels);
+
+	///Return the pixel the shared fragment shader produces for @a coverage of a tile with colors @a foreground and @a background.
+	static uint32_t shadePixel(uint8_t coverage, const Color& foreground, const Color& background);
+
+protected:
+	void renderRows(const TileGrid& grid, int firstRow, int lastRow, uint8_t* pixels, size_t pitch);
+
+	CpuTileSet* m_tileSet;
+	JobSystem* m_jobSystem;
+	///The coverage mask of each cell, looked up before rendering since CpuTileSet isn't thread safe.
+	std::vector<const uint8_t*> m_cellCoverage;
+};
+
+}
+
+#endif
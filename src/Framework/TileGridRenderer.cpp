@@ -5,6 +5,10 @@
 
 #include "Framework/Gl/Shader.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 namespace rf
 {
 
@@ -26,25 +30,182 @@ TileGridRenderer::TileGridRenderer(std::shared_ptr<gl::ShaderProgram> shader,
 }
 
 void TileGridRenderer::render(const Vector2i& location)
+{
+	Matrix3f transform = Matrix3f::translation(location.x - m_subTileOffset.x * m_tileSet->tileWidth(),
+			location.y - m_subTileOffset.y * m_tileSet->tileHeight()) * m_projectionTransform;
+	if(m_isCaching)
+	{
+		drawCached(transform);
+	}
+	else
+	{
+		drawGrid(transform);
+	}
+}
+
+void TileGridRenderer::drawGrid(const Matrix3f& transform)
 {
 	const int gridWidth = m_grid->width();
 	const int gridHeight = m_grid->height();
-	const int tileWidth = m_tileSet->tileWidth();
-	const int tileHeight = m_tileSet->tileHeight();
-
-	Matrix3f transform = Matrix3f::translation(location.x, location.y) * m_projectionTransform;
 
-	m_colorTexCoordBuffer.invalidate();
-	fillDynamicAttributeBuffer();
+	m_colorTexCoordBuffer.bind();
+	if(m_isScrolling)
+	{
+		uploadScrollingChanges();
+	}
+	else
+	{
+		m_colorTexCoordBuffer.invalidate();
+		fillDynamicAttributeBuffer();
+	}
+	bindTileTexture();
 
 	m_shader->bind();
 	m_vao.bind();
 	m_shader->setUniformValue("transform", transform);
 	m_shader->setUniformValue("texSampler", 0);
+	if(m_isScrolling)
+	{
+		m_shader->setUniformValue("gridSize", gridWidth, gridHeight);
+		m_shader->setUniformValue("scroll", wrap(m_scrollOrigin.x, gridWidth), wrap(m_scrollOrigin.y, gridHeight));
+		m_shader->setUniformValue("tileSize", static_cast<float>(m_tileSet->tileWidth()),
+				static_cast<float>(m_tileSet->tileHeight()));
+	}
 	m_context->drawIndexedPrimitives(gl::PrimitiveType::Triangles, 6 * gridWidth * gridHeight,
 			gl::IndexFormat::UInt, 0);
 }
 
+void TileGridRenderer::drawCached(const Matrix3f& transform)
+{
+	const int imageWidth = m_grid->width() * m_tileSet->tileWidth();
+	const int imageHeight = m_grid->height() * m_tileSet->tileHeight();
+
+	//Queried every time, as the application may have resized the viewport with glViewport().
+	const gl::Framebuffer* target = m_context->boundFramebuffer();
+	Rectanglei viewport = m_context->viewport();
+	if(!m_cacheFramebuffer)
+	{
+		m_cacheTexture.reset(new gl::Texture2d(imageWidth, imageHeight, 1, gl::Texture::InternalPixelFormat::RGBA8,
+				m_context));
+		m_cacheFramebuffer.reset(new gl::Framebuffer(m_context));
+		m_cacheFramebuffer->attachColorTexture(*m_cacheTexture);
+		m_isCacheDirty = true;
+	}
+
+	if(m_isCacheDirty)
+	{
+		m_cacheFramebuffer->clear(Colorf(0.0f, 0.0f, 0.0f, 0.0f));
+		m_context->setViewport(Rectanglei(0, 0, imageWidth, imageHeight));
+		//Grid pixel (x, y) lands on texel (x, y); the blit below turns it to match the projection.
+		drawGrid(Matrix3f::orthographicProjection(0, imageWidth, 0, imageHeight));
+
+		if(target != nullptr)
+		{
+			m_context->bindFramebuffer(*target);
+		}
+		else
+		{
+			m_context->bindDefaultFramebuffer();
+		}
+		m_context->setViewport(viewport);
+		m_isCacheDirty = false;
+	}
+
+	//Find the pixels the corners of the grid would be drawn at by drawGrid() with the transform.
+	Matrix3f cornerTransform = transform;
+	Vector2f corners[2] =
+	{
+		cornerTransform.transform(Vector2f(0, 0)),
+		cornerTransform.transform(Vector2f(static_cast<float>(imageWidth), static_cast<float>(imageHeight)))
+	};
+	int x[2];
+	int y[2];
+	for(int i = 0; i < 2; ++i)
+	{
+		x[i] = static_cast<int>(std::lround(viewport.left() + (corners[i].x + 1.0f) * 0.5f * viewport.width()));
+		y[i] = static_cast<int>(std::lround(viewport.bottom() + (corners[i].y + 1.0f) * 0.5f * viewport.height()));
+	}
+
+	Rectanglei destination(std::min(x[0], x[1]), std::min(y[0], y[1]), std::abs(x[1] - x[0]), std::abs(y[1] - y[0]));
+	m_cacheFramebuffer->blitTo(target, Rectanglei(0, 0, imageWidth, imageHeight), destination, y[1] < y[0]);
+}
+
+void TileGridRenderer::setGrid(const TileGrid* grid)
+{
+	assert(grid->width() == m_grid->width() && grid->height() == m_grid->height());
+
+	m_grid = grid;
+	m_isCacheDirty = true;
+	if(m_isScrolling)
+	{
+		m_needsFullUpload = true;
+	}
+}
+
+void TileGridRenderer::setScrollingEnabled(bool enabled)
+{
+	m_isScrolling = enabled;
+	m_needsFullUpload = true;
+	m_dirtyAreas.clear();
+
+	//The buffer is rewritten piecemeal rather than respecified every frame.
+	m_colorTexCoordBuffer.setUsageType(enabled ? gl::BufferObject::UsageType::DynamicDraw :
+			gl::BufferObject::UsageType::StreamDraw);
+	m_colorTexCoordBuffer.bind();
+	m_colorTexCoordBuffer.invalidate();
+}
+
+void TileGridRenderer::setCachingEnabled(bool enabled)
+{
+	m_isCaching = enabled;
+	m_isCacheDirty = true;
+	if(!enabled)
+	{
+		m_cacheFramebuffer.reset();
+		m_cacheTexture.reset();
+	}
+}
+
+void TileGridRenderer::scrollTo(const Vector2i& origin)
+{
+	const int gridWidth = m_grid->width();
+	const int gridHeight = m_grid->height();
+	Vector2i delta = origin - m_scrollOrigin;
+	m_scrollOrigin = origin;
+	if(delta.x != 0 || delta.y != 0)
+	{
+		m_isCacheDirty = true;
+	}
+
+	if(std::abs(delta.x) >= gridWidth || std::abs(delta.y) >= gridHeight)
+	{
+		m_needsFullUpload = true;
+		return;
+	}
+
+	//Only the cells that scrolled into view have stale slots.
+	if(delta.x != 0)
+	{
+		int stripLeft = delta.x > 0 ? gridWidth - delta.x : 0;
+		markDirty(Rectanglei(stripLeft, 0, std::abs(delta.x), gridHeight));
+	}
+	if(delta.y != 0)
+	{
+		int stripBottom = delta.y > 0 ? gridHeight - delta.y : 0;
+		markDirty(Rectanglei(0, stripBottom, gridWidth, std::abs(delta.y)));
+	}
+}
+
+void TileGridRenderer::markDirty(const Rectanglei& area)
+{
+	m_isCacheDirty = true;
+	if(m_isScrolling && area.width() > 0 && area.height() > 0)
+	{
+		m_dirtyAreas.push_back(Rectanglei(area.left() + m_scrollOrigin.x, area.bottom() + m_scrollOrigin.y,
+				area.width(), area.height()));
+	}
+}
+
 void TileGridRenderer::initializeStaticBuffers()
 {
 	m_vertexBuffer.bind();
@@ -98,43 +259,98 @@ void TileGridRenderer::fillDynamicAttributeBuffer()
 	auto dynBufferMapping = m_colorTexCoordBuffer.map<DynVertexAttribs>(gl::BufferObject::MappingOptions::Write);
 	for(int y = 0; y < gridHeight; ++y)
 	{
+		//In scrolling mode slot row y holds the grid row that wraps onto it.
+		int gridY = m_isScrolling ? wrap(y - m_scrollOrigin.y, gridHeight) : y;
+		int scrollX = m_isScrolling ? m_scrollOrigin.x : 0;
 		for(int x = 0; x < gridWidth; ++x)
 		{
-			int index = x + y * gridWidth;
-			int vertexIndex = index * 4;
-			const Tile& tile = m_grid->getTile(index);
-			TileSet::TileLocation loc = m_tileSet->getTileLocation(tile.tileIndex());
-			uint32_t fgColor = tile.foregroundColor().toRgbaEndianAware();
-			uint32_t bgColor = tile.backgroundColor().toRgbaEndianAware();
-			if(x == 0 && y == 0)
+			int gridX = m_isScrolling ? wrap(x - scrollX, gridWidth) : x;
+			int vertexIndex = (x + y * gridWidth) * verticesPerTile;
+			writeTileAttributes(m_grid->getTile(gridX, gridY), &dynBufferMapping[vertexIndex]);
+		}
+	}
+}
+
+void TileGridRenderer::bindTileTexture()
+{
+	TileSet::TileLocation loc = m_tileSet->getTileLocation(m_grid->getTile(0).tileIndex());
+	m_context->setActiveTextureUnit(0);
+	loc.texture->bind();
+}
+
+void TileGridRenderer::writeTileAttributes(const Tile& tile, DynVertexAttribs* vertices)
+{
+	TileSet::TileLocation loc = m_tileSet->getTileLocation(tile.tileIndex());
+	uint32_t fgColor = tile.foregroundColor().toRgbaEndianAware();
+	uint32_t bgColor = tile.backgroundColor().toRgbaEndianAware();
+
+	vertices[0].ux = loc.bottomLeft.x;
+	vertices[0].uy = loc.bottomLeft.y;
+	vertices[1].ux = loc.bottomLeft.x;
+	vertices[1].uy = loc.topRight.y;
+	vertices[2].ux = loc.topRight.x;
+	vertices[2].uy = loc.topRight.y;
+	vertices[3].ux = loc.topRight.x;
+	vertices[3].uy = loc.bottomLeft.y;
+	for(int i = 0; i < verticesPerTile; ++i)
+	{
+		vertices[i].uz = loc.layer;
+		vertices[i].fgColor = fgColor;
+		vertices[i].bgColor = bgColor;
+	}
+}
+
+void TileGridRenderer::uploadScrollingChanges()
+{
+	if(m_needsFullUpload)
+	{
+		m_colorTexCoordBuffer.invalidate();
+		fillDynamicAttributeBuffer();
+		m_needsFullUpload = false;
+		m_dirtyAreas.clear();
+		return;
+	}
+
+	for(const Rectanglei& worldArea : m_dirtyAreas)
+	{
+		//Areas that have since scrolled out of view are clipped away; if they come back they
+		//are uploaded as part of the exposed strip.
+		int left = std::max(worldArea.left() - m_scrollOrigin.x, 0);
+		int bottom = std::max(worldArea.bottom() - m_scrollOrigin.y, 0);
+		int right = std::min(worldArea.right() - m_scrollOrigin.x, m_grid->width());
+		int top = std::min(worldArea.top() - m_scrollOrigin.y, m_grid->height());
+		if(right > left && top > bottom)
+		{
+			uploadWrappedRows(Rectanglei(left, bottom, right - left, top - bottom));
+		}
+	}
+	m_dirtyAreas.clear();
+}
+
+void TileGridRenderer::uploadWrappedRows(const Rectanglei& area)
+{
+	const int gridWidth = m_grid->width();
+	const int gridHeight = m_grid->height();
+
+	for(int y = area.bottom(); y < area.top(); ++y)
+	{
+		int slotY = wrap(y + m_scrollOrigin.y, gridHeight);
+		int x = area.left();
+
+		//A row of the area covers at most two runs of slots, split where it wraps.
+		while(x < area.right())
+		{
+			int slotX = wrap(x + m_scrollOrigin.x, gridWidth);
+			int count = std::min(area.right() - x, gridWidth - slotX);
+
+			m_uploadBuffer.resize(count * verticesPerTile);
+			for(int i = 0; i < count; ++i)
 			{
-				m_context->setActiveTextureUnit(0);
-				loc.texture->bind();
+				writeTileAttributes(m_grid->getTile(x + i, y), &m_uploadBuffer[i * verticesPerTile]);
 			}
-
-			dynBufferMapping[vertexIndex].ux = loc.bottomLeft.x;
-			dynBufferMapping[vertexIndex].uy = loc.bottomLeft.y;
-			dynBufferMapping[vertexIndex].uz = loc.layer;
-			dynBufferMapping[vertexIndex].fgColor = fgColor;
-			dynBufferMapping[vertexIndex].bgColor = bgColor;
-			vertexIndex += 1;
-			dynBufferMapping[vertexIndex].ux = loc.bottomLeft.x;
-			dynBufferMapping[vertexIndex].uy = loc.topRight.y;
-			dynBufferMapping[vertexIndex].uz = loc.layer;
-			dynBufferMapping[vertexIndex].fgColor = fgColor;
-			dynBufferMapping[vertexIndex].bgColor = bgColor;
-			vertexIndex += 1;
-			dynBufferMapping[vertexIndex].ux = loc.topRight.x;
-			dynBufferMapping[vertexIndex].uy = loc.topRight.y;
-			dynBufferMapping[vertexIndex].uz = loc.layer;
-			dynBufferMapping[vertexIndex].fgColor = fgColor;
-			dynBufferMapping[vertexIndex].bgColor = bgColor;
-			vertexIndex += 1;
-			dynBufferMapping[vertexIndex].ux = loc.topRight.x;
-			dynBufferMapping[vertexIndex].uy = loc.bottomLeft.y;
-			dynBufferMapping[vertexIndex].uz = loc.layer;
-			dynBufferMapping[vertexIndex].fgColor = fgColor;
-			dynBufferMapping[vertexIndex].bgColor = bgColor;
+			m_colorTexCoordBuffer.setSubData(m_uploadBuffer.data(), m_uploadBuffer.size() * sizeof(DynVertexAttribs),
+					(slotX + slotY * gridWidth) * verticesPerTile * sizeof(DynVertexAttribs));
+			x += count;
 		}
 	}
 }
@@ -165,7 +381,55 @@ std::shared_ptr<gl::ShaderProgram> TileGridRenderer::createDefaultShaders(gl::Co
 		}
 		)";
 
-		std::string fragmentShaderSource =
+	return linkShaders(vertexShaderSource, context);
+}
+
+std::shared_ptr<gl::ShaderProgram> TileGridRenderer::createScrollingShaders(gl::Context* context)
+{
+	//Each quad's buffer slot is found from gl_VertexID, since the indices are laid out as
+	//slot * 4 + corner, and moved back to its place on screen by the scroll offset.
+	std::string vertexShaderSource =
+		R"(
+		#version 140
+
+		uniform mat3 transform;
+		uniform ivec2 gridSize;
+		uniform ivec2 scroll;
+		uniform vec2 tileSize;
+
+		in vec2 position;
+		in vec3 tex;
+		in vec4 fgColor;
+		in vec4 bgColor;
+
+		out vec3 texCoord;
+		out vec4 foregroundColor;
+		out vec4 backgroundColor;
+
+		const vec2 corners[4] = vec2[4](vec2(0, 0), vec2(0, 1), vec2(1, 1), vec2(1, 0));
+
+		void main()
+		{
+			int slot = gl_VertexID / 4;
+			ivec2 slotPosition = ivec2(slot % gridSize.x, slot / gridSize.x);
+			ivec2 cell = (slotPosition - scroll + gridSize) % gridSize;
+			vec2 screenPosition = (vec2(cell) + corners[gl_VertexID % 4]) * tileSize;
+
+			texCoord = tex;
+			foregroundColor = fgColor;
+			backgroundColor = bgColor;
+			gl_Position = vec4((transform * vec3(screenPosition, 1)).xy, 1, 1);
+		}
+		)";
+
+	return linkShaders(vertexShaderSource, context);
+}
+
+std::shared_ptr<gl::ShaderProgram> TileGridRenderer::linkShaders(const std::string& vertexShaderSource,
+		gl::Context* context)
+{
+	//Every program shares this fragment shader; TileGridRasterizer::shadePixel() is its CPU twin.
+	std::string fragmentShaderSource =
 		R"(
 		#version 140
 
@@ -3,6 +3,12 @@
 
 #include "TileGrid.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Framework/Gl/Framebuffer.h"
+#include "Framework/Gl/Texture2d.h"
 #include "Framework/Gl/VertexArrayObject.h"
 #include "Framework/Gl/VertexBufferObject.h"
 #include "Framework/Gl/IndexBufferObject.h"
@@ -31,9 +37,65 @@ public:
 
 	void render(const Vector2i& location);
 
+	///@brief Render a different grid from now on, such as a new TileGridSnapshotBuffer snapshot.
+	///@details @a grid must have the same dimensions as the grid the renderer was created with.
+	void setGrid(const TileGrid* grid);
+	const TileGrid* getGrid() const {return m_grid;}
+
+	/**
+	 * @brief Turn scrolling mode on or off.
+	 * @details In scrolling mode the per-tile attributes are kept in a wrap-around layout: world
+	 * cell (x, y) always lives in buffer slot (x mod width, y mod height), and the shader shifts
+	 * the slots back into place with a scroll uniform. Scrolling by a few cells with scrollTo()
+	 * then only uploads the rows and columns that came into view, and other changes to the grid
+	 * are only uploaded once reported with markDirty().
+	 *
+	 * The renderer must have been created with the shaders from createScrollingShaders(), or
+	 * ones with the same uniforms.
+	 */
+	void setScrollingEnabled(bool enabled);
+	bool isScrollingEnabled() const {return m_isScrolling;}
+
+	/**
+	 * @brief Set the world cell shown by the bottom-left tile of the grid.
+	 * @details The grid must already hold the contents at the new origin, such as a
+	 * ChunkedTileGridWindow moved to @a origin. Only used in scrolling mode.
+	 */
+	void scrollTo(const Vector2i& origin);
+	const Vector2i& getScrollOrigin() const {return m_scrollOrigin;}
+
+	/**
+	 * @brief Shift the whole grid down and left by a fraction of a tile, for smooth scrolling.
+	 * @details @a offset is in tiles and is normally in [0, 1). The grid should be one tile wider
+	 * and taller than the visible area so no gap shows at the top and right edges.
+	 */
+	void setSubTileOffset(const Vector2f& offset) {m_subTileOffset = offset;}
+	const Vector2f& getSubTileOffset() const {return m_subTileOffset;}
+
+	/**
+	 * @brief Turn caching mode on or off.
+	 * @details In caching mode the grid is rendered into a texture, which is then copied to the
+	 * screen each frame until the grid is reported changed with markDirty(), setGrid() or
+	 * scrollTo(). A screen that rarely changes, such as a help page, then costs a single blit per
+	 * frame. The copy replaces the pixels under the grid rather than blending with them, and the
+	 * projection transform may scale and translate the grid but not rotate it.
+	 */
+	void setCachingEnabled(bool enabled);
+	bool isCachingEnabled() const {return m_isCaching;}
+
+	///@brief Upload @a area of the grid, in grid coordinates, on the next render.
+	///@details Only needed in scrolling and caching mode; otherwise the whole grid is uploaded every frame.
+	void markDirty(const Rectanglei& area);
+	///Upload the whole grid on the next render.
+	void markDirty() {m_needsFullUpload = true; m_isCacheDirty = true;}
+
 	static std::shared_ptr<gl::ShaderProgram> createDefaultShaders(gl::Context* context);
+	///Create shaders for scrolling mode, which place each tile from its wrapped buffer slot.
+	static std::shared_ptr<gl::ShaderProgram> createScrollingShaders(gl::Context* context);
 
 protected:
+	///Link @a vertexShaderSource with the fragment shader every renderer program uses, binding the attribute locations.
+	static std::shared_ptr<gl::ShaderProgram> linkShaders(const std::string& vertexShaderSource, gl::Context* context);
 
 	struct DynVertexAttribs
 	{
@@ -45,9 +107,24 @@ protected:
 		uint32_t bgColor;
 	};
 
+	///Upload the grid as needed and draw it with @a transform.
+	void drawGrid(const Matrix3f& transform);
+	///Bring the cache texture up to date and copy it to where drawGrid() with @a transform would draw.
+	void drawCached(const Matrix3f& transform);
+
 	void initializeStaticBuffers();
 	void fillDynamicAttributeBuffer();
 	void createVertexArrayObject();
+	void bindTileTexture();
+
+	///Write the four vertices of @a tile to @a vertices.
+	void writeTileAttributes(const Tile& tile, DynVertexAttribs* vertices);
+
+	///Upload the dirty areas of the grid into their wrapped slots.
+	void uploadScrollingChanges();
+	void uploadWrappedRows(const Rectanglei& area);
+	///Return the buffer slot of grid cell @a x or @a y along an axis of length @a size.
+	static int wrap(int value, int size) {return ((value % size) + size) % size;}
 
 	gl::Context* m_context;
 
@@ -63,6 +140,19 @@ protected:
 
 	std::shared_ptr<gl::ShaderProgram> m_shader;
 
+	bool m_isScrolling = false;
+	bool m_needsFullUpload = true;
+	Vector2i m_scrollOrigin = Vector2i(0, 0);
+	Vector2f m_subTileOffset = Vector2f(0, 0);
+	///Areas to upload, in world coordinates so they stay correct across scrolling.
+	std::vector<Rectanglei> m_dirtyAreas;
+	std::vector<DynVertexAttribs> m_uploadBuffer;
+
+	bool m_isCaching = false;
+	bool m_isCacheDirty = true;
+	std::unique_ptr<gl::Texture2d> m_cacheTexture;
+	std::unique_ptr<gl::Framebuffer> m_cacheFramebuffer;
+
 	static constexpr int dynComponentsPerVertex = 7;
 	static constexpr int staticComponentsPerVertex = 2;
 	static constexpr int verticesPerTile = 4;
@@ -0,0 +1,39 @@
+#include "Framework/TileGridSnapshotBuffer.h"
+
+namespace rf
+{
+
+TileGridSnapshotBuffer::TileGridSnapshotBuffer(int width, int height):
+	m_sharedIndex(1)
+{
+	m_grids.reserve(3);
+	for(int i = 0; i < 3; ++i)
+	{
+		m_grids.emplace_back(width, height);
+	}
+}
+
+void TileGridSnapshotBuffer::publish(bool preserveContents)
+{
+	int published = m_writeIndex;
+	int previous = m_sharedIndex.exchange(published | NewSnapshotFlag, std::memory_order_acq_rel);
+	m_writeIndex = previous & IndexMask;
+
+	if(preserveContents)
+	{
+		//The consumer may be reading the published grid now, but it never writes to it.
+		m_grids[m_writeIndex] = m_grids[published];
+	}
+}
+
+const TileGrid& TileGridSnapshotBuffer::acquireSnapshot()
+{
+	if(hasNewSnapshot())
+	{
+		int previous = m_sharedIndex.exchange(m_readIndex, std::memory_order_acq_rel);
+		m_readIndex = previous & IndexMask;
+	}
+	return m_grids[m_readIndex];
+}
+
+}
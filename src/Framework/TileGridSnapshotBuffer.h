@@ -0,0 +1,73 @@
+#ifndef TILEGRIDSNAPSHOTBUFFER_H_
+#define TILEGRIDSNAPSHOTBUFFER_H_
+
+#include <atomic>
+#include <vector>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief Hands TileGrid contents from one producing thread to one consuming thread without locking.
+ * @details The producer (usually the simulation thread) draws into writeGrid() and calls publish()
+ * when the grid is complete. The consumer (usually the render thread) calls acquireSnapshot() to get
+ * the most recently published grid, which stays valid and unchanged until its next call
+ * to acquireSnapshot().
+ *
+ * Three grids are rotated through a single atomic slot, so neither side ever waits on the other:
+ * publishing never overwrites the grid being read, and acquiring never sees a half-written grid.
+ * Snapshots published faster than they are acquired are simply skipped.
+ */
+class TileGridSnapshotBuffer
+{
+public:
+	TileGridSnapshotBuffer(int width, int height);
+	~TileGridSnapshotBuffer() = default;
+
+	TileGridSnapshotBuffer(const TileGridSnapshotBuffer&) = delete;
+	TileGridSnapshotBuffer(TileGridSnapshotBuffer&&) = delete;
+	TileGridSnapshotBuffer& operator =(const TileGridSnapshotBuffer&) = delete;
+	TileGridSnapshotBuffer& operator =(TileGridSnapshotBuffer&&) = delete;
+
+	int width() const {return m_grids[0].width();}
+	int height() const {return m_grids[0].height();}
+
+	///Return the grid being written by the producer. Only the producing thread may use this.
+	TileGrid& writeGrid() {return m_grids[m_writeIndex];}
+
+	/**
+	 * @brief Publish the contents of writeGrid() as the newest snapshot.
+	 * @details writeGrid() refers to a different grid afterwards. If @a preserveContents is true,
+	 * the published contents are copied into it so the producer can keep making incremental
+	 * changes, otherwise its contents are those of an older snapshot and should be redrawn.
+	 * Only the producing thread may call this.
+	 */
+	void publish(bool preserveContents = true);
+
+	/**
+	 * @brief Return the most recently published snapshot.
+	 * @details Before anything is published this returns a default constructed grid.
+	 * Only the consuming thread may call this.
+	 */
+	const TileGrid& acquireSnapshot();
+
+	///Return true if a snapshot has been published since the last call to acquireSnapshot().
+	bool hasNewSnapshot() const {return (m_sharedIndex.load(std::memory_order_relaxed) & NewSnapshotFlag) != 0;}
+
+protected:
+	static constexpr int NewSnapshotFlag = 0x4;
+	static constexpr int IndexMask = 0x3;
+
+	std::vector<TileGrid> m_grids;
+
+	///Index of the grid in neither thread's hands, or'd with NewSnapshotFlag if it is unread.
+	std::atomic<int> m_sharedIndex;
+	int m_writeIndex = 0;
+	int m_readIndex = 2;
+};
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "Framework/TileGridView.h"
 
+#include "Framework/TileBlit.h"
+
 namespace rf
 {
 
@@ -49,4 +51,38 @@ TileGridView& TileGridView::operator =(TileGridView&& other) noexcept
 	return *this;
 }
 
+void TileGridView::copyFrom(const TileGridView& source)
+{
+	blit(TileGridView(source.m_position.x, source.m_position.y, std::min(source.width(), width()),
+			std::min(source.height(), height()), source.m_grid), Vector2i(0, 0));
+}
+
+void TileGridView::blit(const TileGridView& source, const Vector2i& position)
+{
+	int x = position.x;
+	int y = position.y;
+	int blitWidth = source.width();
+	int blitHeight = source.height();
+	if(!clipBox(x, y, blitWidth, blitHeight))
+	{
+		return;
+	}
+	int sourceX = x - position.x;
+	int sourceY = y - position.y;
+
+	//When both views are on the same grid and the destination rows lie above the
+	//source rows, copy from the top down so no row is overwritten before it is read.
+	bool topDown = source.m_grid == m_grid && y + m_position.y > sourceY + source.m_position.y;
+	for(int row = 0; row < blitHeight; ++row)
+	{
+		int yOffset = topDown ? blitHeight - 1 - row : row;
+		tilespan::copy(source.rowBegin(sourceY + yOffset) + sourceX, blitWidth, rowBegin(y + yOffset) + x);
+	}
+}
+
+void TileGridView::blit(const TileGridView& source, const Vector2i& position, const BlitMask& mask)
+{
+	rf::blit(source, *this, position, mask);
+}
+
 }
@@ -2,11 +2,14 @@
 #define TILEGRIDVIEW_H_
 
 #include <cassert>
+#include <algorithm>
 
 #include "Framework/TileGrid.h"
+#include "Framework/TileSpan.h"
 
 namespace rf
 {
+struct BlitMask;
 
 class TileGridView
 {
@@ -37,6 +40,11 @@ public:
 
 	TileGrid* getBaseGrid() const {return m_grid;}
 
+	///@brief Return a pointer to the first tile of row @a y of the view.
+	///@details The width() tiles of a row are contiguous in memory.
+	Tile* rowBegin(int y);
+	const Tile* rowBegin(int y) const {return const_cast<TileGridView*>(this)->rowBegin(y);}
+
 	void fill(const Tile& newTile);
 	void fillForegroundColor(const Color& color);
 	void fillBackgroundColor(const Color& color);
@@ -68,9 +76,46 @@ public:
 	void setBoxTileIndex(const Rectanglei& box, unsigned int index)
 		{ setBoxTileIndex(box.left(), box.bottom(), box.width(), box.height(), index);}
 
+	/**
+	 * @brief Copy the contents of @a source into this view.
+	 * @details Only the area the two views have in common, starting at their bottom-left
+	 * corners, is copied. The views may overlap.
+	 */
+	void copyFrom(const TileGridView& source);
+
+	/**
+	 * @brief Copy the whole of @a source into this view with its bottom-left corner at @a position.
+	 * @details Parts of @a source that fall outside this view are clipped. The views may overlap.
+	 */
+	void blit(const TileGridView& source, const Vector2i& position);
+
+	///Combine @a source into this view at @a position as selected by @a mask. See rf::blit().
+	void blit(const TileGridView& source, const Vector2i& position, const BlitMask& mask);
+
 	template<typename FnType>
 	void applyToAll(const FnType& fn);
 
+	/**
+	 * @brief Call @a fn once for each row of the view.
+	 * @details @a fn is called as fn(Tile* rowBegin, Tile* rowEnd, int y), where the tiles in
+	 * [rowBegin, rowEnd) are contiguous. This avoids the per-tile index computation of applyToAll().
+	 */
+	template<typename FnType>
+	void applyToRows(const FnType& fn);
+
+	/**
+	 * @brief Call @a fn once for each row of the part of a box that lies within the view.
+	 * @details The box is clipped to the view once, and @a fn is called as
+	 * fn(Tile* rowBegin, Tile* rowEnd, int y) with the clipped span of each row.
+	 */
+	template<typename FnType>
+	void applyToRowsInBox(int x, int y, int width, int height, const FnType& fn);
+	template<typename FnType>
+	void applyToRowsInBox(const Rectanglei& box, const FnType& fn)
+	{
+		applyToRowsInBox(box.left(), box.bottom(), box.width(), box.height(), fn);
+	}
+
 	template<typename FnType>
 	void applyToLine(int x1, int y1, int x2, int y2, const FnType& fn);
 	template<typename FnType>
@@ -88,6 +133,9 @@ public:
 	}
 
 protected:
+	///Clip a box to the view, returning false if nothing is left of it.
+	bool clipBox(int& x, int& y, int& width, int& height) const;
+
 	TileGrid* m_grid;
 
 	Vector2i m_position;
@@ -109,6 +157,23 @@ inline Tile& TileGridView::getTile(size_t index)
 	return m_grid->getTile(x + m_position.x, y + m_position.y);
 }
 
+inline Tile* TileGridView::rowBegin(int y)
+{
+	assert(y >= 0 && y < m_size.y);
+	return &m_grid->getTile(m_position.x, y + m_position.y);
+}
+
+inline bool TileGridView::clipBox(int& x, int& y, int& width, int& height) const
+{
+	int right = std::min(x + width, m_size.x);
+	int top = std::min(y + height, m_size.y);
+	x = std::max(x, 0);
+	y = std::max(y, 0);
+	width = right - x;
+	height = top - y;
+	return width > 0 && height > 0;
+}
+
 inline void TileGridView::setTile(size_t index, const Tile& value)
 {
 	assert(index >= 0 && index < m_size.x * m_size.y);
@@ -119,39 +184,38 @@ inline void TileGridView::setTile(size_t index, const Tile& value)
 
 inline void TileGridView::fill(const Tile& newTile)
 {
-	applyToAll(
-		[newTile](Tile& tile)
+	applyToRows(
+		[&newTile](Tile* begin, Tile* end, int)
 		{
-			tile = newTile;
+			tilespan::fill(begin, end, newTile);
 		});
 }
 
 inline void TileGridView::fillForegroundColor(const Color& color)
 {
-	applyToAll(
-		[color](Tile& tile)
+	applyToRows(
+		[&color](Tile* begin, Tile* end, int)
 		{
-			tile.setForegroundColor(color);
+			tilespan::fillForegroundColor(begin, end, color);
 		});
 }
 
 inline void TileGridView::fillBackgroundColor(const Color& color)
 {
-	applyToAll(
-		[color](Tile& tile)
+	applyToRows(
+		[&color](Tile* begin, Tile* end, int)
 		{
-			tile.setBackgroundColor(color);
+			tilespan::fillBackgroundColor(begin, end, color);
 		});
 }
 
 inline void TileGridView::fillTileIndex(unsigned int newIndex)
 {
-	applyToAll(
-		[newIndex](Tile& tile)
+	applyToRows(
+		[newIndex](Tile* begin, Tile* end, int)
 		{
-			tile.setTileIndex(newIndex);
-		}
-	);
+			tilespan::fillTileIndex(begin, end, newIndex);
+		});
 }
 
 inline void TileGridView::setLine(int x1, int y1, int x2, int y2, const Tile& newTile)
@@ -195,52 +259,79 @@ inline void TileGridView::setLineTileIndex(int x1, int y1, int x2, int y2,
 
 inline void TileGridView::setBox(int x, int y, int width, int height, const Tile& newTile)
 {
-	applyToBox(x, y, width, height,
-		[newTile](Tile& tile)
+	applyToRowsInBox(x, y, width, height,
+		[&newTile](Tile* begin, Tile* end, int)
 		{
-			tile = newTile;
+			tilespan::fill(begin, end, newTile);
 		});
 }
 
 inline void TileGridView::setBoxBackgroundColor(int x, int y, int width, int height,
 		const Color& color)
 {
-	applyToBox(x, y, width, height,
-		[color](Tile& tile)
+	applyToRowsInBox(x, y, width, height,
+		[&color](Tile* begin, Tile* end, int)
 		{
-			tile.setBackgroundColor(color);
+			tilespan::fillBackgroundColor(begin, end, color);
 		});
 }
 
 inline void TileGridView::setBoxForegroundColor(int x, int y, int width, int height,
 		const Color& color)
 {
-	applyToBox(x, y, width, height,
-		[color](Tile& tile)
+	applyToRowsInBox(x, y, width, height,
+		[&color](Tile* begin, Tile* end, int)
 		{
-			tile.setForegroundColor(color);
+			tilespan::fillForegroundColor(begin, end, color);
 		});
 }
 
 inline void TileGridView::setBoxTileIndex(int x, int y, int width, int height,
 		unsigned int index)
 {
-	applyToBox(x, y, width, height,
-		[index](Tile& tile)
+	applyToRowsInBox(x, y, width, height,
+		[index](Tile* begin, Tile* end, int)
 		{
-			tile.setTileIndex(index);
+			tilespan::fillTileIndex(begin, end, index);
 		});
 }
 
 template<typename FnType>
 inline void TileGridView::applyToAll(const FnType& fn)
+{
+	applyToRows(
+		[&fn](Tile* begin, Tile* end, int)
+		{
+			for(Tile* tile = begin; tile != end; ++tile)
+			{
+				fn(*tile);
+			}
+		});
+}
+
+template<typename FnType>
+inline void TileGridView::applyToRows(const FnType& fn)
 {
 	for(int y = 0; y < m_size.y; ++y)
 	{
-		for(int x = 0; x < m_size.x; ++x)
-		{
-			fn(getTile(x, y));
-		}
+		Tile* begin = rowBegin(y);
+		fn(begin, begin + m_size.x, y);
+	}
+}
+
+template<typename FnType>
+inline void TileGridView::applyToRowsInBox(int x, int y, int width, int height,
+		const FnType& fn)
+{
+	if(!clipBox(x, y, width, height))
+	{
+		return;
+	}
+
+	for(int yPos = y; yPos < y + height; ++yPos)
+	{
+		Tile* begin = rowBegin(yPos) + x;
+		fn(begin, begin + width, yPos);
 	}
 }
 
@@ -279,24 +370,14 @@ template<typename FnType>
 inline void TileGridView::applyToBox(int x, int y, int width, int height,
 		const FnType& fn)
 {
-	assert(x >= 0);
-	assert(y >= 0);
-
-	for(int yPos = 0; yPos < height; ++yPos)
-	{
-		if(y + yPos >= m_size.y)
-		{
-			break;
-		}
-		for(int xPos = 0; xPos < width; ++xPos)
+	applyToRowsInBox(x, y, width, height,
+		[&fn](Tile* begin, Tile* end, int)
 		{
-			if(x + xPos >= m_size.x)
+			for(Tile* tile = begin; tile != end; ++tile)
 			{
-				break;
+				fn(*tile);
 			}
-			fn(getTile(x + xPos, y + yPos));
-		}
-	}
+		});
 }
 
 }
@@ -0,0 +1,108 @@
+#ifndef TILESPAN_H_
+#define TILESPAN_H_
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include "Framework/Tile.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rf
+{
+
+/**
+ * @brief Bulk operations on contiguous runs of tiles, such as a row of a TileGridView.
+ * @details A Tile is three 32-bit words, so four consecutive tiles fill exactly three 128-bit
+ * vectors. The single-field fills use that to replace one word in every three with masked
+ * vector stores, leaving the other two fields untouched.
+ */
+namespace tilespan
+{
+
+namespace detail
+{
+
+///Set the 32-bit word at byte offset @a fieldOffset of every tile in [@a begin, @a end) to @a value.
+inline void fillField(Tile* begin, Tile* end, size_t fieldOffset, uint32_t value)
+{
+	unsigned char* bytes = reinterpret_cast<unsigned char*>(begin);
+	size_t count = end - begin;
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	const int fieldWord = static_cast<int>(fieldOffset / sizeof(uint32_t));
+	//Word k of a group of four tiles belongs to field k % 3.
+	__m128i masks[3];
+	for(int v = 0; v < 3; ++v)
+	{
+		masks[v] = _mm_setr_epi32((4 * v) % 3 == fieldWord ? -1 : 0, (4 * v + 1) % 3 == fieldWord ? -1 : 0,
+				(4 * v + 2) % 3 == fieldWord ? -1 : 0, (4 * v + 3) % 3 == fieldWord ? -1 : 0);
+	}
+	const __m128i values = _mm_set1_epi32(static_cast<int>(value));
+
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128i* group = reinterpret_cast<__m128i*>(bytes + i * sizeof(Tile));
+		for(int v = 0; v < 3; ++v)
+		{
+			__m128i old = _mm_loadu_si128(group + v);
+			__m128i merged = _mm_or_si128(_mm_and_si128(masks[v], values), _mm_andnot_si128(masks[v], old));
+			_mm_storeu_si128(group + v, merged);
+		}
+	}
+#endif
+
+	for(; i < count; ++i)
+	{
+		std::memcpy(bytes + i * sizeof(Tile) + fieldOffset, &value, sizeof(value));
+	}
+}
+
+}
+
+///Set every tile in [@a begin, @a end) to @a tile.
+inline void fill(Tile* begin, Tile* end, const Tile& tile)
+{
+	std::fill(begin, end, tile);
+}
+
+///Set the foreground color of every tile in [@a begin, @a end).
+inline void fillForegroundColor(Tile* begin, Tile* end, const Color& color)
+{
+	uint32_t word;
+	std::memcpy(&word, &color, sizeof(word));
+	detail::fillField(begin, end, Tile::foregroundColorOffset(), word);
+}
+
+///Set the background color of every tile in [@a begin, @a end).
+inline void fillBackgroundColor(Tile* begin, Tile* end, const Color& color)
+{
+	uint32_t word;
+	std::memcpy(&word, &color, sizeof(word));
+	detail::fillField(begin, end, Tile::backgroundColorOffset(), word);
+}
+
+///Set the tile index of every tile in [@a begin, @a end).
+inline void fillTileIndex(Tile* begin, Tile* end, unsigned int index)
+{
+	detail::fillField(begin, end, Tile::tileIndexOffset(), index);
+}
+
+///Copy @a count tiles from @a source to @a destination. The two runs may overlap.
+inline void copy(const Tile* source, size_t count, Tile* destination)
+{
+	std::memmove(static_cast<void*>(destination), source, count * sizeof(Tile));
+}
+
+static_assert(sizeof(Color) == sizeof(uint32_t) && sizeof(unsigned int) == sizeof(uint32_t),
+		"Single-field fills assume a Tile is made of three 32-bit words");
+
+}
+
+}
+
+#endif
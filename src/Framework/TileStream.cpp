@@ -0,0 +1,318 @@
+#include "Framework/TileStream.h"
+
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "Framework/Exceptions/OutOfBoundsException.h"
+#include "Framework/TileSpan.h"
+
+namespace rf
+{
+
+constexpr uint32_t TileStreamEncoder::MaxDictionarySize;
+
+namespace
+{
+
+const uint32_t keyframeFlag = 1;
+///Unchanged cells between two changed spans of a row up to which the spans are sent as one.
+const int maxMergedGap = 1;
+
+inline void writeVarint(uint32_t value, std::vector<uint8_t>& message)
+{
+	while(value >= 0x80)
+	{
+		message.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	message.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint32_t colorKey(const Color& color)
+{
+	return (uint32_t(color.red) << 24) | (uint32_t(color.green) << 16) | (uint32_t(color.blue) << 8) | color.alpha;
+}
+
+///Reads values out of a message, throwing if it runs past the end.
+class MessageReader
+{
+public:
+	MessageReader(const uint8_t* data, size_t size):
+		m_position(data), m_end(data + size)
+	{
+	}
+
+	uint32_t readVarint()
+	{
+		uint32_t value = 0;
+		for(int shift = 0; shift < 35; shift += 7)
+		{
+			uint8_t byte = readByte();
+			value |= uint32_t(byte & 0x7F) << shift;
+			if((byte & 0x80) == 0)
+			{
+				return value;
+			}
+		}
+		throw OutOfBoundsException("Tile stream message has an invalid number");
+	}
+
+	uint8_t readByte()
+	{
+		if(m_position == m_end)
+		{
+			throw OutOfBoundsException("Tile stream message is truncated");
+		}
+		return *m_position++;
+	}
+
+	bool atEnd() const {return m_position == m_end;}
+
+private:
+	const uint8_t* m_position;
+	const uint8_t* m_end;
+};
+
+///Read a dictionary reference from @a reader: zero followed by a literal, or one more than an index.
+template<typename Type, typename ReadLiteralType>
+Type readReference(MessageReader& reader, std::vector<Type>& dictionary, const ReadLiteralType& readLiteral)
+{
+	uint32_t reference = reader.readVarint();
+	if(reference == 0)
+	{
+		Type value = readLiteral();
+		if(dictionary.size() < TileStreamEncoder::MaxDictionarySize)
+		{
+			dictionary.push_back(value);
+		}
+		return value;
+	}
+	if(reference > dictionary.size())
+	{
+		throw OutOfBoundsException("Tile stream message refers to an unknown dictionary entry");
+	}
+	return dictionary[reference - 1];
+}
+
+}
+
+void TileStreamEncoder::encode(const TileGrid& grid, std::vector<uint8_t>& message)
+{
+	message.clear();
+	const int width = grid.width();
+	const int height = grid.height();
+
+	if(m_needsKeyframe || width != m_previous.width() || height != m_previous.height())
+	{
+		m_needsKeyframe = false;
+		m_colors.clear();
+		m_tileIndices.clear();
+		m_previous = grid;
+
+		writeVarint(keyframeFlag, message);
+		writeVarint(static_cast<uint32_t>(width), message);
+		writeVarint(static_cast<uint32_t>(height), message);
+		uint32_t count = static_cast<uint32_t>(width) * height;
+		writeVarint(count > 0 ? 1 : 0, message);
+		if(count > 0)
+		{
+			writeVarint(0, message);
+			writeVarint(count, message);
+			encodeSpan(grid.data(), static_cast<int>(count), message);
+		}
+		return;
+	}
+
+	//Spans are found first so their count can lead the message.
+	struct Span
+	{
+		size_t begin;
+		int length;
+	};
+	std::vector<Span> spans;
+	for(int y = 0; y < height; ++y)
+	{
+		const Tile* row = grid.data() + static_cast<size_t>(y) * width;
+		Tile* previousRow = m_previous.data() + static_cast<size_t>(y) * width;
+		if(std::memcmp(static_cast<const void*>(row), static_cast<const void*>(previousRow), width * sizeof(Tile)) == 0)
+		{
+			continue;
+		}
+
+		int x = 0;
+		while(x < width)
+		{
+			if(row[x] == previousRow[x])
+			{
+				++x;
+				continue;
+			}
+			int end = x + 1;
+			int lastChange = x;
+			while(end < width && end - lastChange <= maxMergedGap + 1)
+			{
+				if(row[end] != previousRow[end])
+				{
+					lastChange = end;
+				}
+				++end;
+			}
+			end = lastChange + 1;
+			spans.push_back({static_cast<size_t>(y) * width + x, end - x});
+			tilespan::copy(row + x, end - x, previousRow + x);
+			x = end;
+		}
+	}
+
+	writeVarint(0, message);
+	writeVarint(static_cast<uint32_t>(spans.size()), message);
+	size_t position = 0;
+	for(const Span& span : spans)
+	{
+		writeVarint(static_cast<uint32_t>(span.begin - position), message);
+		writeVarint(static_cast<uint32_t>(span.length), message);
+		encodeSpan(grid.data() + span.begin, span.length, message);
+		position = span.begin + span.length;
+	}
+}
+
+void TileStreamEncoder::encodeSpan(const Tile* tiles, int count, std::vector<uint8_t>& message)
+{
+	int x = 0;
+	while(x < count)
+	{
+		int end = x + 1;
+		while(end < count && tiles[end] == tiles[x])
+		{
+			++end;
+		}
+		writeVarint(static_cast<uint32_t>(end - x), message);
+		encodeColor(tiles[x].foregroundColor(), message);
+		encodeColor(tiles[x].backgroundColor(), message);
+		encodeTileIndex(tiles[x].tileIndex(), message);
+		x = end;
+	}
+}
+
+void TileStreamEncoder::encodeColor(const Color& color, std::vector<uint8_t>& message)
+{
+	uint32_t key = colorKey(color);
+	auto it = m_colors.find(key);
+	if(it != m_colors.end())
+	{
+		writeVarint(it->second + 1, message);
+		return;
+	}
+
+	writeVarint(0, message);
+	message.push_back(color.red);
+	message.push_back(color.green);
+	message.push_back(color.blue);
+	message.push_back(color.alpha);
+	if(m_colors.size() < MaxDictionarySize)
+	{
+		uint32_t index = static_cast<uint32_t>(m_colors.size());
+		m_colors.emplace(key, index);
+	}
+}
+
+void TileStreamEncoder::encodeTileIndex(unsigned int tileIndex, std::vector<uint8_t>& message)
+{
+	auto it = m_tileIndices.find(tileIndex);
+	if(it != m_tileIndices.end())
+	{
+		writeVarint(it->second + 1, message);
+		return;
+	}
+
+	writeVarint(0, message);
+	writeVarint(tileIndex, message);
+	if(m_tileIndices.size() < MaxDictionarySize)
+	{
+		uint32_t index = static_cast<uint32_t>(m_tileIndices.size());
+		m_tileIndices.emplace(tileIndex, index);
+	}
+}
+
+void TileStreamDecoder::decode(const uint8_t* message, size_t size, TileGrid& grid)
+{
+	MessageReader reader(message, size);
+	uint32_t flags = reader.readVarint();
+	if(flags & keyframeFlag)
+	{
+		uint64_t width = reader.readVarint();
+		uint64_t height = reader.readVarint();
+		//TileGrid indexes its tiles with int, so larger sizes can only come from a corrupt message.
+		if(width * height > static_cast<uint64_t>(std::numeric_limits<int>::max())
+				|| width * height > std::numeric_limits<size_t>::max() / sizeof(Tile))
+		{
+			throw OutOfBoundsException("Tile stream keyframe has an invalid size");
+		}
+		if(static_cast<int>(width) != grid.width() || static_cast<int>(height) != grid.height())
+		{
+			try
+			{
+				grid = TileGrid(static_cast<int>(width), static_cast<int>(height));
+			}
+			catch(const std::bad_alloc&)
+			{
+				throw OutOfBoundsException("Tile stream keyframe is too large to decode");
+			}
+		}
+		m_colors.clear();
+		m_tileIndices.clear();
+		m_hasKeyframe = true;
+	}
+	else if(!m_hasKeyframe)
+	{
+		throw OutOfBoundsException("Tile stream must start with a keyframe");
+	}
+
+	auto readColor = [&reader]()
+	{
+		Color color;
+		color.red = reader.readByte();
+		color.green = reader.readByte();
+		color.blue = reader.readByte();
+		color.alpha = reader.readByte();
+		return color;
+	};
+	auto readTileIndex = [&reader]()
+	{
+		return static_cast<unsigned int>(reader.readVarint());
+	};
+
+	size_t tileCount = static_cast<size_t>(grid.width()) * grid.height();
+	size_t position = 0;
+	uint32_t spanCount = reader.readVarint();
+	for(uint32_t span = 0; span < spanCount; ++span)
+	{
+		uint32_t gap = reader.readVarint();
+		uint32_t length = reader.readVarint();
+		if(gap > tileCount - position || length > tileCount - position - gap)
+		{
+			throw OutOfBoundsException("Tile stream span lies outside the grid");
+		}
+
+		position += gap;
+		Tile* tiles = grid.data() + position;
+		uint32_t x = 0;
+		while(x < length)
+		{
+			uint32_t run = reader.readVarint();
+			if(run == 0 || run > length - x)
+			{
+				throw OutOfBoundsException("Tile stream run does not fit its span");
+			}
+			Color foreground = readReference(reader, m_colors, readColor);
+			Color background = readReference(reader, m_colors, readColor);
+			unsigned int tileIndex = readReference(reader, m_tileIndices, readTileIndex);
+			tilespan::fill(tiles + x, tiles + x + run, Tile(foreground, background, tileIndex));
+			x += run;
+		}
+		position += length;
+	}
+}
+
+}
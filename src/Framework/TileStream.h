@@ -0,0 +1,85 @@
+#ifndef TILESTREAM_H_
+#define TILESTREAM_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Framework/TileGrid.h"
+
+namespace rf
+{
+
+/**
+ * @brief Encodes the changes to a TileGrid from frame to frame as compact messages.
+ * @details Used to mirror a grid to another view or process, such as a spectator window, without
+ * sending the whole grid every frame. Each call to encode() compares the grid with the frame sent
+ * last and emits only the spans of cells that changed. Inside a span, repeated tiles are sent as
+ * runs, and colors and tile indices are sent once and then referred to by their index in a
+ * dictionary that the TileStreamDecoder rebuilds from the same messages.
+ *
+ * The first message, and the first after the grid changes size or requestKeyframe() is called,
+ * is a keyframe holding the whole grid, which is where a new decoder must start.
+ */
+class TileStreamEncoder
+{
+public:
+	TileStreamEncoder() = default;
+	~TileStreamEncoder() = default;
+
+	TileStreamEncoder(const TileStreamEncoder&) = delete;
+	TileStreamEncoder(TileStreamEncoder&&) = default;
+	TileStreamEncoder& operator =(const TileStreamEncoder&) = delete;
+	TileStreamEncoder& operator =(TileStreamEncoder&&) = default;
+
+	///Replace @a message with the changes to @a grid since the previous call.
+	void encode(const TileGrid& grid, std::vector<uint8_t>& message);
+
+	///Make the next message a keyframe, such as when a new viewer connects.
+	void requestKeyframe() {m_needsKeyframe = true;}
+
+	///The dictionaries stop growing at this many entries; later values are sent literally.
+	static constexpr uint32_t MaxDictionarySize = 16384;
+
+protected:
+	void encodeSpan(const Tile* tiles, int count, std::vector<uint8_t>& message);
+	void encodeColor(const Color& color, std::vector<uint8_t>& message);
+	void encodeTileIndex(unsigned int tileIndex, std::vector<uint8_t>& message);
+
+	TileGrid m_previous = TileGrid(0, 0);
+	bool m_needsKeyframe = true;
+
+	std::unordered_map<uint32_t, uint32_t> m_colors;
+	std::unordered_map<unsigned int, uint32_t> m_tileIndices;
+};
+
+/**
+ * @brief Applies messages from a TileStreamEncoder to a TileGrid.
+ * @details Messages must be decoded in the order they were encoded, starting with a keyframe.
+ */
+class TileStreamDecoder
+{
+public:
+	TileStreamDecoder() = default;
+	~TileStreamDecoder() = default;
+
+	/**
+	 * @brief Apply @a message to @a grid.
+	 * @details A keyframe replaces @a grid with a grid of the keyframe's size if it has another size.
+	 * @throw OutOfBoundsException if the message is malformed, or is not a keyframe and no keyframe
+	 * has been decoded yet.
+	 */
+	void decode(const uint8_t* message, size_t size, TileGrid& grid);
+	void decode(const std::vector<uint8_t>& message, TileGrid& grid) {decode(message.data(), message.size(), grid);}
+
+	bool hasKeyframe() const {return m_hasKeyframe;}
+
+protected:
+	bool m_hasKeyframe = false;
+	std::vector<Color> m_colors;
+	std::vector<unsigned int> m_tileIndices;
+};
+
+}
+
+#endif
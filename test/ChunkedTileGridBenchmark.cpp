@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/ChunkStorage.h"
+#include "Framework/ChunkedTileGrid.h"
+#include "Framework/TileGrid.h"
+#include "Framework/TileGridView.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int worldSize = 4096;
+const int chunkSize = 32;
+const int screenWidth = 160;
+const int screenHeight = 50;
+///Frames panned by BM_PanWindow, each taking at least a millisecond.
+const int panFrames = 1000;
+
+///A storage that already holds the whole world and takes @a latency to load each chunk, like a disk.
+class SimulatedChunkStorage: public ChunkStorage
+{
+public:
+	explicit SimulatedChunkStorage(std::chrono::microseconds latency):
+		m_latency(latency)
+	{
+	}
+
+	virtual bool loadChunk(const Vector2i& chunk, std::vector<Tile>& tiles) override
+	{
+		std::this_thread::sleep_for(m_latency);
+		auto saved = m_saved.find(std::make_pair(chunk.x, chunk.y));
+		if(saved != m_saved.end())
+		{
+			tiles = saved->second;
+			return true;
+		}
+		std::fill(tiles.begin(), tiles.end(), Tile(Color(200, 200, 200), Color(0, 0, 0), 'a' + (chunk.x + chunk.y) % 26));
+		return true;
+	}
+
+	virtual void saveChunk(const Vector2i& chunk, const std::vector<Tile>& tiles) override
+	{
+		m_saved[std::make_pair(chunk.x, chunk.y)] = tiles;
+	}
+
+private:
+	std::chrono::microseconds m_latency;
+	std::map<std::pair<int, int>, std::vector<Tile>> m_saved;
+};
+
+///Count the tiles of the window that show the default tile because their chunk has not loaded yet.
+int countMissingTiles(const ChunkedTileGrid& world, const Vector2i& position)
+{
+	int missing = 0;
+	for(int y = position.y; y < position.y + screenHeight; ++y)
+	{
+		for(int x = position.x; x < position.x + screenWidth; ++x)
+		{
+			if(!world.isResident(x, y))
+			{
+				++missing;
+			}
+		}
+	}
+	return missing;
+}
+
+/**
+ * Pan a screen-sized window across the world one tile per frame, with chunks taking 2 ms
+ * each to load and 1 ms between frames, and the prefetch margin given as the argument.
+ * Reports the tiles still missing per frame and the longest frame, which would be a stall.
+ */
+void BM_PanWindow(benchmark::State& state)
+{
+	ChunkedTileGrid world(worldSize, worldSize, chunkSize, 256,
+			std::unique_ptr<ChunkStorage>(new SimulatedChunkStorage(std::chrono::microseconds(2000))));
+	ChunkedTileGridWindow window(&world, screenWidth, screenHeight);
+	window.setPrefetchMargin(state.range(0));
+	Vector2i position(0, worldSize / 2);
+	window.setPosition(position);
+
+	//Give the first screen and its margin time to load, as a game would behind a loading screen.
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	window.update();
+
+	int64_t missingTiles = 0;
+	double longestFrame = 0.0;
+	for(auto _ : state)
+	{
+		auto start = std::chrono::steady_clock::now();
+		++position.x;
+		window.setPosition(position);
+		window.update();
+		benchmark::DoNotOptimize(window.grid().data());
+		longestFrame = std::max(longestFrame, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+		state.PauseTiming();
+		missingTiles += countMissingTiles(world, position);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		state.ResumeTiming();
+	}
+	state.counters["missingTilesPerFrame"] = benchmark::Counter(static_cast<double>(missingTiles), benchmark::Counter::kAvgIterations);
+	state.counters["longestFrameUs"] = longestFrame;
+	state.counters["residentChunks"] = static_cast<double>(world.residentChunkCount());
+}
+
+/**
+ * Walk a player diagonally across the given number of tiles of an in-memory world, marking
+ * the tiles around it as explored. Reports the memory of the resident chunks next to that
+ * of a dense TileGrid of the whole world.
+ */
+void BM_ExploreMemory(benchmark::State& state)
+{
+	int distance = state.range(0);
+	size_t residentChunks = 0;
+	for(auto _ : state)
+	{
+		ChunkedTileGrid world(worldSize, worldSize, chunkSize);
+		for(int step = 0; step < distance; ++step)
+		{
+			world.setBox(Rectanglei(step - 2, step - 2, 5, 5), Tile(Color(255, 255, 255), Color(0, 0, 0), '.'));
+		}
+		residentChunks = world.residentChunkCount();
+		benchmark::DoNotOptimize(residentChunks);
+	}
+	double chunkBytes = static_cast<double>(chunkSize * chunkSize * sizeof(Tile));
+	state.counters["residentChunks"] = static_cast<double>(residentChunks);
+	state.counters["residentMB"] = residentChunks * chunkBytes / (1024.0 * 1024.0);
+	state.counters["denseMB"] = static_cast<double>(worldSize) * worldSize * sizeof(Tile) / (1024.0 * 1024.0);
+}
+
+///Copy a screen from a fully resident chunked world, for comparison with BM_CopyScreenDense.
+void BM_CopyScreenChunked(benchmark::State& state)
+{
+	ChunkedTileGrid world(worldSize, worldSize, chunkSize);
+	Rectanglei area(1000, 1000, screenWidth * 4, screenHeight * 4);
+	world.setBox(area, Tile(Color(255, 255, 255), Color(0, 0, 0), '#'));
+	TileGrid screen(screenWidth, screenHeight);
+	TileGridView view(&screen);
+	int frame = 0;
+	for(auto _ : state)
+	{
+		//Unaligned to the chunks, so the copy crosses chunk edges like a panning camera.
+		world.copyTo(Vector2i(area.left() + 7 + frame % 300, area.bottom() + 5 + frame % 100), view);
+		benchmark::ClobberMemory();
+		++frame;
+	}
+	state.SetItemsProcessed(state.iterations() * screenWidth * screenHeight);
+}
+
+void BM_CopyScreenDense(benchmark::State& state)
+{
+	TileGrid world(worldSize, worldSize);
+	Rectanglei area(1000, 1000, screenWidth * 4, screenHeight * 4);
+	TileGrid screen(screenWidth, screenHeight);
+	TileGridView view(&screen);
+	int frame = 0;
+	for(auto _ : state)
+	{
+		TileGridView source(area.left() + 7 + frame % 300, area.bottom() + 5 + frame % 100, screenWidth, screenHeight, &world);
+		view.blit(source, Vector2i(0, 0));
+		benchmark::ClobberMemory();
+		++frame;
+	}
+	state.SetItemsProcessed(state.iterations() * screenWidth * screenHeight);
+}
+
+}
+
+//Prefetch margins: none, the default of one chunk and two chunks.
+BENCHMARK(BM_PanWindow)->Arg(0)->Arg(chunkSize)->Arg(chunkSize * 2)->Iterations(panFrames)->Unit(benchmark::kMicrosecond)->UseRealTime();
+//Distances explored: a dungeon floor, a region and the whole diagonal of the world.
+BENCHMARK(BM_ExploreMemory)->Arg(256)->Arg(1024)->Arg(worldSize)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CopyScreenChunked)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CopyScreenDense)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
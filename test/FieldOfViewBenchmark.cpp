@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/Fov/FieldOfView.h"
+#include "Framework/Fov/OpacityMap.h"
+#include "Framework/Jobs/JobSystem.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int mapSize = 200;
+const int viewerCount = 100;
+
+///A 200x200 map with walls around rooms of 20x20 tiles, doors in every wall and scattered pillars.
+OpacityMap makeMap()
+{
+	OpacityMap map(mapSize, mapSize);
+	uint32_t random = 12345;
+	for(int y = 0; y < mapSize; ++y)
+	{
+		for(int x = 0; x < mapSize; ++x)
+		{
+			random = random * 1664525u + 1013904223u;
+			bool isWall = (x % 20 == 0 && y % 20 != 10) || (y % 20 == 0 && x % 20 != 10);
+			bool isPillar = (random >> 24) < 16;
+			map.setOpaque(x, y, isWall || isPillar);
+		}
+	}
+	return map;
+}
+
+///Spread the viewers evenly over the map, like the monsters of a level.
+void addViewers(FieldOfViewCache& cache, int radius)
+{
+	for(int i = 0; i < viewerCount; ++i)
+	{
+		cache.addViewer(Vector2i(5 + (i % 10) * 20, 5 + (i / 10) * 20), radius);
+	}
+}
+
+///One viewer in the middle of the map, such as the player.
+void BM_SingleViewer(benchmark::State& state, FieldOfView::Algorithm algorithm)
+{
+	OpacityMap map = makeMap();
+	FieldOfView fieldOfView;
+	for(auto _ : state)
+	{
+		fieldOfView.compute(map, Vector2i(mapSize / 2 + 5, mapSize / 2 + 5), state.range(0), algorithm);
+		benchmark::DoNotOptimize(fieldOfView.visibleCount());
+	}
+}
+
+///Every viewer is recomputed in each iteration, on the calling thread.
+void BM_BatchSerial(benchmark::State& state, FieldOfView::Algorithm algorithm)
+{
+	OpacityMap map = makeMap();
+	FieldOfViewCache cache(algorithm);
+	addViewers(cache, state.range(0));
+	for(auto _ : state)
+	{
+		cache.invalidate();
+		benchmark::DoNotOptimize(cache.update(map));
+	}
+	state.SetItemsProcessed(state.iterations() * viewerCount);
+}
+
+///Every viewer is recomputed in each iteration, spread over a JobSystem.
+void BM_BatchParallel(benchmark::State& state, FieldOfView::Algorithm algorithm)
+{
+	OpacityMap map = makeMap();
+	FieldOfViewCache cache(algorithm);
+	addViewers(cache, state.range(0));
+	JobSystem jobSystem;
+	for(auto _ : state)
+	{
+		cache.invalidate();
+		benchmark::DoNotOptimize(cache.update(map, &jobSystem));
+	}
+	state.SetItemsProcessed(state.iterations() * viewerCount);
+}
+
+///A door in a corner of the map opens or closes each turn, so only the viewers that can see it are recomputed.
+void BM_BatchIncremental(benchmark::State& state, FieldOfView::Algorithm algorithm)
+{
+	OpacityMap map = makeMap();
+	FieldOfViewCache cache(algorithm);
+	addViewers(cache, state.range(0));
+	cache.update(map);
+	bool isOpen = true;
+	int64_t recomputed = 0;
+	for(auto _ : state)
+	{
+		map.setOpaque(20, 10, isOpen);
+		isOpen = !isOpen;
+		recomputed += cache.update(map);
+	}
+	state.counters["recomputedPerTurn"] = benchmark::Counter(static_cast<double>(recomputed), benchmark::Counter::kAvgIterations);
+}
+
+}
+
+//The radii requested: a torch, a lit room and an open field.
+#define FOV_BENCHMARK(function, name, algorithm) \
+	BENCHMARK_CAPTURE(function, name, FieldOfView::Algorithm::algorithm)->Arg(10)->Arg(30)->Arg(60)->Unit(benchmark::kMicrosecond)
+
+FOV_BENCHMARK(BM_SingleViewer, recursive, RecursiveShadowcasting);
+FOV_BENCHMARK(BM_SingleViewer, symmetric, SymmetricShadowcasting);
+FOV_BENCHMARK(BM_BatchSerial, recursive, RecursiveShadowcasting);
+FOV_BENCHMARK(BM_BatchSerial, symmetric, SymmetricShadowcasting);
+FOV_BENCHMARK(BM_BatchParallel, recursive, RecursiveShadowcasting)->UseRealTime();
+FOV_BENCHMARK(BM_BatchParallel, symmetric, SymmetricShadowcasting)->UseRealTime();
+FOV_BENCHMARK(BM_BatchIncremental, recursive, RecursiveShadowcasting);
+FOV_BENCHMARK(BM_BatchIncremental, symmetric, SymmetricShadowcasting);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include "Framework/Generation/BspGenerator.h"
+#include "Framework/Generation/CaveGenerator.h"
+#include "Framework/Generation/NoiseField.h"
+#include "Framework/Jobs/JobSystem.h"
+#include "Framework/TileGrid.h"
+#include "Framework/TileGridView.h"
+
+using namespace rf;
+
+namespace
+{
+
+const Tile wallTile(Color(128, 128, 128), Color(0, 0, 0), '#');
+const Tile floorTile(Color(128, 128, 128), Color(0, 0, 0), '.');
+
+//Each benchmark generates a square level of the size given as the argument, serially and then on a
+//JobSystem, with a new seed each iteration as at every stair transition.
+
+void BM_Cave(benchmark::State& state)
+{
+	CaveGenerator generator(state.range(0), state.range(0));
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		generator.generate(++seed);
+		benchmark::DoNotOptimize(generator.walls().count());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void BM_CaveParallel(benchmark::State& state)
+{
+	CaveGenerator generator(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		generator.generate(++seed, 4, &jobSystem);
+		benchmark::DoNotOptimize(generator.walls().count());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+///Turning the cave into tiles, which the level needs after generation whichever path is taken.
+void BM_CaveApply(benchmark::State& state)
+{
+	CaveGenerator generator(state.range(0), state.range(0));
+	generator.generate(1);
+	TileGrid grid(state.range(0), state.range(0));
+	TileGridView view(&grid);
+	for(auto _ : state)
+	{
+		generator.apply(view, wallTile, floorTile);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void BM_Bsp(benchmark::State& state)
+{
+	BspGenerator generator(state.range(0), state.range(0));
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		generator.generate(++seed);
+		benchmark::DoNotOptimize(generator.rooms().size());
+	}
+	state.counters["rooms"] = static_cast<double>(generator.rooms().size());
+}
+
+void BM_BspParallel(benchmark::State& state)
+{
+	BspGenerator generator(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		generator.generate(++seed, &jobSystem);
+		benchmark::DoNotOptimize(generator.rooms().size());
+	}
+	state.counters["rooms"] = static_cast<double>(generator.rooms().size());
+}
+
+void BM_BspApply(benchmark::State& state)
+{
+	BspGenerator generator(state.range(0), state.range(0));
+	generator.generate(1);
+	TileGrid grid(state.range(0), state.range(0));
+	TileGridView view(&grid);
+	for(auto _ : state)
+	{
+		generator.apply(view, wallTile, floorTile);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void BM_Noise(benchmark::State& state)
+{
+	NoiseField field(state.range(0), state.range(0));
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		field.generate(++seed, 1.0f / 32.0f);
+		benchmark::DoNotOptimize(field.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+void BM_NoiseParallel(benchmark::State& state)
+{
+	NoiseField field(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	uint64_t seed = 0;
+	for(auto _ : state)
+	{
+		field.generate(++seed, 1.0f / 32.0f, 4, 0.5f, &jobSystem);
+		benchmark::DoNotOptimize(field.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+}
+
+//Level sizes: a dungeon floor, a large cave and an overworld.
+#define GENERATION_BENCHMARK(function) \
+	BENCHMARK(function)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)
+
+GENERATION_BENCHMARK(BM_Cave);
+GENERATION_BENCHMARK(BM_CaveParallel)->UseRealTime();
+GENERATION_BENCHMARK(BM_CaveApply);
+GENERATION_BENCHMARK(BM_Bsp);
+GENERATION_BENCHMARK(BM_BspParallel)->UseRealTime();
+GENERATION_BENCHMARK(BM_BspApply);
+GENERATION_BENCHMARK(BM_Noise);
+GENERATION_BENCHMARK(BM_NoiseParallel)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/Jobs/JobSystem.h"
+#include "Framework/TileGrid.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int rowsPerJob = 8;
+
+///Light the tiles of @a area from a point in the middle of the grid, a typical per-tile pass.
+void shade(TileGrid& grid, const Rectanglei& area)
+{
+	float centerX = grid.width() * 0.5f;
+	float centerY = grid.height() * 0.5f;
+	for(int y = area.bottom(); y < area.top(); ++y)
+	{
+		Tile* row = &grid.getTile(0, y);
+		for(int x = area.left(); x < area.right(); ++x)
+		{
+			float dx = x - centerX;
+			float dy = y - centerY;
+			float light = 1.0f / (1.0f + 0.01f * std::sqrt(dx * dx + dy * dy));
+			uint8_t value = static_cast<uint8_t>(255.0f * light);
+			row[x].setForegroundColor(Color(value, value, static_cast<uint8_t>(value / 2)));
+		}
+	}
+}
+
+void shadeRows(TileGrid& grid, int firstRow, int lastRow)
+{
+	shade(grid, Rectanglei(0, firstRow, grid.width(), lastRow - firstRow));
+}
+
+int threadCount()
+{
+	return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void BM_Serial(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	for(auto _ : state)
+	{
+		shadeRows(grid, 0, grid.height());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+void BM_StdAsync(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	int bandCount = threadCount();
+	std::vector<std::future<void>> bands;
+	for(auto _ : state)
+	{
+		//One thread per hardware thread, each taking an equal band of rows.
+		int rowsPerBand = (grid.height() + bandCount - 1) / bandCount;
+		for(int first = 0; first < grid.height(); first += rowsPerBand)
+		{
+			int last = std::min(first + rowsPerBand, grid.height());
+			bands.push_back(std::async(std::launch::async, [&grid, first, last]()
+				{
+					shadeRows(grid, first, last);
+				}));
+		}
+		for(std::future<void>& band : bands)
+		{
+			band.get();
+		}
+		bands.clear();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+void BM_JobSystemParallelFor(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	for(auto _ : state)
+	{
+		jobSystem.parallelFor(0, grid.height(), rowsPerJob,
+			[&grid](int first, int last)
+			{
+				shadeRows(grid, first, last);
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+void BM_JobSystemRegion(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	for(auto _ : state)
+	{
+		jobSystem.parallelFor(Rectanglei(0, 0, grid.width(), grid.height()), Vector2i(64, 16),
+			[&grid](const Rectanglei& block)
+			{
+				shade(grid, block);
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+///A task per band of rows, all depending on a first task. BM_StdAsyncPerBand is the same with std::async.
+void BM_JobSystemTaskGraph(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	JobSystem jobSystem;
+	std::vector<JobSystem::TaskHandle> tasks;
+	for(auto _ : state)
+	{
+		JobSystem::TaskHandle clear = jobSystem.createTask([&grid]()
+			{
+				grid.getTile(0, 0) = Tile();
+			});
+		for(int first = 0; first < grid.height(); first += rowsPerJob)
+		{
+			int last = std::min(first + rowsPerJob, grid.height());
+			JobSystem::TaskHandle task = jobSystem.createTask([&grid, first, last]()
+				{
+					shadeRows(grid, first, last);
+				});
+			jobSystem.addDependency(task, clear);
+			jobSystem.submit(task);
+			tasks.push_back(std::move(task));
+		}
+		jobSystem.submit(clear);
+		jobSystem.wait(tasks);
+		tasks.clear();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+void BM_StdAsyncPerBand(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(0));
+	std::vector<std::future<void>> bands;
+	for(auto _ : state)
+	{
+		for(int first = 0; first < grid.height(); first += rowsPerJob)
+		{
+			int last = std::min(first + rowsPerJob, grid.height());
+			bands.push_back(std::async(std::launch::async, [&grid, first, last]()
+				{
+					shadeRows(grid, first, last);
+				}));
+		}
+		for(std::future<void>& band : bands)
+		{
+			band.get();
+		}
+		bands.clear();
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * grid.width() * grid.height());
+}
+
+}
+
+//Grid sizes: a typical screen, a large map and a very large map.
+BENCHMARK(BM_Serial)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StdAsync)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_JobSystemParallelFor)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_JobSystemRegion)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_JobSystemTaskGraph)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_StdAsyncPerBand)->Arg(80)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/Pathfinding/CostMap.h"
+#include "Framework/Pathfinding/GridPathfinder.h"
+#include "Framework/Pathfinding/HierarchicalPathfinder.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int mapSize = 1000;
+
+///A generated map and a long trip across it, such as travelling to the stairs.
+struct Scenario
+{
+	Scenario():
+		costs(mapSize, mapSize)
+	{
+	}
+
+	CostMap costs;
+	Vector2i start;
+	Vector2i goal;
+};
+
+uint32_t hash(int x, int y)
+{
+	uint32_t value = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+	value ^= value >> 13;
+	value *= 0x5bd1e995u;
+	return value ^ (value >> 15);
+}
+
+///Return smooth noise in [0, 1]: four octaves of value noise, the first with a lattice of 32 cells.
+float valueNoise(int x, int y)
+{
+	float total = 0.0f;
+	float amplitude = 1.0f;
+	float amplitudes = 0.0f;
+	for(int octave = 0; octave < 4; ++octave)
+	{
+		int spacing = 32 >> octave;
+		int cellX = x / spacing;
+		int cellY = y / spacing;
+		float fractionX = static_cast<float>(x % spacing) / spacing;
+		float fractionY = static_cast<float>(y % spacing) / spacing;
+		auto lattice = [octave](int latticeX, int latticeY)
+		{
+			return (hash(latticeX + octave * 7919, latticeY) & 0xffff) / 65535.0f;
+		};
+		float bottom = lattice(cellX, cellY) + (lattice(cellX + 1, cellY) - lattice(cellX, cellY)) * fractionX;
+		float top = lattice(cellX, cellY + 1) + (lattice(cellX + 1, cellY + 1) - lattice(cellX, cellY + 1)) * fractionX;
+		total += (bottom + (top - bottom) * fractionY) * amplitude;
+		amplitudes += amplitude;
+		amplitude *= 0.5f;
+	}
+	return total / amplitudes;
+}
+
+///Return the passable cell nearest to @a position along the diagonal toward the middle of the map.
+Vector2i nearestPassable(const CostMap& costs, const Vector2i& position)
+{
+	Vector2i step(position.x < mapSize / 2 ? 1 : -1, position.y < mapSize / 2 ? 1 : -1);
+	Vector2i result = position;
+	while(!costs.isPassable(result.x, result.y))
+	{
+		result += step;
+	}
+	return result;
+}
+
+///Open terrain with lakes and mountains from value noise; the case jump point search is made for.
+const Scenario& overworld()
+{
+	static Scenario scenario;
+	static bool isGenerated = false;
+	if(!isGenerated)
+	{
+		for(int y = 0; y < mapSize; ++y)
+		{
+			for(int x = 0; x < mapSize; ++x)
+			{
+				scenario.costs.setCost(x, y, valueNoise(x, y) > 0.7f ? CostMap::Impassable : 1);
+			}
+		}
+		scenario.start = nearestPassable(scenario.costs, Vector2i(5, 5));
+		scenario.goal = nearestPassable(scenario.costs, Vector2i(mapSize - 5, mapSize - 5));
+		isGenerated = true;
+	}
+	return scenario;
+}
+
+void carve(CostMap& costs, int left, int bottom, int right, int top)
+{
+	for(int y = bottom; y <= top; ++y)
+	{
+		for(int x = left; x <= right; ++x)
+		{
+			costs.setCost(x, y, 1);
+		}
+	}
+}
+
+/**
+ * A 25x25 grid of rooms of random sizes, each joined by a corridor to the room east of it.
+ * Rooms in the first column, and a third of the others, are also joined to the room north,
+ * so every room is reachable but the trip between opposite corners winds.
+ */
+const Scenario& dungeon()
+{
+	static Scenario scenario;
+	static bool isGenerated = false;
+	if(!isGenerated)
+	{
+		const int cellSize = 40;
+		const int cells = mapSize / cellSize;
+		scenario.costs = CostMap(mapSize, mapSize, CostMap::Impassable);
+		std::vector<Vector2i> centers;
+		for(int cellY = 0; cellY < cells; ++cellY)
+		{
+			for(int cellX = 0; cellX < cells; ++cellX)
+			{
+				uint32_t random = hash(cellX, cellY);
+				int width = 6 + random % 24;
+				int height = 6 + random / 24 % 24;
+				int left = cellX * cellSize + 2 + random / 576 % (cellSize - 4 - width);
+				int bottom = cellY * cellSize + 2 + random / 20000 % (cellSize - 4 - height);
+				carve(scenario.costs, left, bottom, left + width - 1, bottom + height - 1);
+				centers.push_back(Vector2i(left + width / 2, bottom + height / 2));
+			}
+		}
+		for(int cellY = 0; cellY < cells; ++cellY)
+		{
+			for(int cellX = 0; cellX < cells; ++cellX)
+			{
+				const Vector2i& center = centers[cellX + cellY * cells];
+				if(cellX + 1 < cells)
+				{
+					//An L-shaped corridor: along the row of this room, then along the column of the next.
+					const Vector2i& east = centers[cellX + 1 + cellY * cells];
+					carve(scenario.costs, center.x, center.y, east.x, center.y);
+					carve(scenario.costs, east.x, std::min(center.y, east.y), east.x, std::max(center.y, east.y));
+				}
+				if(cellY + 1 < cells && (cellX == 0 || hash(cellY, cellX) % 3 == 0))
+				{
+					const Vector2i& north = centers[cellX + (cellY + 1) * cells];
+					carve(scenario.costs, center.x, center.y, center.x, north.y);
+					carve(scenario.costs, std::min(center.x, north.x), north.y, std::max(center.x, north.x), north.y);
+				}
+			}
+		}
+		scenario.start = centers.front();
+		scenario.goal = centers.back();
+		isGenerated = true;
+	}
+	return scenario;
+}
+
+typedef const Scenario& (*ScenarioFunction)();
+
+///Return the cost of the optimal path, to compare the paths of the other searches against.
+int optimalCost(const Scenario& scenario)
+{
+	GridPathfinder pathfinder(mapSize, mapSize);
+	std::vector<Vector2i> path;
+	return pathfinder.findPath(scenario.costs, scenario.start, scenario.goal, path) ? pathfinder.pathCost() : GridPathfinder::NoPath;
+}
+
+void BM_AStar(benchmark::State& state, ScenarioFunction getScenario)
+{
+	const Scenario& scenario = getScenario();
+	GridPathfinder pathfinder(mapSize, mapSize);
+	std::vector<Vector2i> path;
+	for(auto _ : state)
+	{
+		if(!pathfinder.findPath(scenario.costs, scenario.start, scenario.goal, path))
+		{
+			state.SkipWithError("No path");
+			break;
+		}
+	}
+	state.counters["pathLength"] = static_cast<double>(path.size());
+	state.counters["pathCost"] = pathfinder.pathCost();
+}
+
+void BM_JumpPointSearch(benchmark::State& state, ScenarioFunction getScenario)
+{
+	const Scenario& scenario = getScenario();
+	GridPathfinder pathfinder(mapSize, mapSize);
+	std::vector<Vector2i> path;
+	for(auto _ : state)
+	{
+		if(!pathfinder.findPathJps(scenario.costs, scenario.start, scenario.goal, path))
+		{
+			state.SkipWithError("No path");
+			break;
+		}
+	}
+	state.counters["pathLength"] = static_cast<double>(path.size());
+	state.counters["pathCost"] = pathfinder.pathCost();
+}
+
+///A query on a cluster graph that is already built.
+void BM_Hierarchical(benchmark::State& state, ScenarioFunction getScenario)
+{
+	const Scenario& scenario = getScenario();
+	HierarchicalPathfinder pathfinder(mapSize, mapSize, state.range(0));
+	pathfinder.update(scenario.costs);
+	std::vector<Vector2i> path;
+	for(auto _ : state)
+	{
+		if(!pathfinder.findPath(scenario.costs, scenario.start, scenario.goal, path))
+		{
+			state.SkipWithError("No path");
+			break;
+		}
+	}
+	state.counters["pathLength"] = static_cast<double>(path.size());
+	state.counters["pathCost"] = pathfinder.pathCost();
+	state.counters["costOverOptimal"] = static_cast<double>(pathfinder.pathCost()) / optimalCost(scenario);
+	state.counters["nodes"] = pathfinder.nodeCount();
+}
+
+///Building the whole cluster graph, as when a level is entered.
+void BM_HierarchicalBuild(benchmark::State& state, ScenarioFunction getScenario)
+{
+	const Scenario& scenario = getScenario();
+	for(auto _ : state)
+	{
+		HierarchicalPathfinder pathfinder(mapSize, mapSize, state.range(0));
+		benchmark::DoNotOptimize(pathfinder.update(scenario.costs));
+	}
+}
+
+///A door in the middle of the map opens or closes, so only the clusters around it are rebuilt.
+void BM_HierarchicalUpdate(benchmark::State& state, ScenarioFunction getScenario)
+{
+	CostMap costs = getScenario().costs;
+	HierarchicalPathfinder pathfinder(mapSize, mapSize, state.range(0));
+	pathfinder.update(costs);
+	bool isOpen = false;
+	int64_t rebuilt = 0;
+	for(auto _ : state)
+	{
+		costs.setCost(mapSize / 2, mapSize / 2, isOpen ? 1 : CostMap::Impassable);
+		isOpen = !isOpen;
+		rebuilt += pathfinder.update(costs);
+	}
+	state.counters["clustersRebuilt"] = benchmark::Counter(static_cast<double>(rebuilt), benchmark::Counter::kAvgIterations);
+}
+
+}
+
+BENCHMARK_CAPTURE(BM_AStar, overworld, overworld)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AStar, dungeon, dungeon)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_JumpPointSearch, overworld, overworld)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_JumpPointSearch, dungeon, dungeon)->Unit(benchmark::kMillisecond);
+//Cluster sizes: the default and twice it.
+BENCHMARK_CAPTURE(BM_Hierarchical, overworld, overworld)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Hierarchical, dungeon, dungeon)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_HierarchicalBuild, overworld, overworld)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_HierarchicalBuild, dungeon, dungeon)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_HierarchicalUpdate, overworld, overworld)->Arg(16)->Arg(32)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_HierarchicalUpdate, dungeon, dungeon)->Arg(16)->Arg(32)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/TerminalRenderer.h"
+#include "Framework/TileGrid.h"
+
+using namespace rf;
+
+namespace
+{
+
+///Fill @a grid with terrain in a handful of colors, including glyphs outside ASCII, shifted by @a phase.
+void drawTerrain(TileGrid& grid, int phase)
+{
+	static const unsigned int glyphs[] = {'.', '#', '~', 0xB7, 0x2591, 0x2588, '"', '^'};
+	static const Color colors[] = {Color(0, 160, 0), Color(160, 160, 160), Color(60, 120, 255), Color(200, 180, 90),
+			Color(90, 60, 30), Color(255, 255, 255), Color(0, 200, 60), Color(120, 120, 140)};
+	for(int y = 0; y < grid.height(); ++y)
+	{
+		for(int x = 0; x < grid.width(); ++x)
+		{
+			int kind = ((x + phase) / 5 + y / 3) % 8;
+			grid.setTile(x, y, Tile(colors[kind], kind == 2 ? Color(0, 0, 80) : Color(0, 0, 0), glyphs[kind]));
+		}
+	}
+}
+
+TerminalRenderer::ColorMode colorMode(const benchmark::State& state)
+{
+	return state.range(2) == 0 ? TerminalRenderer::ColorMode::TrueColor : TerminalRenderer::ColorMode::Palette256;
+}
+
+///Every cell is redrawn, as on the first frame or after the terminal is resized.
+void BM_Redraw(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(1));
+	drawTerrain(grid, 0);
+	TerminalRenderer renderer(&grid, 1, colorMode(state));
+	std::string output;
+	int64_t bytes = 0;
+	for(auto _ : state)
+	{
+		renderer.invalidate();
+		output.clear();
+		renderer.render(output);
+		bytes += output.size();
+	}
+	state.counters["bytesPerFrame"] = benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+}
+
+///Every cell changes each frame, as when the whole map scrolls by one column.
+void BM_FullUpdate(benchmark::State& state)
+{
+	TileGrid frames[2] = {TileGrid(state.range(0), state.range(1)), TileGrid(state.range(0), state.range(1))};
+	drawTerrain(frames[0], 0);
+	drawTerrain(frames[1], 1);
+	TerminalRenderer renderer(&frames[0], 1, colorMode(state));
+	std::string output;
+	renderer.render(output);
+	int64_t bytes = 0;
+	int frame = 0;
+	for(auto _ : state)
+	{
+		renderer.setGrid(&frames[++frame % 2]);
+		output.clear();
+		renderer.render(output);
+		bytes += output.size();
+	}
+	state.counters["bytesPerFrame"] = benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+}
+
+///Two cells change each frame: the player steps onto one and leaves the one it stood on.
+void BM_SparseUpdate(benchmark::State& state)
+{
+	TileGrid grid(state.range(0), state.range(1));
+	drawTerrain(grid, 0);
+	TerminalRenderer renderer(&grid, 1, colorMode(state));
+	std::string output;
+	renderer.render(output);
+	int64_t bytes = 0;
+	int frame = 0;
+	for(auto _ : state)
+	{
+		int x = frame % grid.width();
+		int y = frame / grid.width() % grid.height();
+		Tile floor = grid.getTile(x, y);
+		grid.setTile(x, y, Tile(Color(255, 255, 255), Color(0, 0, 0), '@'));
+		output.clear();
+		renderer.render(output);
+		bytes += output.size();
+		grid.setTile(x, y, floor);
+		++frame;
+	}
+	state.counters["bytesPerFrame"] = benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+}
+
+///As BM_SparseUpdate, including the write() to a file descriptor, here /dev/null.
+void BM_SparseUpdateWrite(benchmark::State& state)
+{
+	int descriptor = open("/dev/null", O_WRONLY);
+	TileGrid grid(state.range(0), state.range(1));
+	drawTerrain(grid, 0);
+	TerminalRenderer renderer(&grid, descriptor, colorMode(state));
+	renderer.render();
+	int frame = 0;
+	for(auto _ : state)
+	{
+		int x = frame % grid.width();
+		int y = frame / grid.width() % grid.height();
+		Tile floor = grid.getTile(x, y);
+		grid.setTile(x, y, Tile(Color(255, 255, 255), Color(0, 0, 0), '@'));
+		renderer.render();
+		grid.setTile(x, y, floor);
+		++frame;
+	}
+	close(descriptor);
+}
+
+}
+
+//Terminal sizes and color modes: 80x24 and 160x50, each in truecolor (0) and the 256-color palette (1).
+#define TERMINAL_BENCHMARK(function) \
+	BENCHMARK(function)->Args({80, 24, 0})->Args({80, 24, 1})->Args({160, 50, 0})->Args({160, 50, 1})->Unit(benchmark::kMicrosecond)
+
+TERMINAL_BENCHMARK(BM_Redraw);
+TERMINAL_BENCHMARK(BM_FullUpdate);
+TERMINAL_BENCHMARK(BM_SparseUpdate);
+TERMINAL_BENCHMARK(BM_SparseUpdateWrite);
+
+BENCHMARK_MAIN();
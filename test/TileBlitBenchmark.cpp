@@ -0,0 +1,213 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/Colorf.h"
+#include "Framework/TileBlit.h"
+#include "Framework/TileGrid.h"
+#include "Framework/TileGridView.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int screenWidth = 160;
+const int screenHeight = 50;
+const int panelCount = 30;
+
+///Thirty panels of assorted sizes, such as an inventory, a minimap and a message log, some hanging off the screen.
+struct Screen
+{
+	Screen():
+		screen(screenWidth, screenHeight)
+	{
+		panels.reserve(panelCount);
+		for(int i = 0; i < panelCount; ++i)
+		{
+			int width = 8 + (i * 7) % 33;
+			int height = 4 + (i * 5) % 17;
+			panels.emplace_back(width, height);
+			for(int y = 0; y < height; ++y)
+			{
+				for(int x = 0; x < width; ++x)
+				{
+					//Every fourth tile is transparent to the keyed and blended blits.
+					bool isTransparent = (x + y) % 4 == 0;
+					panels.back().setTile(x, y, Tile(Color(200, 200, 200, isTransparent ? 0 : 255),
+							Color(20, 20, 60, isTransparent ? 0 : 160), isTransparent ? 0 : 'a' + i));
+				}
+			}
+			positions.emplace_back((i * 37) % (screenWidth + 10) - 10, (i * 13) % (screenHeight + 4) - 4);
+		}
+	}
+
+	TileGrid screen;
+	std::vector<TileGrid> panels;
+	std::vector<Vector2i> positions;
+};
+
+int panelTileCount(const Screen& screen)
+{
+	int count = 0;
+	for(const TileGrid& panel : screen.panels)
+	{
+		count += panel.width() * panel.height();
+	}
+	return count;
+}
+
+///The approach blit() replaces: every tile goes through getTile() and setTile() with its own bounds check.
+template<typename FnType>
+void compositePerTile(Screen& screen, const FnType& combine)
+{
+	TileGridView destination(&screen.screen);
+	for(int i = 0; i < panelCount; ++i)
+	{
+		TileGridView source(&screen.panels[i]);
+		const Vector2i& position = screen.positions[i];
+		for(int y = 0; y < source.height(); ++y)
+		{
+			for(int x = 0; x < source.width(); ++x)
+			{
+				int toX = x + position.x;
+				int toY = y + position.y;
+				if(toX >= 0 && toY >= 0 && toX < destination.width() && toY < destination.height())
+				{
+					destination.setTile(toX, toY, combine(source.getTile(x, y), destination.getTile(toX, toY)));
+				}
+			}
+		}
+	}
+}
+
+void compositeBlit(Screen& screen, const BlitMask& mask)
+{
+	TileGridView destination(&screen.screen);
+	for(int i = 0; i < panelCount; ++i)
+	{
+		blit(TileGridView(&screen.panels[i]), destination, screen.positions[i], mask);
+	}
+}
+
+void BM_PerTileCopy(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositePerTile(screen, [](const Tile& from, const Tile&)
+			{
+				return from;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_BlitCopy(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositeBlit(screen, BlitMask::copy());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_PerTileGlyphOnly(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositePerTile(screen, [](const Tile& from, const Tile& to)
+			{
+				Tile result = to;
+				result.setTileIndex(from.tileIndex());
+				return result;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_BlitGlyphOnly(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositeBlit(screen, BlitMask::copy(TileChannel::TileIndex));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_PerTileKeyed(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositePerTile(screen, [](const Tile& from, const Tile& to)
+			{
+				return from.tileIndex() != 0 ? from : to;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_BlitKeyed(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositeBlit(screen, BlitMask::tileIndexKey(0));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_PerTileAlphaBlend(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositePerTile(screen, [](const Tile& from, const Tile& to)
+			{
+				Tile result = to;
+				if(from.foregroundColor().alpha != 0)
+				{
+					result.setTileIndex(from.tileIndex());
+				}
+				result.setForegroundColor(Color(Colorf::alphaBlend(from.foregroundColor(), to.foregroundColor())));
+				result.setBackgroundColor(Color(Colorf::alphaBlend(from.backgroundColor(), to.backgroundColor())));
+				return result;
+			});
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+void BM_BlitAlphaBlend(benchmark::State& state)
+{
+	Screen screen;
+	for(auto _ : state)
+	{
+		compositeBlit(screen, BlitMask::alphaBlend());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * panelTileCount(screen));
+}
+
+}
+
+BENCHMARK(BM_PerTileCopy)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BlitCopy)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PerTileGlyphOnly)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BlitGlyphOnly)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PerTileKeyed)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BlitKeyed)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PerTileAlphaBlend)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BlitAlphaBlend)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,231 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Framework/MessageChannel.h"
+#include "Framework/TileGrid.h"
+#include "Framework/TileStream.h"
+
+using namespace rf;
+
+namespace
+{
+
+const int screenWidth = 160;
+const int screenHeight = 50;
+const int mapHeight = 44;
+const int frameCount = 240;
+
+enum class Session
+{
+	///The player walks around a room while monsters move and the log fills.
+	Explore,
+	///As Explore, but the camera follows the player, so the whole map scrolls every frame.
+	Pan,
+	///As Explore, with an inventory panel opening and closing.
+	Menu,
+	///Nothing happens but a blinking cursor.
+	Idle
+};
+
+uint32_t hash(int x, int y)
+{
+	uint32_t value = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+	value ^= value >> 13;
+	value *= 0x5bd1e995u;
+	return value ^ (value >> 15);
+}
+
+Tile terrain(int worldX, int worldY)
+{
+	uint32_t value = hash(worldX, worldY);
+	if(value % 10 == 0)
+	{
+		return Tile(Color(160, 160, 160), Color(40, 40, 40), '#');
+	}
+	if((worldX / 12 + worldY / 9) % 5 == 0)
+	{
+		return Tile(Color(60, 120, 255), Color(0, 0, 80), '~');
+	}
+	return Tile(Color(0, 160 + value % 3 * 20, 0), Color(0, 0, 0), value % 4 == 0 ? '"' : '.');
+}
+
+void writeText(TileGrid& screen, int x, int y, const std::string& text, const Color& color)
+{
+	for(size_t i = 0; i < text.size() && x + static_cast<int>(i) < screenWidth; ++i)
+	{
+		screen.setTile(x + i, y, Tile(color, Color(0, 0, 0), static_cast<unsigned char>(text[i])));
+	}
+}
+
+///Draw frame @a frame of @a session from scratch, the way a game redraws its console every frame.
+void drawFrame(Session session, int frame, TileGrid& screen)
+{
+	//Idle sessions stand still on the first frame.
+	int turn = session == Session::Idle ? 0 : frame;
+	Vector2i player(20 + turn % 120, 10 + (turn / 20) % 20);
+	int cameraX = session == Session::Pan ? player.x - screenWidth / 2 : 0;
+
+	for(int y = 0; y < mapHeight; ++y)
+	{
+		for(int x = 0; x < screenWidth; ++x)
+		{
+			screen.setTile(x, y, terrain(x + cameraX, y));
+		}
+	}
+	for(int i = 0; i < 8; ++i)
+	{
+		//Monsters step every other turn.
+		uint32_t step = hash(i, turn / 2);
+		int x = (i * 19 + step % 5) % screenWidth;
+		int y = (i * 5 + step / 5 % 5) % mapHeight;
+		screen.setTile(x, y, Tile(Color(255, 64, 64), Color(0, 0, 0), 'a' + i));
+	}
+	screen.setTile(player.x - cameraX, player.y, Tile(Color(255, 255, 255), Color(0, 0, 0), '@'));
+
+	for(int y = mapHeight; y < screenHeight; ++y)
+	{
+		for(int x = 0; x < screenWidth; ++x)
+		{
+			screen.setTile(x, y, Tile(Color(0, 0, 0), Color(0, 0, 0), ' '));
+		}
+	}
+	writeText(screen, 0, mapHeight, "HP " + std::to_string(40 - turn / 30 % 20) + "/40  Turn " + std::to_string(turn),
+			Color(255, 255, 0));
+	for(int line = 0; line < 4; ++line)
+	{
+		//A new message every ten turns pushes the log up.
+		int message = turn / 10 - line;
+		if(message >= 0)
+		{
+			writeText(screen, 0, screenHeight - 1 - line, "Message " + std::to_string(message) + ": the kobold hits you.",
+					Color(200, 200, 200));
+		}
+	}
+
+	if(session == Session::Menu && frame / 30 % 2 == 1)
+	{
+		for(int y = 10; y < 30; ++y)
+		{
+			for(int x = 60; x < 100; ++x)
+			{
+				screen.setTile(x, y, Tile(Color(255, 255, 255), Color(20, 20, 60), ' '));
+			}
+			writeText(screen, 62, y, std::string(1, static_cast<char>('a' + y - 10)) + ") a rusty dagger", Color(255, 255, 255));
+		}
+	}
+	if(session == Session::Idle && frame / 15 % 2 == 1)
+	{
+		screen.setTile(player.x, player.y, Tile(Color(0, 0, 0), Color(255, 255, 255), '@'));
+	}
+}
+
+///Stands in for a recorded session: every frame of it, as the game showed them.
+const std::vector<TileGrid>& recording(Session session)
+{
+	static std::vector<TileGrid> recordings[4];
+	std::vector<TileGrid>& frames = recordings[static_cast<int>(session)];
+	if(frames.empty())
+	{
+		frames.reserve(frameCount);
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			frames.emplace_back(screenWidth, screenHeight);
+			drawFrame(session, frame, frames.back());
+		}
+	}
+	return frames;
+}
+
+///Encode the whole session in each iteration. The first message is a keyframe, the rest are deltas.
+void BM_Encode(benchmark::State& state, Session session)
+{
+	const std::vector<TileGrid>& frames = recording(session);
+	std::vector<uint8_t> message;
+	size_t keyframeBytes = 0;
+	size_t deltaBytes = 0;
+	for(auto _ : state)
+	{
+		TileStreamEncoder encoder;
+		deltaBytes = 0;
+		for(int frame = 0; frame < frameCount; ++frame)
+		{
+			encoder.encode(frames[frame], message);
+			if(frame == 0)
+			{
+				keyframeBytes = message.size();
+			}
+			else
+			{
+				deltaBytes += message.size();
+			}
+		}
+	}
+	state.counters["keyframeBytes"] = static_cast<double>(keyframeBytes);
+	state.counters["bytesPerFrame"] = static_cast<double>(deltaBytes) / (frameCount - 1);
+	state.counters["fullFrameBytes"] = static_cast<double>(screenWidth * screenHeight * sizeof(Tile));
+	state.counters["timePerFrame"] = benchmark::Counter(frameCount, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+void BM_Decode(benchmark::State& state, Session session)
+{
+	std::vector<std::vector<uint8_t>> messages(frameCount);
+	TileStreamEncoder encoder;
+	for(int frame = 0; frame < frameCount; ++frame)
+	{
+		encoder.encode(recording(session)[frame], messages[frame]);
+	}
+
+	TileGrid grid(0, 0);
+	for(auto _ : state)
+	{
+		TileStreamDecoder decoder;
+		for(const std::vector<uint8_t>& message : messages)
+		{
+			decoder.decode(message, grid);
+		}
+		benchmark::ClobberMemory();
+	}
+	state.counters["timePerFrame"] = benchmark::Counter(frameCount, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+///Encode, send through a loopback socket, receive and decode every frame, as a spectator view would.
+void BM_Loopback(benchmark::State& state, Session session)
+{
+	const std::vector<TileGrid>& frames = recording(session);
+	std::pair<MessageChannel, MessageChannel> channels = MessageChannel::createLoopback();
+	std::vector<uint8_t> message;
+	std::vector<uint8_t> received;
+	TileGrid grid(0, 0);
+	for(auto _ : state)
+	{
+		TileStreamEncoder encoder;
+		TileStreamDecoder decoder;
+		for(const TileGrid& frame : frames)
+		{
+			encoder.encode(frame, message);
+			channels.first.send(message);
+			channels.second.receive(received);
+			decoder.decode(received, grid);
+		}
+		benchmark::ClobberMemory();
+	}
+	state.counters["timePerFrame"] = benchmark::Counter(frameCount, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+}
+
+#define SESSION_BENCHMARKS(function) \
+	BENCHMARK_CAPTURE(function, explore, Session::Explore)->Unit(benchmark::kMicrosecond); \
+	BENCHMARK_CAPTURE(function, pan, Session::Pan)->Unit(benchmark::kMicrosecond); \
+	BENCHMARK_CAPTURE(function, menu, Session::Menu)->Unit(benchmark::kMicrosecond); \
+	BENCHMARK_CAPTURE(function, idle, Session::Idle)->Unit(benchmark::kMicrosecond)
+
+SESSION_BENCHMARKS(BM_Encode);
+SESSION_BENCHMARKS(BM_Decode);
+SESSION_BENCHMARKS(BM_Loopback);
+
+BENCHMARK_MAIN();